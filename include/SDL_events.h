@@ -35,6 +35,7 @@
 #include "SDL_mouse.h"
 #include "SDL_joystick.h"
 #include "SDL_quit.h"
+#include "SDL_rwops.h"
 
 #include "begin_code.h"
 /* Set up for C function definitions, even when using C++ */
@@ -277,6 +278,27 @@ typedef enum {
 extern DECLSPEC int SDLCALL SDL_PeepEvents(SDL_Event *events, int numevents,
 				SDL_eventaction action, Uint32 mask);
 
+/**
+ *  Like SDL_PeepEvents(), with the times the events happened, in
+ *  SDL_GetTicksUS() microseconds, in 'timestamps'.
+ *
+ *  The time is taken when the event is created, or comes from the video
+ *  or joystick driver when it knows when the input happened.  For
+ *  SDL_ADDEVENT, 'timestamps' gives the times of the added events.
+ *  'timestamps' may be NULL.
+ */
+extern DECLSPEC int SDLCALL SDL_PeepEventsTimestamped(SDL_Event *events,
+				Uint32 *timestamps, int numevents,
+				SDL_eventaction action, Uint32 mask);
+
+/**
+ *  Get the time the last event returned by SDL_PollEvent(), SDL_WaitEvent()
+ *  or SDL_PeepEvents() happened, in SDL_GetTicksUS() microseconds.
+ *
+ *  If more than one thread reads events, use SDL_PeepEventsTimestamped().
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetEventTimestamp(void);
+
 /** Polls for currently pending events, and returns 1 if there are any pending
  *  events, or 0 if there are none available.  If 'event' is not NULL, the next
  *  event is removed from the queue and stored in that area.
@@ -289,12 +311,46 @@ extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event *event);
  */
 extern DECLSPEC int SDLCALL SDL_WaitEvent(SDL_Event *event);
 
+/** Waits until the specified timeout (in milliseconds) for the next
+ *  available event, returning 1, or 0 if there was an error while waiting
+ *  for events or the timeout ran out.  If 'event' is not NULL, the next
+ *  event is removed from the queue and stored in that area.
+ *
+ *  Where the video driver supports it, both functions sleep until the
+ *  driver has input, SDL_PushEvent() is called from another thread, or
+ *  a key repeat is due, rather than polling.
+ */
+extern DECLSPEC int SDLCALL SDL_WaitEventTimeout(SDL_Event *event, int timeout);
+
 /** Add an event to the event queue.
  *  This function returns 0 on success, or -1 if the event queue was full
  *  or there was some other error.
  */
 extern DECLSPEC int SDLCALL SDL_PushEvent(SDL_Event *event);
 
+/** What to do with events added to a full event queue */
+typedef enum {
+	SDL_QUEUE_DROPNEWEST,	/**< Drop the new event (the default) */
+	SDL_QUEUE_DROPOLDEST,	/**< Drop the oldest queued event to make room */
+	SDL_QUEUE_BLOCK		/**< Wait for the application to take events out */
+} SDL_EventQueuePolicy;
+
+/**
+ *  Set how many events the event queue holds, and what happens when
+ *  it is full.  The queue grows as needed up to 'maxevents' events;
+ *  the default is 128 with SDL_QUEUE_DROPNEWEST.
+ *
+ *  With SDL_QUEUE_BLOCK, SDL_PushEvent() from other threads waits until
+ *  there is room.  Events added by the thread that reads the queue or the
+ *  thread that pumps events are still dropped, since waiting there could
+ *  never end.
+ *
+ *  These settings are kept across SDL_Init() and SDL_Quit().
+ *
+ *  @return 0, or -1 if 'maxevents' or 'policy' is invalid.
+ */
+extern DECLSPEC int SDLCALL SDL_SetEventQueueSize(int maxevents, SDL_EventQueuePolicy policy);
+
 /** @name Event Filtering */
 /*@{*/
 typedef int (SDLCALL *SDL_EventFilter)(const SDL_Event *event);
@@ -347,6 +403,122 @@ extern DECLSPEC SDL_EventFilter SDLCALL SDL_GetEventFilter(void);
 */
 extern DECLSPEC Uint8 SDLCALL SDL_EventState(Uint8 type, int state);
 
+/**
+ * This function allows you to merge streams of motion events as they are
+ * queued, so fast mice and joysticks don't fill the event queue.
+ * If 'state' is set to SDL_ENABLE, a new event of that type is merged into
+ * the last queued event of the same stream, when nothing else was queued
+ * after it.  If 'state' is set to SDL_DISABLE, events are queued as usual
+ * (the default).  If 'state' is set to SDL_QUERY, SDL_EventCoalesce()
+ * returns the current state.
+ *
+ * SDL_MOUSEMOTION events keep the latest position and add up the relative
+ * motion, as long as the button state is the same.  SDL_JOYAXISMOTION
+ * events keep the latest value of each axis.  SDL_JOYBALLMOTION events add
+ * up the relative motion of each ball.  Other event types aren't merged.
+ */
+extern DECLSPEC Uint8 SDLCALL SDL_EventCoalesce(Uint8 type, int state);
+
+/**
+ * Returns how many events of the given type were merged into queued
+ * events since SDL_Init().
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetCoalescedEvents(Uint8 type);
+
+/** @name Event Statistics */
+/*@{*/
+#define SDL_EVENT_LATENCY_BUCKETS	16
+
+/**
+ * Counts of what happened to each type of event on its way through the
+ * event queue, since SDL_Init() or SDL_ResetEventStats().
+ *
+ * Latency is measured from when the event happened, as far as the video
+ * or joystick driver can tell, else from when it was queued, to when it
+ * was taken out of the queue.  latency[0] counts events taken out within
+ * 64 microseconds, and each bucket after that twice as long, so latency[i]
+ * counts latencies from 32<<i up to 64<<i microseconds.  The last bucket
+ * counts everything over a second.
+ */
+typedef struct SDL_EventStats {
+	Uint32 queued[SDL_NUMEVENTS];	/**< Added to the queue */
+	Uint32 dequeued[SDL_NUMEVENTS];	/**< Taken out by SDL_GETEVENT */
+	Uint32 dropped[SDL_NUMEVENTS];	/**< Lost because the queue was full */
+	Uint32 filtered[SDL_NUMEVENTS];	/**< Dropped by the event filter */
+	Uint32 coalesced[SDL_NUMEVENTS];/**< Merged into queued events */
+	Uint32 high_water;		/**< The most events queued at once */
+	Uint32 latency[SDL_EVENT_LATENCY_BUCKETS];
+	Uint32 max_latency;		/**< Microseconds */
+} SDL_EventStats;
+
+/**
+ * Get the event statistics.  Keeping them costs a few counter updates
+ * for each event, so they are always kept.
+ * @return 0 on success, or -1 if the event queue isn't running.
+ */
+extern DECLSPEC int SDLCALL SDL_GetEventStats(SDL_EventStats *stats);
+
+/** Start the event statistics over */
+extern DECLSPEC void SDLCALL SDL_ResetEventStats(void);
+/*@}*/
+
+/** @name Input Recording Functions
+ *  Record the keyboard, mouse, joystick and window input the drivers
+ *  deliver, with the time it arrived, and replay it later in place of
+ *  live input, to run an application through the same session again.
+ *  Events the application causes itself, like SDL_WarpMouse() motion,
+ *  key repeat and SDL_PushEvent() events, aren't recorded, since the
+ *  application causes them again on replay.  Joystick input is replayed
+ *  to the joysticks the application opened with the recorded indexes.
+ *
+ *  Recording or replay also starts with the event loop when the
+ *  SDL_INPUT_RECORD or SDL_INPUT_REPLAY environment variable names a file.
+ */
+/*@{*/
+/** Replay without waiting: instead of sleeping in SDL_Delay(),
+ *  SDL_WaitEvent() or SDL_WaitEventTimeout(), the calling thread moves
+ *  the SDL_GetTicks() clock ahead, up to the time of the next input.
+ *  The application sees the recorded timing, and runs as fast as it can.
+ *  This needs a clock SDL can move, which the Unix timer code has.
+ */
+#define SDL_REPLAY_FAST		0x00000001
+
+/**
+ * Start recording input to 'dst', closing it when recording stops if
+ * 'freedst' is non-zero.
+ * @return 0 on success, or -1 on error or if already recording.
+ */
+extern DECLSPEC int SDLCALL SDL_StartInputRecording_RW(SDL_RWops *dst, int freedst);
+
+/** Convenience macro -- record to a file */
+#define SDL_StartInputRecording(file) \
+		SDL_StartInputRecording_RW(SDL_RWFromFile(file, "wb"), 1)
+
+/**
+ * Stop recording input.
+ * @return 0 on success, or -1 if writing the recording failed.
+ */
+extern DECLSPEC int SDLCALL SDL_StopInputRecording(void);
+
+/**
+ * Start replaying input from 'src', closing it when the replay ends if
+ * 'freesrc' is non-zero.  Live input from the drivers is ignored until
+ * the recording runs out or SDL_StopInputReplay() is called.
+ * @return 0 on success, or -1 on error or if already replaying.
+ */
+extern DECLSPEC int SDLCALL SDL_StartInputReplay_RW(SDL_RWops *src, int freesrc, Uint32 flags);
+
+/** Convenience macro -- replay from a file */
+#define SDL_StartInputReplay(file, flags) \
+		SDL_StartInputReplay_RW(SDL_RWFromFile(file, "rb"), 1, flags)
+
+/** Stop replaying input, and go back to live input */
+extern DECLSPEC void SDLCALL SDL_StopInputReplay(void);
+
+/** Return 1 while input is being replayed, 0 once the replay is over */
+extern DECLSPEC int SDLCALL SDL_InputReplaying(void);
+/*@}*/
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
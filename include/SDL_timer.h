@@ -48,6 +48,14 @@ extern "C" {
  */ 
 extern DECLSPEC Uint32 SDLCALL SDL_GetTicks(void);
 
+/**
+ * Get the number of microseconds since the SDL library initialization,
+ * from the same clock as SDL_GetTicks().  This wraps after ~71 minutes,
+ * so only the difference between two values is meaningful, and it is
+ * only as precise as SDL_GetTicks() on platforms without a finer clock.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetTicksUS(void);
+
 /** Wait a specified number of milliseconds before returning */
 extern DECLSPEC void SDLCALL SDL_Delay(Uint32 ms);
 
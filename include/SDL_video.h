@@ -52,6 +52,12 @@ typedef struct SDL_Rect {
 	Uint16 w, h;
 } SDL_Rect;
 
+/** A rectangle with 32-bit coordinates, for surfaces too large for SDL_Rect */
+typedef struct SDL_Rect32 {
+	Sint32 x, y;
+	Sint32 w, h;
+} SDL_Rect32;
+
 typedef struct SDL_Color {
 	Uint8 r;
 	Uint8 g;
@@ -97,7 +103,7 @@ typedef struct SDL_Surface {
 	Uint32 flags;				/**< Read-only */
 	SDL_PixelFormat *format;		/**< Read-only */
 	int w, h;				/**< Read-only */
-	Uint16 pitch;				/**< Read-only */
+	Uint16 pitch;				/**< Read-only, 0 if over 65535 */
 	void *pixels;				/**< Read-write */
 	int offset;				/**< Private */
 
@@ -106,7 +112,7 @@ typedef struct SDL_Surface {
 
 	/** clipping information */
 	SDL_Rect clip_rect;			/**< Read-only */
-	Uint32 unused1;				/**< for binary compatibility */
+	Uint32 unused1;				/**< Private */
 
 	/** Allow recursive locks */
 	Uint32 locked;				/**< Private */
@@ -202,6 +208,8 @@ typedef struct SDL_VideoInfo {
 #define SDL_YUY2_OVERLAY  0x32595559	/**< Packed mode: Y0+U0+Y1+V0 (1 plane) */
 #define SDL_UYVY_OVERLAY  0x59565955	/**< Packed mode: U0+Y0+V0+Y1 (1 plane) */
 #define SDL_YVYU_OVERLAY  0x55595659	/**< Packed mode: Y0+V0+Y1+U0 (1 plane) */
+#define SDL_NV12_OVERLAY  0x3231564E	/**< Planar mode: Y + U/V interleaved  (2 planes) */
+#define SDL_NV21_OVERLAY  0x3132564E	/**< Planar mode: Y + V/U interleaved  (2 planes) */
 /*@}*/
 
 /** The YUV hardware video overlay */
@@ -413,6 +421,98 @@ extern DECLSPEC void SDLCALL SDL_UpdateRect
  */
 extern DECLSPEC int SDLCALL SDL_Flip(SDL_Surface *screen);
 
+/** Statistics about how the video driver presents frames */
+typedef struct SDL_PresentStats {
+	Uint32 presents;	/**< Screen updates and flips presented */
+	Uint32 buffers;		/**< Buffers presents are pipelined through, 0 if none */
+	Uint32 waits;		/**< Presents that had to wait for a free buffer */
+	Uint32 wait_time;	/**< Total microseconds spent waiting */
+} SDL_PresentStats;
+
+/**
+ * Get statistics about the presents since the video mode was set.
+ * Only the X11 driver keeps them, for its shared memory updates.
+ * @return 0 on success, or -1 if the video driver doesn't keep any.
+ */
+extern DECLSPEC int SDLCALL SDL_GetPresentStats(SDL_PresentStats *stats);
+
+/** Information about a frame kept after it was presented */
+typedef struct SDL_FrameInfo {
+	Uint32 frame;		/**< Frame number, from 1 after SDL_SetVideoMode() */
+	Uint32 ticks;		/**< SDL_GetTicks() when the frame was presented */
+	Uint32 interval;	/**< Microseconds since the previous frame */
+	Uint32 present_time;	/**< Microseconds spent presenting the frame */
+	Uint32 checksum;	/**< CRC-32 of the pixel rows, then the palette */
+} SDL_FrameInfo;
+
+/** @name Frame Capture Functions
+ *  The dummy video driver can keep the last frames passed to
+ *  SDL_UpdateRects() or SDL_Flip() in a ring, so that headless runs can
+ *  be timed, checksummed and compared.  Set the SDL_VIDEO_DUMMY_FRAMES
+ *  environment variable to the number of frames to keep before setting
+ *  the video mode.  Index 0 is the most recently presented frame, 1 the
+ *  one before it, and so on.
+ */
+/*@{*/
+/**
+ * Get the timing and checksum of a kept frame.
+ * The checksum covers each row of pixels without padding, followed by
+ * the r, g and b values of the palette for 8-bit displays.
+ * @return 0 on success, or -1 if there is no such frame.
+ */
+extern DECLSPEC int SDLCALL SDL_GetFrameInfo(int index, SDL_FrameInfo *info);
+/**
+ * Copy a kept frame into a new software surface with the display pixel
+ * format and palette it was presented with.  'info' may be NULL.
+ * Free the surface with SDL_FreeSurface().
+ * @return the new surface, or NULL if there is no such frame.
+ */
+extern DECLSPEC SDL_Surface * SDLCALL SDL_CaptureFrame(int index, SDL_FrameInfo *info);
+/*@}*/
+
+/** @name Recording Functions
+ *  Record every update of the display to a stream, for soak tests and bug
+ *  reports.  SDL_UpdateRects() and SDL_Flip() copy the changed rectangles
+ *  of each frame and a background thread writes them out, so the cost on
+ *  the calling thread is about one extra copy of the updated pixels.
+ *  The stream format is described in src/video/SDL_record_c.h, and the
+ *  rec2y4m test program converts it to a YUV4MPEG2 video.
+ *
+ *  Recording also starts on the first SDL_SetVideoMode() when the
+ *  SDL_VIDEO_RECORD environment variable names a file.
+ */
+/*@{*/
+/** Drop frames instead of waiting when the writer thread falls behind.
+ *  The rectangles of dropped frames are recorded with the next frame.
+ */
+#define SDL_RECORD_DROP		0x00000001
+
+/**
+ * Start recording display updates to 'dst', closing it when recording
+ * stops if 'freedst' is non-zero.
+ * @return 0 on success, or -1 on error or if already recording.
+ */
+extern DECLSPEC int SDLCALL SDL_StartRecording_RW(SDL_RWops *dst, int freedst, Uint32 flags);
+
+/** Convenience macro -- record to a file */
+#define SDL_StartRecording(file, flags) \
+		SDL_StartRecording_RW(SDL_RWFromFile(file, "wb"), 1, flags)
+
+/**
+ * Stop recording, after writing out every queued frame.
+ * @return 0 on success, or -1 if writing the stream failed.
+ */
+extern DECLSPEC int SDLCALL SDL_StopRecording(void);
+
+/**
+ * Get the number of frames recorded so far, how many were dropped, and
+ * how many times SDL_UpdateRects() or SDL_Flip() waited for the writer.
+ * Any of the pointers may be NULL.
+ * @return 0 on success, or -1 if not recording.
+ */
+extern DECLSPEC int SDLCALL SDL_GetRecordingStats(Uint32 *frames, Uint32 *dropped, Uint32 *waits);
+/*@}*/
+
 /**
  * Set the gamma correction for each of the color channels.
  * The gamma values range (approximately) between 0.1 and 10.0
@@ -559,6 +659,17 @@ extern DECLSPEC SDL_Surface * SDLCALL SDL_CreateRGBSurfaceFrom(void *pixels,
 			Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask);
 extern DECLSPEC void SDLCALL SDL_FreeSurface(SDL_Surface *surface);
 
+/**
+ * Returns the number of bytes between the rows of a surface.
+ *
+ * Surfaces can be wider than 65535 bytes per row, which doesn't fit in
+ * 'surface->pitch', so that is 0 for them and you need to use this
+ * function instead.  Such large surfaces can only be blitted and filled
+ * with the SDL_Rect32 functions, e.g. SDL_BlitSurface32(), outside of
+ * the area that SDL_Rect can address.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetSurfacePitch(SDL_Surface *surface);
+
 /**
  * SDL_LockSurface() sets up a surface for directly accessing the pixels.
  * Between calls to SDL_LockSurface()/SDL_UnlockSurface(), you can write
@@ -591,6 +702,28 @@ extern DECLSPEC SDL_Surface * SDLCALL SDL_LoadBMP_RW(SDL_RWops *src, int freesrc
 /** Convenience macro -- load a surface from a file */
 #define SDL_LoadBMP(file)	SDL_LoadBMP_RW(SDL_RWFromFile(file, "rb"), 1)
 
+/**
+ * Load a surface from a seekable SDL data source, converting it into
+ * the pixel format 'fmt' as it is read.  This gives the same result as
+ * SDL_ConvertSurface(SDL_LoadBMP_RW(src, freesrc), fmt, flags), but the
+ * image is only allocated once, in its final format.
+ *
+ * Since BMP files have no transparency, if 'flags' contains
+ * SDL_SRCCOLORKEY, the color key of the new surface is fmt->colorkey,
+ * and if it contains SDL_SRCALPHA and 'fmt' has no alpha channel, the
+ * surface alpha is fmt->alpha.  If 'flags' also contains SDL_RLEACCEL
+ * and the video mode is set, the surface is RLE encoded for blitting to
+ * the display right away, instead of on the first blit.
+ *
+ * Returns the new surface, or NULL if there was an error.
+ */
+extern DECLSPEC SDL_Surface * SDLCALL SDL_LoadBMP_RW_Format
+		(SDL_RWops *src, int freesrc, SDL_PixelFormat *fmt, Uint32 flags);
+
+/** Convenience macro -- load a surface from a file in the given format */
+#define SDL_LoadBMP_Format(file, fmt, flags) \
+		SDL_LoadBMP_RW_Format(SDL_RWFromFile(file, "rb"), 1, fmt, flags)
+
 /**
  * Save a surface to a seekable SDL data source (memory or file.)
  * If 'freedst' is non-zero, the source will be closed after being written.
@@ -603,6 +736,65 @@ extern DECLSPEC int SDLCALL SDL_SaveBMP_RW
 #define SDL_SaveBMP(surface, file) \
 		SDL_SaveBMP_RW(surface, SDL_RWFromFile(file, "wb"), 1)
 
+struct SDL_Thread;
+
+/**
+ * Save a surface to an SDL data source on a background thread.
+ * The pixels are copied before this returns, so the surface can be
+ * changed or freed right away, and any conversion is done by the thread.
+ * If 'freedst' is non-zero, the source will be closed after being written.
+ *
+ * Returns the saving thread, or NULL if it couldn't be started.  Pass it
+ * to SDL_WaitThread() to get the result that SDL_SaveBMP_RW() returned.
+ */
+extern DECLSPEC struct SDL_Thread * SDLCALL SDL_SaveBMP_RW_Async
+		(SDL_Surface *surface, SDL_RWops *dst, int freedst);
+
+/** Convenience macro -- save a surface to a file on a background thread */
+#define SDL_SaveBMP_Async(surface, file) \
+		SDL_SaveBMP_RW_Async(surface, SDL_RWFromFile(file, "wb"), 1)
+
+/**
+ * Save a surface that is ready to blit to the display to a surface cache,
+ * so it can be loaded back quickly with SDL_LoadSurfaceCache_RW().
+ * The pixels, palette, color key and alpha settings are saved, and if the
+ * surface is RLE accelerated, its RLE encoding is saved instead of its
+ * pixels.  'key' identifies the source the surface was made from, such
+ * as a checksum or timestamp of the original image file.
+ *
+ * Cache files store data in native byte order, for the current display
+ * format, so they are only meant to be read back on the same machine.
+ * If 'freedst' is non-zero, the source will be closed after being written.
+ * Returns 0 if successful or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_SaveSurfaceCache_RW
+		(SDL_Surface *surface, Uint32 key, SDL_RWops *dst, int freedst);
+
+/** Convenience macro -- save a surface cache to a file */
+#define SDL_SaveSurfaceCache(surface, key, file) \
+	SDL_SaveSurfaceCache_RW(surface, key, SDL_RWFromFile(file, "wb"), 1)
+
+/**
+ * Load a surface saved by SDL_SaveSurfaceCache_RW(), without any
+ * conversion or RLE encoding.  This fails if the cache was saved with
+ * a different 'key', or for a display format other than the current one,
+ * in which case the surface should be made from its source again.
+ *
+ * If the data source is in memory, for example a cache file mapped into
+ * memory by the application, the surface uses the pixels in place.  The
+ * memory must then stay valid, and writable if the surface is drawn on,
+ * until the surface is freed.
+ *
+ * If 'freesrc' is non-zero, the source will be closed after being read.
+ * Returns the new surface, or NULL if there was an error.
+ */
+extern DECLSPEC SDL_Surface * SDLCALL SDL_LoadSurfaceCache_RW
+		(SDL_RWops *src, int freesrc, Uint32 key);
+
+/** Convenience macro -- load a surface cache from a file */
+#define SDL_LoadSurfaceCache(file, key) \
+	SDL_LoadSurfaceCache_RW(SDL_RWFromFile(file, "rb"), 1, key)
+
 /**
  * Sets the color key (transparent pixel) in a blittable surface.
  * If 'flag' is SDL_SRCCOLORKEY (optionally OR'd with SDL_RLEACCEL), 
@@ -653,6 +845,14 @@ extern DECLSPEC SDL_bool SDLCALL SDL_SetClipRect(SDL_Surface *surface, const SDL
  */
 extern DECLSPEC void SDLCALL SDL_GetClipRect(SDL_Surface *surface, SDL_Rect *rect);
 
+/**
+ * These are SDL_SetClipRect() and SDL_GetClipRect() with 32-bit
+ * rectangles, for surfaces larger than SDL_Rect can describe.  The clip
+ * rectangle that SDL_GetClipRect() returns is clamped to fit in SDL_Rect.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_SetClipRect32(SDL_Surface *surface, const SDL_Rect32 *rect);
+extern DECLSPEC void SDLCALL SDL_GetClipRect32(SDL_Surface *surface, SDL_Rect32 *rect);
+
 /**
  * Creates a new surface of the specified format, and then copies and maps 
  * the given surface to it so the blit of the converted surface will be as 
@@ -755,6 +955,20 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
 			(SDL_Surface *src, SDL_Rect *srcrect,
 			 SDL_Surface *dst, SDL_Rect *dstrect);
 
+/**
+ * These are the blit functions with 32-bit rectangles, for surfaces
+ * with more than 32767 rows or columns.  Their semantics are the same as
+ * SDL_BlitSurface() and SDL_LowerBlit().
+ */
+#define SDL_BlitSurface32 SDL_UpperBlit32
+
+extern DECLSPEC int SDLCALL SDL_UpperBlit32
+			(SDL_Surface *src, SDL_Rect32 *srcrect,
+			 SDL_Surface *dst, SDL_Rect32 *dstrect);
+extern DECLSPEC int SDLCALL SDL_LowerBlit32
+			(SDL_Surface *src, SDL_Rect32 *srcrect,
+			 SDL_Surface *dst, SDL_Rect32 *dstrect);
+
 /**
  * This function performs a fast fill of the given rectangle with 'color'
  * The given rectangle is clipped to the destination surface clip area
@@ -767,6 +981,10 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
 extern DECLSPEC int SDLCALL SDL_FillRect
 		(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color);
 
+/** SDL_FillRect() with a 32-bit rectangle */
+extern DECLSPEC int SDLCALL SDL_FillRect32
+		(SDL_Surface *dst, SDL_Rect32 *dstrect, Uint32 color);
+
 /**
  * This function takes a surface and copies it to a new surface of the
  * pixel format and colors of the video framebuffer, suitable for fast
@@ -815,10 +1033,25 @@ extern DECLSPEC void SDLCALL SDL_UnlockYUVOverlay(SDL_Overlay *overlay);
  *  The contents of the video surface underneath the blit destination are
  *  not defined.  
  *  The width and height of the destination rectangle may be different from
- *  that of the overlay, but currently only 2x scaling is supported.
+ *  that of the overlay, in which case the overlay is scaled to fit.
  */
 extern DECLSPEC int SDLCALL SDL_DisplayYUVOverlay(SDL_Overlay *overlay, SDL_Rect *dstrect);
 
+/** Point a software overlay at planes owned by the caller, such as the
+ *  output buffers of a video decoder, so they can be displayed without
+ *  copying them into the overlay.
+ *  pixels and pitches hold overlay->planes entries, which must stay valid
+ *  until the overlay is displayed.  Passing NULL for pixels switches back
+ *  to the planes allocated with the overlay.
+ *  @return 0 on success, or -1 if the overlay isn't a software overlay.
+ */
+extern DECLSPEC int SDLCALL SDL_SetYUVOverlayPlanes(SDL_Overlay *overlay, Uint8 **pixels, Uint16 *pitches);
+
+/** Returns the time in microseconds the last SDL_DisplayYUVOverlay() call
+ *  spent converting a software overlay, or 0 for hardware overlays.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetYUVOverlayConversionTime(SDL_Overlay *overlay);
+
 /** Free a video overlay */
 extern DECLSPEC void SDLCALL SDL_FreeYUVOverlay(SDL_Overlay *overlay);
 
@@ -41,6 +41,7 @@
 #define CPU_HAS_SSE	0x00000040
 #define CPU_HAS_SSE2	0x00000080
 #define CPU_HAS_ALTIVEC	0x00000100
+#define CPU_HAS_AVX2	0x00000200
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__
 /* This is the brute force way of detecting instruction sets...
@@ -300,6 +301,29 @@ done:
 	return features;
 }
 
+#if defined(__GNUC__) && (defined(i386) || defined(__x86_64__))
+static __inline__ void CPU_getCPUIDRegs(int leaf, int subleaf, int regs[4])
+{
+#if defined(i386)
+	__asm__ (
+"        movl    %%ebx,%%esi         # EBX is the PIC register, save it\n"
+"        cpuid                                                         \n"
+"        xchgl   %%ebx,%%esi                                           \n"
+	: "=a" (regs[0]), "=S" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	: "a" (leaf), "c" (subleaf)
+	);
+#else
+	__asm__ (
+"        movq    %%rbx,%%rsi         # Save RBX across CPUID           \n"
+"        cpuid                                                         \n"
+"        xchgq   %%rbx,%%rsi                                           \n"
+	: "=a" (regs[0]), "=S" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	: "a" (leaf), "c" (subleaf)
+	);
+#endif
+}
+#endif
+
 static __inline__ int CPU_haveRDTSC(void)
 {
 	if ( CPU_haveCPUID() ) {
@@ -356,6 +380,37 @@ static __inline__ int CPU_haveSSE2(void)
 	return 0;
 }
 
+static __inline__ int CPU_haveAVX2(void)
+{
+#if defined(__GNUC__) && (defined(i386) || defined(__x86_64__))
+	if ( CPU_haveCPUID() ) {
+		int regs[4];
+		unsigned int xcr0_lo, xcr0_hi;
+
+		CPU_getCPUIDRegs(0, 0, regs);
+		if ( regs[0] < 7 ) {
+			return 0;
+		}
+		/* The CPU must support AVX and the OS must save YMM state */
+		CPU_getCPUIDRegs(1, 0, regs);
+		if ( (regs[2] & 0x18000000) != 0x18000000 ) {
+			return 0;
+		}
+		__asm__ (
+"        .byte   0x0f,0x01,0xd0      # XGETBV (not known to older as)  \n"
+		: "=a" (xcr0_lo), "=d" (xcr0_hi)
+		: "c" (0)
+		);
+		if ( (xcr0_lo & 0x6) != 0x6 ) {
+			return 0;
+		}
+		CPU_getCPUIDRegs(7, 0, regs);
+		return (regs[1] & 0x00000020);
+	}
+#endif
+	return 0;
+}
+
 static __inline__ int CPU_haveAltiVec(void)
 {
 	volatile int altivec = 0;
@@ -408,6 +463,9 @@ static Uint32 SDL_GetCPUFeatures(void)
 		if ( CPU_haveSSE2() ) {
 			SDL_CPUFeatures |= CPU_HAS_SSE2;
 		}
+		if ( CPU_haveAVX2() ) {
+			SDL_CPUFeatures |= CPU_HAS_AVX2;
+		}
 		if ( CPU_haveAltiVec() ) {
 			SDL_CPUFeatures |= CPU_HAS_ALTIVEC;
 		}
@@ -471,6 +529,14 @@ SDL_bool SDL_HasSSE2(void)
 	return SDL_FALSE;
 }
 
+SDL_bool SDL_HasAVX2(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_AVX2 ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
 SDL_bool SDL_HasAltiVec(void)
 {
 	if ( SDL_GetCPUFeatures() & CPU_HAS_ALTIVEC ) {
@@ -492,6 +558,7 @@ int main()
 	printf("3DNowExt: %d\n", SDL_Has3DNowExt());
 	printf("SSE: %d\n", SDL_HasSSE());
 	printf("SSE2: %d\n", SDL_HasSSE2());
+	printf("AVX2: %d\n", SDL_HasAVX2());
 	printf("AltiVec: %d\n", SDL_HasAltiVec());
 	return 0;
 }
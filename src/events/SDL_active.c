@@ -51,9 +51,17 @@ Uint8 SDL_GetAppState(void)
 /* This is global for SDL_eventloop.c */
 int SDL_PrivateAppActive(Uint8 gain, Uint8 state)
 {
+	SDL_Event input;
 	int posted;
 	Uint8 new_state;
 
+	input.type = SDL_ACTIVEEVENT;
+	input.active.gain = gain;
+	input.active.state = state;
+	if ( SDL_RecordInput(&input) ) {
+		return(0);
+	}
+
 	/* Modify the current state with the given mask */
 	if ( gain ) {
 		new_state = (SDL_appstate | state);
@@ -77,7 +85,7 @@ int SDL_PrivateAppActive(Uint8 gain, Uint8 state)
 		event.type = SDL_ACTIVEEVENT;
 		event.active.gain = gain;
 		event.active.state = state;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
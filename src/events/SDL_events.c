@@ -32,50 +32,250 @@
 #include "../joystick/SDL_joystick_c.h"
 #endif
 
+/* Unix platforms can sleep in select() until events arrive */
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__MACOS__)
+#define SDL_EVENT_WAKEUP_PIPE	1
+#include <sys/types.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
 /* Public data -- the event filter */
 SDL_EventFilter SDL_EventOK = NULL;
 Uint8 SDL_ProcessEvents[SDL_NUMEVENTS];
 static Uint32 SDL_eventstate = 0;
 
-/* Private data -- event queue */
+/* Private data -- event queue
+
+   Queued events are kept in a list in the order they were added, and in
+   a list per event type, so events can be taken out of the middle and
+   masked peeks only visit the events they return.  Lists link entries
+   by index, so the entries can be reallocated as the queue grows.
+ */
 #define MAXEVENTS	128
+typedef struct {
+	SDL_Event event;
+	Uint32 seq;		/* Order of the event in the queue */
+	Uint32 timestamp;	/* SDL_GetTicksUS() when it happened */
+	int prev, next;		/* Next is also the next free entry */
+	int type_prev, type_next;
+} SDL_EventEntry;
+
 static struct {
 	SDL_mutex *lock;
+	SDL_cond *room;		/* Signaled when events are taken out */
 	int active;
-	int head;
-	int tail;
-	SDL_Event event[MAXEVENTS];
+	int head;		/* Oldest event, or -1 */
+	int tail;		/* Newest event, or -1 */
+	int count;
+	int size;		/* Entries allocated */
+	int free;		/* First free entry, or -1 */
+	Uint32 seq;
+	Uint32 last_timestamp;	/* Of the last event returned */
+	SDL_EventEntry *entry;
+	int type_head[256];
+	int type_tail[256];
+	int waiting;		/* Threads waiting for room */
+	Uint32 reader;		/* The thread taking events out */
+	int sleepers;		/* Threads sleeping in SDL_WaitEvent() */
+	int wakeup[2];		/* Pipe that wakes them up, or -1 */
 	int wmmsg_next;
 	struct SDL_SysWMmsg wmmsg[MAXEVENTS];
 } SDL_EventQ;
 
+/* The queue limits, which are kept across SDL_Quit() */
+static int SDL_EventQ_max = MAXEVENTS;
+static SDL_EventQueuePolicy SDL_EventQ_policy = SDL_QUEUE_DROPNEWEST;
+
+/* The event types merged as they're queued */
+static Uint8 SDL_CoalesceEvents[SDL_NUMEVENTS];
+
+/* What happened to the events, updated with the queue locked, except
+   for the filtered counts
+ */
+static SDL_EventStats SDL_EventStatistics;
+
+/* The time the events being queued by 'thread' happened, as given by the
+   driver, or taken by SDL_FilterEvent() for the next event only
+ */
+#define SDL_EVENTTIME_DRIVER	1
+#define SDL_EVENTTIME_ONCE	2
+static struct {
+	Uint32 timestamp;
+	Uint32 thread;
+	int set;
+} SDL_EventTime;
+
+/* The timeout for sleeping until an event arrives */
+#define SDL_WAIT_FOREVER	0xFFFFFFFF
+
 /* Private data -- event locking structure */
 static struct {
 	SDL_mutex *lock;
-	int safe;
+	SDL_cond *idle;		/* Signaled when busy or depth drop to 0 */
+	int busy;		/* The event thread is pumping events */
+	Uint32 owner;		/* The thread holding the event thread lock */
+	int depth;		/* How many times the owner locked it */
+	int wakeup[2];		/* Pipe that wakes the event thread, or -1 */
 } SDL_EventLock;
 
 /* Thread functions */
 static SDL_Thread *SDL_EventThread = NULL;	/* Thread handle */
 static Uint32 event_thread;			/* The event thread id */
 
+static void SDL_WakeEventThread(void);
+
 void SDL_Lock_EventThread(void)
 {
-	if ( SDL_EventThread && (SDL_ThreadID() != event_thread) ) {
-		/* Grab lock and spin until we're sure event thread stopped */
+	Uint32 self;
+
+	if ( SDL_EventThread && ((self=SDL_ThreadID()) != event_thread) ) {
+		/* Wait until the event thread is done pumping, and keep it
+		   from pumping again until SDL_Unlock_EventThread()
+		 */
 		SDL_mutexP(SDL_EventLock.lock);
-		while ( ! SDL_EventLock.safe ) {
-			SDL_Delay(1);
+		if ( SDL_EventLock.depth && SDL_EventLock.owner == self ) {
+			++SDL_EventLock.depth;
+		} else {
+			while ( SDL_EventLock.busy || SDL_EventLock.depth ) {
+				SDL_CondWait(SDL_EventLock.idle, SDL_EventLock.lock);
+			}
+			SDL_EventLock.owner = self;
+			SDL_EventLock.depth = 1;
 		}
+		SDL_mutexV(SDL_EventLock.lock);
 	}
 }
 void SDL_Unlock_EventThread(void)
 {
 	if ( SDL_EventThread && (SDL_ThreadID() != event_thread) ) {
+		SDL_mutexP(SDL_EventLock.lock);
+		if ( --SDL_EventLock.depth == 0 ) {
+			SDL_EventLock.owner = 0;
+			SDL_CondBroadcast(SDL_EventLock.idle);
+			/* Our calls may have left events with the video driver */
+			SDL_WakeEventThread();
+		}
 		SDL_mutexV(SDL_EventLock.lock);
 	}
 }
 
+#ifdef SDL_EVENT_WAKEUP_PIPE
+static int SDL_OpenWakeupPipe(int wakeup[2])
+{
+	int i;
+
+	if ( pipe(wakeup) < 0 ) {
+		wakeup[0] = -1;
+		wakeup[1] = -1;
+		return(-1);
+	}
+	for ( i = 0; i < 2; ++i ) {
+		fcntl(wakeup[i], F_SETFD, FD_CLOEXEC);
+		fcntl(wakeup[i], F_SETFL, O_NONBLOCK);
+	}
+	return(0);
+}
+
+static void SDL_CloseWakeupPipe(int wakeup[2])
+{
+	if ( wakeup[0] >= 0 ) {
+		close(wakeup[0]);
+		close(wakeup[1]);
+	}
+	wakeup[0] = -1;
+	wakeup[1] = -1;
+}
+
+static void SDL_Wakeup(int wakeup[2])
+{
+	/* A full pipe already has a wakeup pending */
+	static const char byte = 0;
+	if ( wakeup[1] >= 0 && write(wakeup[1], &byte, 1) < 0 ) {
+		;
+	}
+}
+
+/* Find the file descriptors OS events arrive on, and lower '*timeout'
+   (in milliseconds) to when the event loop has to be pumped again,
+   'poll' at the latest for video drivers that can't tell.  Returns the
+   number of descriptors, or -1 if the loop should be pumped right away.
+ */
+static int SDL_GetEventFDs(int *fds, int maxfds, Uint32 *timeout, Uint32 poll)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+	int nfds, repeat;
+
+	nfds = 0;
+	if ( video && video->GetEventFDs ) {
+		nfds = video->GetEventFDs(this, fds, maxfds, timeout);
+		if ( nfds < 0 ) {
+			return(-1);
+		}
+	} else if ( *timeout > poll ) {
+		*timeout = poll;
+	}
+	repeat = SDL_KeyRepeatTimeout();
+	if ( repeat >= 0 && (Uint32)repeat < *timeout ) {
+		*timeout = repeat;
+	}
+#if !SDL_JOYSTICK_DISABLED
+	/* Joysticks are polled */
+	if ( SDL_numjoysticks && (SDL_eventstate & SDL_JOYEVENTMASK) &&
+	     *timeout > 10 ) {
+		*timeout = 10;
+	}
+#endif
+	return(nfds);
+}
+
+/* Sleep until a wakeup or one of 'fds' is readable, or for 'timeout'
+   milliseconds, and drain the wakeup pipe
+ */
+static void SDL_SelectEvents(int wakeup[2], int *fds, int nfds, Uint32 timeout)
+{
+	fd_set fdset;
+	struct timeval tv;
+	char buf[32];
+	int i, maxfd;
+
+	FD_ZERO(&fdset);
+	FD_SET(wakeup[0], &fdset);
+	maxfd = wakeup[0];
+	for ( i = 0; i < nfds; ++i ) {
+		FD_SET(fds[i], &fdset);
+		if ( fds[i] > maxfd ) {
+			maxfd = fds[i];
+		}
+	}
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+	select(maxfd+1, &fdset, NULL, NULL,
+	       (timeout == SDL_WAIT_FOREVER) ? NULL : &tv);
+
+	while ( read(wakeup[0], buf, sizeof(buf)) > 0 ) {
+		/* Drain the wakeups */ ;
+	}
+}
+#endif /* SDL_EVENT_WAKEUP_PIPE */
+
+static void SDL_WakeEventThread(void)
+{
+#ifdef SDL_EVENT_WAKEUP_PIPE
+	if ( SDL_EventThread ) {
+		SDL_Wakeup(SDL_EventLock.wakeup);
+	}
+#endif
+}
+
+/* Used by the timers to have the event thread run a new timer on time */
+void SDL_TimerChanged(void)
+{
+	SDL_WakeEventThread();
+}
+
 #ifdef __OS2__
 /*
  * We'll increase the priority of GobbleEvents thread, so it will process
@@ -89,6 +289,12 @@ void SDL_Unlock_EventThread(void)
 
 static int SDLCALL SDL_GobbleEvents(void *unused)
 {
+#ifdef SDL_EVENT_WAKEUP_PIPE
+	int fds[8];
+	int nfds;
+	Uint32 timeout;
+#endif
+
 	event_thread = SDL_ThreadID();
 
 #ifdef __OS2__
@@ -102,7 +308,16 @@ static int SDLCALL SDL_GobbleEvents(void *unused)
 		SDL_VideoDevice *video = current_video;
 		SDL_VideoDevice *this  = current_video;
 
+		/* Wait for other threads to be done with the video driver */
+		SDL_mutexP(SDL_EventLock.lock);
+		while ( SDL_EventLock.depth ) {
+			SDL_CondWait(SDL_EventLock.idle, SDL_EventLock.lock);
+		}
+		SDL_EventLock.busy = 1;
+		SDL_mutexV(SDL_EventLock.lock);
+
 		/* Get events from the video subsystem */
+		SDL_BeginInputPump();
 		if ( video ) {
 			video->PumpEvents(this);
 		}
@@ -116,25 +331,35 @@ static int SDLCALL SDL_GobbleEvents(void *unused)
 			SDL_JoystickUpdate();
 		}
 #endif
+		SDL_EndInputPump();
 
-		/* Give up the CPU for the rest of our timeslice */
-		SDL_EventLock.safe = 1;
 		if ( SDL_timer_running ) {
 			SDL_ThreadedTimerCheck();
 		}
-		SDL_Delay(1);
 
-		/* Check for event locking.
-		   On the P of the lock mutex, if the lock is held, this thread
-		   will wait until the lock is released before continuing.  The
-		   safe flag will be set, meaning that the other thread can go
-		   about it's business.  The safe flag is reset before the V,
-		   so as soon as the mutex is free, other threads can see that
-		   it's not safe to interfere with the event thread.
-		 */
+#ifdef SDL_EVENT_WAKEUP_PIPE
+		/* Work out how long we can sleep, while the driver is ours */
+		timeout = SDL_WAIT_FOREVER;
+		if ( SDL_timer_running ) {
+			timeout = SDL_ThreadedTimerTimeout();
+		}
+		nfds = SDL_GetEventFDs(fds, SDL_arraysize(fds), &timeout, 1);
+#endif
+
+		/* Let other threads use the video driver while we sleep */
 		SDL_mutexP(SDL_EventLock.lock);
-		SDL_EventLock.safe = 0;
+		SDL_EventLock.busy = 0;
+		SDL_CondBroadcast(SDL_EventLock.idle);
 		SDL_mutexV(SDL_EventLock.lock);
+
+#ifdef SDL_EVENT_WAKEUP_PIPE
+		if ( nfds >= 0 && SDL_EventQ.active ) {
+			SDL_SelectEvents(SDL_EventLock.wakeup, fds, nfds, timeout);
+		}
+#else
+		/* Give up the CPU for the rest of our timeslice */
+		SDL_Delay(1);
+#endif
 	}
 	SDL_SetTimerThreaded(0);
 	event_thread = 0;
@@ -157,7 +382,20 @@ static int SDL_StartEventThread(Uint32 flags)
 		return(-1);
 #endif
 	}
+	/* Without thread support this fails, and a full queue never blocks */
+	SDL_EventQ.room = SDL_CreateCond();
 #endif /* !SDL_THREADS_DISABLED */
+	SDL_EventQ.waiting = 0;
+	SDL_EventQ.reader = SDL_ThreadID();
+	SDL_EventQ.sleepers = 0;
+	SDL_EventQ.wakeup[0] = -1;
+	SDL_EventQ.wakeup[1] = -1;
+	SDL_EventLock.wakeup[0] = -1;
+	SDL_EventLock.wakeup[1] = -1;
+#ifdef SDL_EVENT_WAKEUP_PIPE
+	/* If this fails, SDL_WaitEvent() polls instead */
+	SDL_OpenWakeupPipe(SDL_EventQ.wakeup);
+#endif
 	SDL_EventQ.active = 1;
 
 	if ( (flags&SDL_INIT_EVENTTHREAD) == SDL_INIT_EVENTTHREAD ) {
@@ -165,7 +403,16 @@ static int SDL_StartEventThread(Uint32 flags)
 		if ( SDL_EventLock.lock == NULL ) {
 			return(-1);
 		}
-		SDL_EventLock.safe = 0;
+		SDL_EventLock.idle = SDL_CreateCond();
+		if ( SDL_EventLock.idle == NULL ) {
+			return(-1);
+		}
+#ifdef SDL_EVENT_WAKEUP_PIPE
+		if ( SDL_OpenWakeupPipe(SDL_EventLock.wakeup) < 0 ) {
+			SDL_SetError("Couldn't create the event thread pipe");
+			return(-1);
+		}
+#endif
 
 		/* The event thread will handle timers too */
 		SDL_SetTimerThreaded(2);
@@ -187,16 +434,44 @@ static int SDL_StartEventThread(Uint32 flags)
 static void SDL_StopEventThread(void)
 {
 	SDL_EventQ.active = 0;
+	if ( SDL_EventQ.room ) {
+		/* Wake up the threads waiting for room, and let them go */
+		for ( ; ; ) {
+			int waiting;
+
+			SDL_mutexP(SDL_EventQ.lock);
+			SDL_CondBroadcast(SDL_EventQ.room);
+			waiting = SDL_EventQ.waiting;
+			SDL_mutexV(SDL_EventQ.lock);
+			if ( ! waiting ) {
+				break;
+			}
+			SDL_Delay(1);
+		}
+		SDL_DestroyCond(SDL_EventQ.room);
+		SDL_EventQ.room = NULL;
+	}
 	if ( SDL_EventThread ) {
+		SDL_WakeEventThread();
 		SDL_WaitThread(SDL_EventThread, NULL);
 		SDL_EventThread = NULL;
+	}
+	if ( SDL_EventLock.lock ) {
 		SDL_DestroyMutex(SDL_EventLock.lock);
 		SDL_EventLock.lock = NULL;
 	}
+	if ( SDL_EventLock.idle ) {
+		SDL_DestroyCond(SDL_EventLock.idle);
+		SDL_EventLock.idle = NULL;
+	}
 #ifndef IPOD
 	SDL_DestroyMutex(SDL_EventQ.lock);
 	SDL_EventQ.lock = NULL;
 #endif
+#ifdef SDL_EVENT_WAKEUP_PIPE
+	SDL_CloseWakeupPipe(SDL_EventQ.wakeup);
+	SDL_CloseWakeupPipe(SDL_EventLock.wakeup);
+#endif
 }
 
 Uint32 SDL_EventThreadID(void)
@@ -211,6 +486,9 @@ void SDL_StopEventLoop(void)
 	/* Halt the event thread, if running */
 	SDL_StopEventThread();
 
+	/* Finish any input recording or replay */
+	SDL_InputRecordQuit();
+
 	/* Shutdown event handlers */
 	SDL_AppActiveQuit();
 	SDL_KeyboardQuit();
@@ -218,8 +496,18 @@ void SDL_StopEventLoop(void)
 	SDL_QuitQuit();
 
 	/* Clean out EventQ */
-	SDL_EventQ.head = 0;
-	SDL_EventQ.tail = 0;
+	SDL_memset(&SDL_EventStatistics, 0, sizeof(SDL_EventStatistics));
+	SDL_EventQ.head = -1;
+	SDL_EventQ.tail = -1;
+	SDL_EventQ.count = 0;
+	SDL_EventQ.size = 0;
+	SDL_EventQ.free = -1;
+	SDL_memset(SDL_EventQ.type_head, 0xFF, sizeof(SDL_EventQ.type_head));
+	SDL_memset(SDL_EventQ.type_tail, 0xFF, sizeof(SDL_EventQ.type_tail));
+	if ( SDL_EventQ.entry ) {
+		SDL_free(SDL_EventQ.entry);
+		SDL_EventQ.entry = NULL;
+	}
 	SDL_EventQ.wmmsg_next = 0;
 }
 
@@ -231,6 +519,13 @@ int SDL_StartEventLoop(Uint32 flags)
 	/* Clean out the event queue */
 	SDL_EventThread = NULL;
 	SDL_EventQ.lock = NULL;
+	SDL_EventQ.room = NULL;
+	SDL_EventQ.wakeup[0] = -1;
+	SDL_EventQ.wakeup[1] = -1;
+	SDL_EventLock.lock = NULL;
+	SDL_EventLock.idle = NULL;
+	SDL_EventLock.wakeup[0] = -1;
+	SDL_EventLock.wakeup[1] = -1;
 	SDL_StopEventLoop();
 
 	/* No filter to start with, process most event types */
@@ -257,67 +552,402 @@ int SDL_StartEventLoop(Uint32 flags)
 		SDL_StopEventLoop();
 		return(-1);
 	}
+
+	/* Record or replay input, if the environment asks for it */
+	SDL_InputRecordInit();
+	return(0);
+}
+
+
+int SDL_SetEventQueueSize(int maxevents, SDL_EventQueuePolicy policy)
+{
+	if ( maxevents <= 0 || maxevents > 0x100000 ) {
+		SDL_SetError("Event queue size must be between 1 and 1048576");
+		return(-1);
+	}
+	switch (policy) {
+		case SDL_QUEUE_DROPNEWEST:
+		case SDL_QUEUE_DROPOLDEST:
+		case SDL_QUEUE_BLOCK:
+			break;
+		default:
+			SDL_SetError("Unknown event queue policy");
+			return(-1);
+	}
+	if ( SDL_EventQ.active && SDL_mutexP(SDL_EventQ.lock) == 0 ) {
+		SDL_EventQ_max = maxevents;
+		SDL_EventQ_policy = policy;
+		/* Let waiting threads see if they still need to wait */
+		if ( SDL_EventQ.room ) {
+			SDL_CondBroadcast(SDL_EventQ.room);
+		}
+		SDL_mutexV(SDL_EventQ.lock);
+	} else {
+		SDL_EventQ_max = maxevents;
+		SDL_EventQ_policy = policy;
+	}
 	return(0);
 }
 
+/* Count the queued events -- called with the queue locked */
+#define SDL_QueuedEvents()	(SDL_EventQ.count)
+
+/* Make room for more events, doubling the queue up to the limit,
+   and return 0, or -1 if it can't grow -- called with the queue locked
+ */
+static int SDL_GrowEventQueue(void)
+{
+	SDL_EventEntry *entry;
+	int size, i;
+
+	size = SDL_EventQ.size ? SDL_EventQ.size*2 : MAXEVENTS;
+	if ( size > SDL_EventQ_max ) {
+		size = SDL_EventQ_max;
+	}
+	if ( size <= SDL_EventQ.size ) {
+		return(-1);
+	}
+	entry = (SDL_EventEntry *)SDL_realloc(SDL_EventQ.entry,
+	                                      size*sizeof(*entry));
+	if ( entry == NULL ) {
+		return(-1);
+	}
+
+	/* Put the new entries on the free list */
+	for ( i = SDL_EventQ.size; i < size-1; ++i ) {
+		entry[i].next = i+1;
+	}
+	entry[size-1].next = SDL_EventQ.free;
+	SDL_EventQ.free = SDL_EventQ.size;
+	SDL_EventQ.entry = entry;
+	SDL_EventQ.size = size;
+	return(0);
+}
+
+/* Take a queued event out of the lists, and return the next event of
+   the same type -- called with the queue locked
+ */
+static int SDL_CutEvent(int spot)
+{
+	SDL_EventEntry *entry = SDL_EventQ.entry;
+	SDL_EventEntry *cut = &entry[spot];
+	Uint8 type = cut->event.type;
+	int next = cut->type_next;
+
+	if ( cut->prev >= 0 ) {
+		entry[cut->prev].next = cut->next;
+	} else {
+		SDL_EventQ.head = cut->next;
+	}
+	if ( cut->next >= 0 ) {
+		entry[cut->next].prev = cut->prev;
+	} else {
+		SDL_EventQ.tail = cut->prev;
+	}
+	if ( cut->type_prev >= 0 ) {
+		entry[cut->type_prev].type_next = cut->type_next;
+	} else {
+		SDL_EventQ.type_head[type] = cut->type_next;
+	}
+	if ( cut->type_next >= 0 ) {
+		entry[cut->type_next].type_prev = cut->type_prev;
+	} else {
+		SDL_EventQ.type_tail[type] = cut->type_prev;
+	}
+	cut->next = SDL_EventQ.free;
+	SDL_EventQ.free = spot;
+	--SDL_EventQ.count;
+	return(next);
+}
+
+/* See if there's room for one more event, growing the queue, dropping
+   the oldest event or waiting as the policy says -- called with the
+   queue locked
+ */
+static int SDL_RoomForEvent(void)
+{
+	Uint32 self = SDL_ThreadID();
+	Uint8 type;
+
+	for ( ; ; ) {
+		int used = SDL_QueuedEvents();
+
+		if ( used < SDL_EventQ_max ) {
+			if ( SDL_EventQ.free >= 0 ) {
+				return(1);
+			}
+			if ( SDL_GrowEventQueue() == 0 ) {
+				return(1);
+			}
+		}
+		if ( used == 0 ) {
+			return(0);
+		}
+		switch (SDL_EventQ_policy) {
+		    case SDL_QUEUE_DROPOLDEST:
+			type = SDL_EventQ.entry[SDL_EventQ.head].event.type;
+			if ( type < SDL_NUMEVENTS ) {
+				++SDL_EventStatistics.dropped[type];
+			}
+			SDL_CutEvent(SDL_EventQ.head);
+			break;
+		    case SDL_QUEUE_BLOCK:
+			if ( SDL_EventQ.room && SDL_EventQ.active &&
+			     self != SDL_EventQ.reader &&
+			     self != event_thread ) {
+				++SDL_EventQ.waiting;
+				SDL_CondWait(SDL_EventQ.room, SDL_EventQ.lock);
+				--SDL_EventQ.waiting;
+				break;
+			}
+			return(0);
+		    default:
+			return(0);
+		}
+	}
+	/* NOTREACHED */
+}
+
+/* Add two relative motions, or return 0 if they don't fit in a Sint16 */
+static int SDL_AddMotion(Sint16 *total, Sint16 motion)
+{
+	int sum = *total + motion;
+
+	if ( sum < -32768 || sum > 32767 ) {
+		return(0);
+	}
+	*total = (Sint16)sum;
+	return(1);
+}
+
+/* Merge an event into the last queued event of the same stream, if
+   only events of the same type were queued after it, and return 1, or
+   return 0 if it has to be queued -- called with the queue locked
+ */
+static int SDL_CoalesceEvent(const SDL_Event *event)
+{
+	SDL_Event *queued;
+	Sint16 xrel, yrel;
+	int spot;
+
+	for ( spot = SDL_EventQ.tail; spot >= 0;
+	      spot = SDL_EventQ.entry[spot].prev ) {
+		queued = &SDL_EventQ.entry[spot].event;
+		if ( queued->type != event->type ) {
+			return(0);
+		}
+		switch (event->type) {
+		    case SDL_MOUSEMOTION:
+			/* Motion between button changes only */
+			if ( queued->motion.which != event->motion.which ||
+			     queued->motion.state != event->motion.state ) {
+				return(0);
+			}
+			xrel = queued->motion.xrel;
+			yrel = queued->motion.yrel;
+			if ( !SDL_AddMotion(&xrel, event->motion.xrel) ||
+			     !SDL_AddMotion(&yrel, event->motion.yrel) ) {
+				return(0);
+			}
+			queued->motion.x = event->motion.x;
+			queued->motion.y = event->motion.y;
+			queued->motion.xrel = xrel;
+			queued->motion.yrel = yrel;
+			return(1);
+
+		    case SDL_JOYAXISMOTION:
+			if ( queued->jaxis.which == event->jaxis.which &&
+			     queued->jaxis.axis == event->jaxis.axis ) {
+				queued->jaxis.value = event->jaxis.value;
+				return(1);
+			}
+			/* Look past the other axes */
+			break;
+
+		    case SDL_JOYBALLMOTION:
+			if ( queued->jball.which == event->jball.which &&
+			     queued->jball.ball == event->jball.ball ) {
+				xrel = queued->jball.xrel;
+				yrel = queued->jball.yrel;
+				if ( !SDL_AddMotion(&xrel, event->jball.xrel) ||
+				     !SDL_AddMotion(&yrel, event->jball.yrel) ) {
+					return(0);
+				}
+				queued->jball.xrel = xrel;
+				queued->jball.yrel = yrel;
+				return(1);
+			}
+			/* Look past the other balls */
+			break;
+
+		    default:
+			return(0);
+		}
+	}
+	return(0);
+}
 
 /* Add an event to the event queue -- called with the queue locked */
-static int SDL_AddEvent(SDL_Event *event)
+static int SDL_AddEvent(SDL_Event *event, const Uint32 *timestamp)
 {
-	int tail, added;
+	SDL_EventEntry *entry;
+	int spot, added;
+	Uint8 type = event->type;
+	Uint32 when;
 
-	tail = (SDL_EventQ.tail+1)%MAXEVENTS;
-	if ( tail == SDL_EventQ.head ) {
+	if ( timestamp ) {
+		when = *timestamp;
+	} else if ( SDL_EventTime.set &&
+	            SDL_EventTime.thread == SDL_ThreadID() ) {
+		when = SDL_EventTime.timestamp;
+		if ( SDL_EventTime.set == SDL_EVENTTIME_ONCE ) {
+			SDL_EventTime.set = 0;
+		}
+	} else {
+		when = SDL_GetTicksUS();
+	}
+
+	if ( type < SDL_NUMEVENTS && SDL_CoalesceEvents[type] &&
+	     SDL_CoalesceEvent(event) ) {
+		++SDL_EventStatistics.coalesced[type];
+		added = 1;
+	} else
+	if ( ! SDL_RoomForEvent() ) {
 		/* Overflow, drop event */
+		if ( type < SDL_NUMEVENTS ) {
+			++SDL_EventStatistics.dropped[type];
+		}
 		added = 0;
 	} else {
-		SDL_EventQ.event[SDL_EventQ.tail] = *event;
+		spot = SDL_EventQ.free;
+		entry = &SDL_EventQ.entry[spot];
+		SDL_EventQ.free = entry->next;
+
+		entry->event = *event;
 		if (event->type == SDL_SYSWMEVENT) {
 			/* Note that it's possible to lose an event */
 			int next = SDL_EventQ.wmmsg_next;
 			SDL_EventQ.wmmsg[next] = *event->syswm.msg;
-		        SDL_EventQ.event[SDL_EventQ.tail].syswm.msg =
-						&SDL_EventQ.wmmsg[next];
+		        entry->event.syswm.msg = &SDL_EventQ.wmmsg[next];
 			SDL_EventQ.wmmsg_next = (next+1)%MAXEVENTS;
 		}
-		SDL_EventQ.tail = tail;
+		entry->seq = SDL_EventQ.seq++;
+		entry->timestamp = when;
+
+		/* Link it at the end of both lists */
+		entry->next = -1;
+		entry->prev = SDL_EventQ.tail;
+		if ( SDL_EventQ.tail >= 0 ) {
+			SDL_EventQ.entry[SDL_EventQ.tail].next = spot;
+		} else {
+			SDL_EventQ.head = spot;
+		}
+		SDL_EventQ.tail = spot;
+		entry->type_next = -1;
+		entry->type_prev = SDL_EventQ.type_tail[type];
+		if ( SDL_EventQ.type_tail[type] >= 0 ) {
+			SDL_EventQ.entry[SDL_EventQ.type_tail[type]].type_next = spot;
+		} else {
+			SDL_EventQ.type_head[type] = spot;
+		}
+		SDL_EventQ.type_tail[type] = spot;
+		++SDL_EventQ.count;
+		if ( type < SDL_NUMEVENTS ) {
+			++SDL_EventStatistics.queued[type];
+		}
+		if ( (Uint32)SDL_EventQ.count > SDL_EventStatistics.high_water ) {
+			SDL_EventStatistics.high_water = SDL_EventQ.count;
+		}
 		added = 1;
+#ifdef SDL_EVENT_WAKEUP_PIPE
+		if ( SDL_EventQ.sleepers ) {
+			SDL_Wakeup(SDL_EventQ.wakeup);
+		}
+#endif
 	}
 	return(added);
 }
 
-/* Cut an event, and return the next valid spot, or the tail */
-/*                           -- called with the queue locked */
-static int SDL_CutEvent(int spot)
+/* Count an event taken out of the queue at 'now', in SDL_GetTicksUS()
+   time -- called with the queue locked
+ */
+static void SDL_CountDequeued(const SDL_EventEntry *entry, Uint32 now)
 {
-	if ( spot == SDL_EventQ.head ) {
-		SDL_EventQ.head = (SDL_EventQ.head+1)%MAXEVENTS;
-		return(SDL_EventQ.head);
-	} else
-	if ( (spot+1)%MAXEVENTS == SDL_EventQ.tail ) {
-		SDL_EventQ.tail = spot;
-		return(SDL_EventQ.tail);
-	} else
-	/* We cut the middle -- shift everything over */
-	{
-		int here, next;
+	Uint32 latency;
+	int bucket;
+
+	if ( entry->event.type < SDL_NUMEVENTS ) {
+		++SDL_EventStatistics.dequeued[entry->event.type];
+	}
+	latency = now - entry->timestamp;
+	if ( (Sint32)latency < 0 ) {
+		/* The driver's clock estimate ran a little ahead */
+		latency = 0;
+	}
+	for ( bucket = 0; bucket < SDL_EVENT_LATENCY_BUCKETS-1; ++bucket ) {
+		if ( latency < ((Uint32)64 << bucket) ) {
+			break;
+		}
+	}
+	++SDL_EventStatistics.latency[bucket];
+	if ( latency > SDL_EventStatistics.max_latency ) {
+		SDL_EventStatistics.max_latency = latency;
+	}
+}
+
+/* Return up to 'numevents' queued events matching 'mask' in the order
+   they were added, with their times in 'timestamps' if it isn't NULL,
+   taking them out for SDL_GETEVENT, by merging the lists of the event
+   types in the mask -- called with the queue locked
+ */
+static int SDL_PeepMaskedEvents(SDL_Event *events, Uint32 *timestamps,
+			int numevents, SDL_eventaction action, Uint32 mask)
+{
+	int spots[SDL_NUMEVENTS];
+	int i, n, first, used;
+	Uint32 now = 0;
+
+	if ( action == SDL_GETEVENT ) {
+		now = SDL_GetTicksUS();
+	}
 
-		/* This can probably be optimized with SDL_memcpy() -- careful! */
-		if ( --SDL_EventQ.tail < 0 ) {
-			SDL_EventQ.tail = MAXEVENTS-1;
+	n = 0;
+	for ( i = 0; i < SDL_NUMEVENTS; ++i ) {
+		if ( (mask & SDL_EVENTMASK(i)) && SDL_EventQ.type_head[i] >= 0 ) {
+			spots[n++] = SDL_EventQ.type_head[i];
+		}
+	}
+	used = 0;
+	while ( (used < numevents) && (n > 0) ) {
+		/* The oldest of the first events of each type is next */
+		first = 0;
+		for ( i = 1; i < n; ++i ) {
+			if ( (Sint32)(SDL_EventQ.entry[spots[i]].seq -
+			              SDL_EventQ.entry[spots[first]].seq) < 0 ) {
+				first = i;
+			}
 		}
-		for ( here=spot; here != SDL_EventQ.tail; here = next ) {
-			next = (here+1)%MAXEVENTS;
-			SDL_EventQ.event[here] = SDL_EventQ.event[next];
+		if ( timestamps ) {
+			timestamps[used] = SDL_EventQ.entry[spots[first]].timestamp;
+		}
+		SDL_EventQ.last_timestamp = SDL_EventQ.entry[spots[first]].timestamp;
+		events[used++] = SDL_EventQ.entry[spots[first]].event;
+		if ( action == SDL_GETEVENT ) {
+			SDL_CountDequeued(&SDL_EventQ.entry[spots[first]], now);
+			spots[first] = SDL_CutEvent(spots[first]);
+		} else {
+			spots[first] = SDL_EventQ.entry[spots[first]].type_next;
+		}
+		if ( spots[first] < 0 ) {
+			spots[first] = spots[--n];
 		}
-		return(spot);
 	}
-	/* NOTREACHED */
+	return(used);
 }
 
 /* Lock the event queue, take a peep at it, and unlock it */
-int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
-								Uint32 mask)
+int SDL_PeepEventsTimestamped(SDL_Event *events, Uint32 *timestamps,
+		int numevents, SDL_eventaction action, Uint32 mask)
 {
 	int i, used;
 
@@ -330,31 +960,49 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 	if ( SDL_mutexP(SDL_EventQ.lock) == 0 ) {
 		if ( action == SDL_ADDEVENT ) {
 			for ( i=0; i<numevents; ++i ) {
-				used += SDL_AddEvent(&events[i]);
+				used += SDL_AddEvent(&events[i],
+				           timestamps ? &timestamps[i] : NULL);
 			}
 		} else {
 			SDL_Event tmpevent;
-			int spot;
+			int spot, next;
 
 			/* If 'events' is NULL, just see if they exist */
 			if ( events == NULL ) {
 				action = SDL_PEEKEVENT;
 				numevents = 1;
 				events = &tmpevent;
+				timestamps = NULL;
 			}
-			spot = SDL_EventQ.head;
-			while ((used < numevents)&&(spot != SDL_EventQ.tail)) {
-				if ( mask & SDL_EVENTMASK(SDL_EventQ.event[spot].type) ) {
-					events[used++] = SDL_EventQ.event[spot];
+			SDL_EventQ.reader = SDL_ThreadID();
+			if ( mask != SDL_ALLEVENTS ) {
+				used = SDL_PeepMaskedEvents(events, timestamps,
+				                            numevents, action, mask);
+			} else {
+				Uint32 now = 0;
+
+				if ( action == SDL_GETEVENT ) {
+					now = SDL_GetTicksUS();
+				}
+				spot = SDL_EventQ.head;
+				while ((used < numevents)&&(spot >= 0)) {
+					if ( timestamps ) {
+						timestamps[used] = SDL_EventQ.entry[spot].timestamp;
+					}
+					SDL_EventQ.last_timestamp = SDL_EventQ.entry[spot].timestamp;
+					events[used++] = SDL_EventQ.entry[spot].event;
+					next = SDL_EventQ.entry[spot].next;
 					if ( action == SDL_GETEVENT ) {
-						spot = SDL_CutEvent(spot);
-					} else {
-						spot = (spot+1)%MAXEVENTS;
+						SDL_CountDequeued(&SDL_EventQ.entry[spot], now);
+						SDL_CutEvent(spot);
 					}
-				} else {
-					spot = (spot+1)%MAXEVENTS;
+					spot = next;
 				}
 			}
+			if ( used && action == SDL_GETEVENT &&
+			     SDL_EventQ.waiting ) {
+				SDL_CondBroadcast(SDL_EventQ.room);
+			}
 		}
 		SDL_mutexV(SDL_EventQ.lock);
 	} else {
@@ -364,6 +1012,17 @@ int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
 	return(used);
 }
 
+int SDL_PeepEvents(SDL_Event *events, int numevents, SDL_eventaction action,
+								Uint32 mask)
+{
+	return SDL_PeepEventsTimestamped(events, NULL, numevents, action, mask);
+}
+
+Uint32 SDL_GetEventTimestamp(void)
+{
+	return(SDL_EventQ.last_timestamp);
+}
+
 /* Run the system dependent event loops */
 void SDL_PumpEvents(void)
 {
@@ -372,6 +1031,7 @@ void SDL_PumpEvents(void)
 		SDL_VideoDevice *this  = current_video;
 
 		/* Get events from the video subsystem */
+		SDL_BeginInputPump();
 		if ( video ) {
 			video->PumpEvents(this);
 		}
@@ -385,7 +1045,11 @@ void SDL_PumpEvents(void)
 			SDL_JoystickUpdate();
 		}
 #endif
+		SDL_EndInputPump();
 	}
+
+	/* Feed in the recorded input that is due */
+	SDL_ReplayInput();
 }
 
 /* Public functions */
@@ -400,18 +1064,78 @@ int SDL_PollEvent (SDL_Event *event)
 	return 1;
 }
 
-int SDL_WaitEvent (SDL_Event *event)
+/* Sleep until events may have arrived, or for 'timeout' milliseconds */
+static void SDL_SleepForEvents(Uint32 timeout)
 {
+#ifdef SDL_EVENT_WAKEUP_PIPE
+	int fds[8];
+	int nfds;
+
+	/* Sleep no longer than the event loop can go without being pumped */
+	nfds = 0;
+	if ( !SDL_EventThread ) {
+		nfds = SDL_GetEventFDs(fds, SDL_arraysize(fds), &timeout, 10);
+		if ( nfds < 0 ) {
+			return;
+		}
+	}
+	if ( SDL_EventQ.wakeup[0] < 0 ) {
+		SDL_Delay(timeout < 10 ? timeout : 10);
+		return;
+	}
+
+	/* Events pushed from here on write to the wakeup pipe */
+	if ( SDL_mutexP(SDL_EventQ.lock) < 0 ) {
+		return;
+	}
+	if ( SDL_QueuedEvents() ) {
+		SDL_mutexV(SDL_EventQ.lock);
+		return;
+	}
+	++SDL_EventQ.sleepers;
+	SDL_mutexV(SDL_EventQ.lock);
+
+	SDL_SelectEvents(SDL_EventQ.wakeup, fds, nfds, timeout);
+
+	SDL_mutexP(SDL_EventQ.lock);
+	--SDL_EventQ.sleepers;
+	SDL_mutexV(SDL_EventQ.lock);
+#else
+	SDL_Delay(timeout < 10 ? timeout : 10);
+#endif /* SDL_EVENT_WAKEUP_PIPE */
+}
+
+int SDL_WaitEventTimeout (SDL_Event *event, int timeout)
+{
+	Uint32 start = SDL_GetTicks();
+	Uint32 elapsed, wait;
+
 	while ( 1 ) {
 		SDL_PumpEvents();
 		switch(SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_ALLEVENTS)) {
 		    case -1: return 0;
 		    case 1: return 1;
-		    case 0: SDL_Delay(10);
+		}
+		if ( timeout < 0 ) {
+			wait = SDL_WAIT_FOREVER;
+		} else {
+			elapsed = SDL_GetTicks() - start;
+			if ( elapsed >= (Uint32)timeout ) {
+				return 0;
+			}
+			wait = timeout - elapsed;
+		}
+		if ( !SDL_ReplayWait(&wait) ) {
+			SDL_SleepForEvents(wait);
 		}
 	}
 }
 
+int SDL_WaitEvent (SDL_Event *event)
+{
+	return SDL_WaitEventTimeout(event, -1);
+}
+
 int SDL_PushEvent(SDL_Event *event)
 {
 	if ( SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0) <= 0 )
@@ -480,6 +1204,102 @@ Uint8 SDL_EventState (Uint8 type, int state)
 	return(current_state);
 }
 
+Uint8 SDL_EventCoalesce (Uint8 type, int state)
+{
+	Uint8 current_state;
+
+	if ( type >= SDL_NUMEVENTS ) {
+		return(SDL_DISABLE);
+	}
+	current_state = SDL_CoalesceEvents[type];
+	switch (state) {
+		case SDL_DISABLE:
+		case SDL_ENABLE:
+			switch (type) {
+				case SDL_MOUSEMOTION:
+				case SDL_JOYAXISMOTION:
+				case SDL_JOYBALLMOTION:
+					SDL_CoalesceEvents[type] = state;
+					break;
+				default:
+					break;
+			}
+			break;
+		default:
+			/* Querying state? */
+			break;
+	}
+	return(current_state);
+}
+
+Uint32 SDL_GetCoalescedEvents (Uint8 type)
+{
+	if ( type >= SDL_NUMEVENTS ) {
+		return(0);
+	}
+	return(SDL_EventStatistics.coalesced[type]);
+}
+
+int SDL_GetEventStats (SDL_EventStats *stats)
+{
+	if ( ! SDL_EventQ.active ) {
+		SDL_SetError("The event queue isn't running");
+		return(-1);
+	}
+	if ( SDL_mutexP(SDL_EventQ.lock) < 0 ) {
+		return(-1);
+	}
+	*stats = SDL_EventStatistics;
+	SDL_mutexV(SDL_EventQ.lock);
+	return(0);
+}
+
+void SDL_ResetEventStats (void)
+{
+	if ( SDL_EventQ.active && SDL_mutexP(SDL_EventQ.lock) == 0 ) {
+		SDL_memset(&SDL_EventStatistics, 0, sizeof(SDL_EventStatistics));
+		SDL_mutexV(SDL_EventQ.lock);
+	} else {
+		SDL_memset(&SDL_EventStatistics, 0, sizeof(SDL_EventStatistics));
+	}
+}
+
+int SDL_FilterEvent (SDL_Event *event)
+{
+	Uint32 self = SDL_ThreadID();
+
+	/* The event was just created, unless the driver knows better */
+	if ( SDL_EventTime.set != SDL_EVENTTIME_DRIVER ||
+	     SDL_EventTime.thread != self ) {
+		SDL_EventTime.timestamp = SDL_GetTicksUS();
+		SDL_EventTime.thread = self;
+		SDL_EventTime.set = SDL_EVENTTIME_ONCE;
+	}
+
+	if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(event) ) {
+		return(1);
+	}
+	if ( SDL_EventTime.set == SDL_EVENTTIME_ONCE ) {
+		SDL_EventTime.set = 0;
+	}
+	if ( event->type < SDL_NUMEVENTS ) {
+		++SDL_EventStatistics.filtered[event->type];
+	}
+	return(0);
+}
+
+void SDL_SetEventTimestamp (Uint32 timestamp)
+{
+	SDL_EventTime.timestamp = timestamp;
+	SDL_EventTime.thread = SDL_ThreadID();
+	SDL_EventTime.set = SDL_EVENTTIME_DRIVER;
+}
+
+void SDL_ClearEventTimestamp (void)
+{
+	SDL_EventTime.set = 0;
+}
+
 /* This is a generic event handler.
  */
 int SDL_PrivateSysWMEvent(SDL_SysWMmsg *message)
@@ -492,7 +1312,7 @@ int SDL_PrivateSysWMEvent(SDL_SysWMmsg *message)
 		SDL_memset(&event, 0, sizeof(event));
 		event.type = SDL_SYSWMEVENT;
 		event.syswm.msg = message;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -33,6 +33,9 @@ extern void SDL_Lock_EventThread(void);
 extern void SDL_Unlock_EventThread(void);
 extern Uint32 SDL_EventThreadID(void);
 
+/* Used by the timers to wake the event thread when a timer is added */
+extern void SDL_TimerChanged(void);
+
 /* Event handler init routines */
 extern int  SDL_AppActiveInit(void);
 extern int  SDL_KeyboardInit(void);
@@ -48,6 +51,18 @@ extern void SDL_QuitQuit(void);
 /* The event filter function */
 extern SDL_EventFilter SDL_EventOK;
 
+/* Run the event filter on an event about to be queued, returning 1 if
+   the event should be queued, and count the events it drops.  This also
+   takes the time the event was created, if the driver didn't give it.
+ */
+extern int SDL_FilterEvent(SDL_Event *event);
+
+/* Used by the drivers to stamp the events they are about to queue with
+   the SDL_GetTicksUS() time the OS says they happened, until cleared
+ */
+extern void SDL_SetEventTimestamp(Uint32 timestamp);
+extern void SDL_ClearEventTimestamp(void);
+
 /* The array of event processing states */
 extern Uint8 SDL_ProcessEvents[SDL_NUMEVENTS];
 
@@ -64,6 +79,34 @@ extern int SDL_PrivateExpose(void);
 extern int SDL_PrivateQuit(void);
 extern int SDL_PrivateSysWMEvent(SDL_SysWMmsg *message);
 
+/* Input recording and replay (from SDL_replay.c)
+
+   The input functions above and the joystick ones pass their arguments to
+   SDL_RecordInput() in an event of their type, with the button state and
+   relative flag of SDL_PrivateMouseMotion() in motion.state and
+   motion.which.  It records the input when it comes from the drivers,
+   between SDL_BeginInputPump() and SDL_EndInputPump(), and returns 1 if
+   the input should be ignored because a replay is running.
+ */
+extern int SDL_RecordInput(const SDL_Event *input);
+extern void SDL_BeginInputPump(void);
+extern void SDL_EndInputPump(void);
+
+/* Replay the input that is due, from SDL_PumpEvents() */
+extern void SDL_ReplayInput(void);
+
+/* Called before sleeping up to 'timeout' milliseconds for events; this
+   shortens the timeout to the next replayed input, or returns 1 if it
+   moved the clock ahead to it instead, so there's no need to sleep
+ */
+extern int SDL_ReplayWait(Uint32 *timeout);
+
+/* Start the recording or replay SDL_INPUT_RECORD or SDL_INPUT_REPLAY ask
+   for when the event loop starts, and stop them when it stops
+ */
+extern void SDL_InputRecordInit(void);
+extern void SDL_InputRecordQuit(void);
+
 /* Used to clamp the mouse coordinates separately from the video surface */
 extern void SDL_SetMouseRange(int maxX, int maxY);
 
@@ -75,6 +118,7 @@ extern void SDL_ResetKeyboard(void);
 
 /* Used by the event loop to queue pending keyboard repeat events */
 extern void SDL_CheckKeyRepeat(void);
+extern int SDL_KeyRepeatTimeout(void);
 
 /* Used by the OS keyboard code to detect whether or not to do UNICODE */
 #ifndef DEFAULT_UNICODE_TRANSLATION
@@ -33,6 +33,11 @@ int SDL_PrivateExpose(void)
 	int posted;
 	SDL_Event events[32];
 
+	events[0].type = SDL_VIDEOEXPOSE;
+	if ( SDL_RecordInput(&events[0]) ) {
+		return(0);
+	}
+
 	/* Pull out all old refresh events */
 	SDL_PeepEvents(events, sizeof(events)/sizeof(events[0]),
 	                    SDL_GETEVENT, SDL_VIDEOEXPOSEMASK);
@@ -42,7 +47,7 @@ int SDL_PrivateExpose(void)
 	if ( SDL_ProcessEvents[SDL_VIDEOEXPOSE] == SDL_ENABLE ) {
 		SDL_Event event;
 		event.type = SDL_VIDEOEXPOSE;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
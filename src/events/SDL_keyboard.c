@@ -402,6 +402,12 @@ int SDL_PrivateKeyboard(Uint8 state, SDL_keysym *keysym)
 	int posted, repeatable;
 	Uint16 modstate;
 
+	event.type = (state == SDL_PRESSED) ? SDL_KEYDOWN : SDL_KEYUP;
+	event.key.keysym = *keysym;
+	if ( SDL_RecordInput(&event) ) {
+		return(0);
+	}
+
 	SDL_memset(&event, 0, sizeof(event));
 
 #if 0
@@ -559,7 +565,7 @@ printf("Keyboard event didn't change state - dropped!\n");
 			SDL_KeyRepeat.firsttime = 1;
 			SDL_KeyRepeat.timestamp=SDL_GetTicks();
 		}
-		if ( (SDL_EventOK == NULL) || SDL_EventOK(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -585,7 +591,7 @@ void SDL_CheckKeyRepeat(void)
 		} else {
 			if ( interval > (Uint32)SDL_KeyRepeat.interval ) {
 				SDL_KeyRepeat.timestamp = now;
-				if ( (SDL_EventOK == NULL) || SDL_EventOK(&SDL_KeyRepeat.evt) ) {
+				if ( SDL_FilterEvent(&SDL_KeyRepeat.evt) ) {
 					SDL_PushEvent(&SDL_KeyRepeat.evt);
 				}
 			}
@@ -593,6 +599,28 @@ void SDL_CheckKeyRepeat(void)
 	}
 }
 
+/* Return how many milliseconds the event loop can go without calling
+   SDL_CheckKeyRepeat(), or -1 if no key is repeating.
+ */
+int SDL_KeyRepeatTimeout(void)
+{
+	Uint32 interval, elapsed;
+
+	if ( ! SDL_KeyRepeat.timestamp ) {
+		return(-1);
+	}
+	if ( SDL_KeyRepeat.firsttime ) {
+		interval = SDL_KeyRepeat.delay;
+	} else {
+		interval = SDL_KeyRepeat.interval;
+	}
+	elapsed = SDL_GetTicks() - SDL_KeyRepeat.timestamp;
+	if ( elapsed > interval ) {
+		return(0);
+	}
+	return((int)(interval - elapsed) + 1);
+}
+
 int SDL_EnableKeyRepeat(int delay, int interval)
 {
 	if ( (delay < 0) || (interval < 0) ) {
@@ -112,11 +112,21 @@ void SDL_SetMouseRange(int maxX, int maxY)
 /* These are global for SDL_eventloop.c */
 int SDL_PrivateMouseMotion(Uint8 buttonstate, int relative, Sint16 x, Sint16 y)
 {
+	SDL_Event input;
 	int posted;
 	Uint16 X, Y;
 	Sint16 Xrel;
 	Sint16 Yrel;
 
+	input.type = SDL_MOUSEMOTION;
+	input.motion.state = buttonstate;
+	input.motion.which = (Uint8)relative;
+	input.motion.x = (Uint16)x;
+	input.motion.y = (Uint16)y;
+	if ( SDL_RecordInput(&input) ) {
+		return(0);
+	}
+
 	/* Default buttonstate is the current one */
 	if ( ! buttonstate ) {
 		buttonstate = SDL_ButtonState;
@@ -186,7 +196,7 @@ printf("Mouse event didn't change state - dropped!\n");
 		event.motion.y = Y;
 		event.motion.xrel = Xrel;
 		event.motion.yrel = Yrel;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -201,6 +211,15 @@ int SDL_PrivateMouseButton(Uint8 state, Uint8 button, Sint16 x, Sint16 y)
 	int move_mouse;
 	Uint8 buttonstate;
 
+	event.type = (state == SDL_PRESSED) ? SDL_MOUSEBUTTONDOWN :
+	                                      SDL_MOUSEBUTTONUP;
+	event.button.button = button;
+	event.button.x = (Uint16)x;
+	event.button.y = (Uint16)y;
+	if ( SDL_RecordInput(&event) ) {
+		return(0);
+	}
+
 	SDL_memset(&event, 0, sizeof(event));
 
 	/* Check parameters */
@@ -258,7 +277,7 @@ int SDL_PrivateMouseButton(Uint8 state, Uint8 button, Sint16 x, Sint16 y)
 		event.button.button = button;
 		event.button.x = x;
 		event.button.y = y;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -109,13 +109,19 @@ void SDL_QuitQuit(void)
 /* This function returns 1 if it's okay to close the application window */
 int SDL_PrivateQuit(void)
 {
+	SDL_Event input;
 	int posted;
 
+	input.type = SDL_QUIT;
+	if ( SDL_RecordInput(&input) ) {
+		return(0);
+	}
+
 	posted = 0;
 	if ( SDL_ProcessEvents[SDL_QUIT] == SDL_ENABLE ) {
 		SDL_Event event;
 		event.type = SDL_QUIT;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
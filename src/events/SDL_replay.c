@@ -0,0 +1,579 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Input recording and replay, see SDL_StartInputRecording_RW()
+
+   The stream starts with two little endian 32-bit words:
+	"SDLI" magic, format version (1)
+   followed by one record for each time a driver called an SDL_Private*
+   input function: the 32-bit SDL_GetTicks() time since recording started,
+   the 8-bit event type, and the arguments of the call, 8-bit values and
+   little endian 16-bit values packed without padding:
+	SDL_ACTIVEEVENT		gain, state
+	SDL_KEYDOWN/UP		scancode, sym (16), unicode (16)
+	SDL_MOUSEMOTION		button state, relative, x (16), y (16)
+	SDL_MOUSEBUTTONDOWN/UP	button, x (16), y (16)
+	SDL_JOYAXISMOTION	joystick index, axis, value (16)
+	SDL_JOYBALLMOTION	joystick index, ball, xrel (16), yrel (16)
+	SDL_JOYHATMOTION	joystick index, hat, value
+	SDL_JOYBUTTONDOWN/UP	joystick index, button
+	SDL_VIDEORESIZE		w (16), h (16)
+	SDL_QUIT, SDL_VIDEOEXPOSE
+ */
+
+#include "SDL_events.h"
+#include "SDL_thread.h"
+#include "SDL_endian.h"
+#include "SDL_events_c.h"
+#include "../timer/SDL_timer_c.h"
+#if !SDL_JOYSTICK_DISABLED
+#include "../joystick/SDL_joystick_c.h"
+#endif
+
+#define SDL_INPUT_MAGIC		0x494C4453	/* "SDLI" */
+#define SDL_INPUT_VERSION	1
+
+/* The longest record: time, type and SDL_MOUSEMOTION arguments */
+#define SDL_INPUT_MAXRECORD	(4+1+6)
+
+static struct {
+	SDL_RWops *dst;
+	int freedst;
+	int error;
+	Uint32 start;
+} SDL_InputRecorder;
+
+static struct {
+	SDL_RWops *src;
+	int freesrc;
+	Uint32 flags;
+	Uint32 start;
+	int injecting;		/* Calling the input functions */
+	Uint32 time;		/* When 'next' is due */
+	SDL_Event next;
+} SDL_InputReplay;
+
+/* The thread pumping the drivers */
+static Uint32 SDL_InputPumpThread;
+static int SDL_InputPumping = 0;
+
+
+/* The number of argument bytes recorded for an event type, or -1 */
+static int SDL_InputSize(Uint8 type)
+{
+	switch (type) {
+	    case SDL_ACTIVEEVENT:
+	    case SDL_JOYBUTTONDOWN:
+	    case SDL_JOYBUTTONUP:
+		return(2);
+	    case SDL_JOYHATMOTION:
+		return(3);
+	    case SDL_JOYAXISMOTION:
+	    case SDL_VIDEORESIZE:
+		return(4);
+	    case SDL_KEYDOWN:
+	    case SDL_KEYUP:
+	    case SDL_MOUSEBUTTONDOWN:
+	    case SDL_MOUSEBUTTONUP:
+		return(5);
+	    case SDL_MOUSEMOTION:
+	    case SDL_JOYBALLMOTION:
+		return(6);
+	    case SDL_QUIT:
+	    case SDL_VIDEOEXPOSE:
+		return(0);
+	    default:
+		return(-1);
+	}
+}
+
+static Uint8 *SDL_InputWord(Uint8 *data, Uint16 value)
+{
+	data[0] = (Uint8)value;
+	data[1] = (Uint8)(value >> 8);
+	return(data + 2);
+}
+
+static Uint16 SDL_InputGetWord(const Uint8 *data)
+{
+	return (Uint16)(data[0] | (data[1] << 8));
+}
+
+static void SDL_WriteInput(const SDL_Event *input)
+{
+	Uint8 data[SDL_INPUT_MAXRECORD];
+	Uint8 *p;
+	Uint32 time;
+
+	time = SDL_GetTicks() - SDL_InputRecorder.start;
+	data[0] = (Uint8)time;
+	data[1] = (Uint8)(time >> 8);
+	data[2] = (Uint8)(time >> 16);
+	data[3] = (Uint8)(time >> 24);
+	data[4] = input->type;
+	p = &data[5];
+	switch (input->type) {
+	    case SDL_ACTIVEEVENT:
+		*p++ = input->active.gain;
+		*p++ = input->active.state;
+		break;
+	    case SDL_KEYDOWN:
+	    case SDL_KEYUP:
+		*p++ = input->key.keysym.scancode;
+		p = SDL_InputWord(p, (Uint16)input->key.keysym.sym);
+		p = SDL_InputWord(p, input->key.keysym.unicode);
+		break;
+	    case SDL_MOUSEMOTION:
+		*p++ = input->motion.state;
+		*p++ = input->motion.which;
+		p = SDL_InputWord(p, input->motion.x);
+		p = SDL_InputWord(p, input->motion.y);
+		break;
+	    case SDL_MOUSEBUTTONDOWN:
+	    case SDL_MOUSEBUTTONUP:
+		*p++ = input->button.button;
+		p = SDL_InputWord(p, input->button.x);
+		p = SDL_InputWord(p, input->button.y);
+		break;
+	    case SDL_JOYAXISMOTION:
+		*p++ = input->jaxis.which;
+		*p++ = input->jaxis.axis;
+		p = SDL_InputWord(p, (Uint16)input->jaxis.value);
+		break;
+	    case SDL_JOYBALLMOTION:
+		*p++ = input->jball.which;
+		*p++ = input->jball.ball;
+		p = SDL_InputWord(p, (Uint16)input->jball.xrel);
+		p = SDL_InputWord(p, (Uint16)input->jball.yrel);
+		break;
+	    case SDL_JOYHATMOTION:
+		*p++ = input->jhat.which;
+		*p++ = input->jhat.hat;
+		*p++ = input->jhat.value;
+		break;
+	    case SDL_JOYBUTTONDOWN:
+	    case SDL_JOYBUTTONUP:
+		*p++ = input->jbutton.which;
+		*p++ = input->jbutton.button;
+		break;
+	    case SDL_VIDEORESIZE:
+		p = SDL_InputWord(p, (Uint16)input->resize.w);
+		p = SDL_InputWord(p, (Uint16)input->resize.h);
+		break;
+	    default:
+		break;
+	}
+	if ( !SDL_InputRecorder.error &&
+	     SDL_RWwrite(SDL_InputRecorder.dst, data, p - data, 1) != 1 ) {
+		SDL_InputRecorder.error = 1;
+	}
+}
+
+/* Read the next record into SDL_InputReplay.next, returning 0 at the end
+   of the recording
+ */
+static int SDL_ReadInput(void)
+{
+	Uint8 data[SDL_INPUT_MAXRECORD];
+	SDL_Event *input = &SDL_InputReplay.next;
+	Uint8 *p;
+	int size;
+
+	if ( SDL_RWread(SDL_InputReplay.src, data, 5, 1) != 1 ) {
+		return(0);
+	}
+	size = SDL_InputSize(data[4]);
+	if ( size < 0 ) {
+		SDL_SetError("Unknown input type %d in recording", data[4]);
+		return(0);
+	}
+	if ( size && (SDL_RWread(SDL_InputReplay.src, &data[5], size, 1) != 1) ) {
+		return(0);
+	}
+	SDL_InputReplay.time = data[0] | (data[1] << 8) |
+	                       (data[2] << 16) | ((Uint32)data[3] << 24);
+
+	SDL_memset(input, 0, sizeof(*input));
+	input->type = data[4];
+	p = &data[5];
+	switch (input->type) {
+	    case SDL_ACTIVEEVENT:
+		input->active.gain = p[0];
+		input->active.state = p[1];
+		break;
+	    case SDL_KEYDOWN:
+	    case SDL_KEYUP:
+		input->key.state = (input->type == SDL_KEYDOWN) ?
+		                   SDL_PRESSED : SDL_RELEASED;
+		input->key.keysym.scancode = p[0];
+		input->key.keysym.sym = (SDLKey)SDL_InputGetWord(&p[1]);
+		input->key.keysym.unicode = SDL_InputGetWord(&p[3]);
+		break;
+	    case SDL_MOUSEMOTION:
+		input->motion.state = p[0];
+		input->motion.which = p[1];
+		input->motion.x = SDL_InputGetWord(&p[2]);
+		input->motion.y = SDL_InputGetWord(&p[4]);
+		break;
+	    case SDL_MOUSEBUTTONDOWN:
+	    case SDL_MOUSEBUTTONUP:
+		input->button.state = (input->type == SDL_MOUSEBUTTONDOWN) ?
+		                      SDL_PRESSED : SDL_RELEASED;
+		input->button.button = p[0];
+		input->button.x = SDL_InputGetWord(&p[1]);
+		input->button.y = SDL_InputGetWord(&p[3]);
+		break;
+	    case SDL_JOYAXISMOTION:
+		input->jaxis.which = p[0];
+		input->jaxis.axis = p[1];
+		input->jaxis.value = (Sint16)SDL_InputGetWord(&p[2]);
+		break;
+	    case SDL_JOYBALLMOTION:
+		input->jball.which = p[0];
+		input->jball.ball = p[1];
+		input->jball.xrel = (Sint16)SDL_InputGetWord(&p[2]);
+		input->jball.yrel = (Sint16)SDL_InputGetWord(&p[4]);
+		break;
+	    case SDL_JOYHATMOTION:
+		input->jhat.which = p[0];
+		input->jhat.hat = p[1];
+		input->jhat.value = p[2];
+		break;
+	    case SDL_JOYBUTTONDOWN:
+	    case SDL_JOYBUTTONUP:
+		input->jbutton.which = p[0];
+		input->jbutton.button = p[1];
+		input->jbutton.state = (input->type == SDL_JOYBUTTONDOWN) ?
+		                       SDL_PRESSED : SDL_RELEASED;
+		break;
+	    case SDL_VIDEORESIZE:
+		input->resize.w = (Sint16)SDL_InputGetWord(&p[0]);
+		input->resize.h = (Sint16)SDL_InputGetWord(&p[2]);
+		break;
+	    default:
+		break;
+	}
+	return(1);
+}
+
+/* Call the input function a record was made from */
+static void SDL_InjectInput(SDL_Event *input)
+{
+#if !SDL_JOYSTICK_DISABLED
+	SDL_Joystick *joystick;
+#endif
+
+	switch (input->type) {
+	    case SDL_ACTIVEEVENT:
+		SDL_PrivateAppActive(input->active.gain, input->active.state);
+		break;
+	    case SDL_KEYDOWN:
+	    case SDL_KEYUP:
+		SDL_PrivateKeyboard(input->key.state, &input->key.keysym);
+		break;
+	    case SDL_MOUSEMOTION:
+		SDL_PrivateMouseMotion(input->motion.state, input->motion.which,
+		           (Sint16)input->motion.x, (Sint16)input->motion.y);
+		break;
+	    case SDL_MOUSEBUTTONDOWN:
+	    case SDL_MOUSEBUTTONUP:
+		SDL_PrivateMouseButton(input->button.state,
+		           input->button.button,
+		           (Sint16)input->button.x, (Sint16)input->button.y);
+		break;
+#if !SDL_JOYSTICK_DISABLED
+	    case SDL_JOYAXISMOTION:
+		joystick = SDL_GetOpenedJoystick(input->jaxis.which);
+		if ( joystick ) {
+			SDL_PrivateJoystickAxis(joystick, input->jaxis.axis,
+			                        input->jaxis.value);
+		}
+		break;
+	    case SDL_JOYBALLMOTION:
+		joystick = SDL_GetOpenedJoystick(input->jball.which);
+		if ( joystick ) {
+			SDL_PrivateJoystickBall(joystick, input->jball.ball,
+			           input->jball.xrel, input->jball.yrel);
+		}
+		break;
+	    case SDL_JOYHATMOTION:
+		joystick = SDL_GetOpenedJoystick(input->jhat.which);
+		if ( joystick ) {
+			SDL_PrivateJoystickHat(joystick, input->jhat.hat,
+			                       input->jhat.value);
+		}
+		break;
+	    case SDL_JOYBUTTONDOWN:
+	    case SDL_JOYBUTTONUP:
+		joystick = SDL_GetOpenedJoystick(input->jbutton.which);
+		if ( joystick ) {
+			SDL_PrivateJoystickButton(joystick,
+			           input->jbutton.button, input->jbutton.state);
+		}
+		break;
+#endif /* !SDL_JOYSTICK_DISABLED */
+	    case SDL_VIDEORESIZE:
+		SDL_PrivateResize(input->resize.w, input->resize.h);
+		break;
+	    case SDL_VIDEOEXPOSE:
+		SDL_PrivateExpose();
+		break;
+	    case SDL_QUIT:
+		SDL_PrivateQuit();
+		break;
+	    default:
+		break;
+	}
+}
+
+int SDL_RecordInput(const SDL_Event *input)
+{
+	if ( (!SDL_InputRecorder.dst && !SDL_InputReplay.src) ||
+	     !SDL_InputPumping || (SDL_InputPumpThread != SDL_ThreadID()) ) {
+		/* Not from a driver, the application will do this again */
+		return(0);
+	}
+	if ( SDL_InputReplay.src && !SDL_InputReplay.injecting ) {
+		/* Live input is ignored while replaying */
+		return(1);
+	}
+	if ( SDL_InputRecorder.dst ) {
+		SDL_WriteInput(input);
+	}
+	return(0);
+}
+
+void SDL_BeginInputPump(void)
+{
+	SDL_InputPumpThread = SDL_ThreadID();
+	SDL_InputPumping = 1;
+}
+
+void SDL_EndInputPump(void)
+{
+	SDL_InputPumping = 0;
+}
+
+int SDL_StartInputRecording_RW(SDL_RWops *dst, int freedst)
+{
+	if ( dst == NULL ) {
+		return(-1);
+	}
+	if ( SDL_InputRecorder.dst ) {
+		SDL_SetError("Already recording input");
+		if ( freedst ) {
+			SDL_RWclose(dst);
+		}
+		return(-1);
+	}
+	if ( !SDL_WriteLE32(dst, SDL_INPUT_MAGIC) ||
+	     !SDL_WriteLE32(dst, SDL_INPUT_VERSION) ) {
+		SDL_Error(SDL_EFWRITE);
+		if ( freedst ) {
+			SDL_RWclose(dst);
+		}
+		return(-1);
+	}
+
+	SDL_Lock_EventThread();
+	SDL_InputRecorder.freedst = freedst;
+	SDL_InputRecorder.error = 0;
+	SDL_InputRecorder.start = SDL_GetTicks();
+	SDL_InputRecorder.dst = dst;
+	SDL_Unlock_EventThread();
+	return(0);
+}
+
+int SDL_StopInputRecording(void)
+{
+	SDL_RWops *dst;
+	int retval;
+
+	SDL_Lock_EventThread();
+	dst = SDL_InputRecorder.dst;
+	SDL_InputRecorder.dst = NULL;
+	SDL_Unlock_EventThread();
+	if ( dst == NULL ) {
+		return(0);
+	}
+
+	retval = 0;
+	if ( SDL_InputRecorder.error ) {
+		SDL_Error(SDL_EFWRITE);
+		retval = -1;
+	}
+	if ( SDL_InputRecorder.freedst && (SDL_RWclose(dst) < 0) ) {
+		retval = -1;
+	}
+	return(retval);
+}
+
+static void SDL_EndInputReplay(void)
+{
+	if ( SDL_InputReplay.flags & SDL_REPLAY_FAST ) {
+		SDL_SkipDelays(0);
+	}
+	if ( SDL_InputReplay.freesrc ) {
+		SDL_RWclose(SDL_InputReplay.src);
+	}
+	SDL_InputReplay.src = NULL;
+}
+
+int SDL_StartInputReplay_RW(SDL_RWops *src, int freesrc, Uint32 flags)
+{
+	if ( src == NULL ) {
+		return(-1);
+	}
+	if ( SDL_InputReplay.src ) {
+		SDL_SetError("Already replaying input");
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		return(-1);
+	}
+	if ( (SDL_ReadLE32(src) != SDL_INPUT_MAGIC) ||
+	     (SDL_ReadLE32(src) != SDL_INPUT_VERSION) ) {
+		SDL_SetError("Not an SDL input recording");
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		return(-1);
+	}
+
+	SDL_Lock_EventThread();
+	SDL_InputReplay.src = src;
+	SDL_InputReplay.freesrc = freesrc;
+	SDL_InputReplay.flags = flags;
+	SDL_InputReplay.start = SDL_GetTicks();
+	SDL_InputReplay.injecting = 0;
+	if ( flags & SDL_REPLAY_FAST ) {
+		SDL_SkipDelays(1);
+	}
+	if ( !SDL_ReadInput() ) {
+		SDL_EndInputReplay();
+	}
+	SDL_Unlock_EventThread();
+	return(0);
+}
+
+void SDL_StopInputReplay(void)
+{
+	SDL_Lock_EventThread();
+	if ( SDL_InputReplay.src ) {
+		SDL_EndInputReplay();
+	}
+	SDL_Unlock_EventThread();
+}
+
+int SDL_InputReplaying(void)
+{
+	return(SDL_InputReplay.src != NULL);
+}
+
+void SDL_ReplayInput(void)
+{
+	Uint32 now;
+
+	if ( !SDL_InputReplay.src ) {
+		return;
+	}
+	SDL_Lock_EventThread();
+	SDL_BeginInputPump();
+	SDL_InputReplay.injecting = 1;
+	now = SDL_GetTicks() - SDL_InputReplay.start;
+	while ( SDL_InputReplay.src &&
+	        ((Sint32)(now - SDL_InputReplay.time) >= 0) ) {
+		SDL_InjectInput(&SDL_InputReplay.next);
+		if ( !SDL_ReadInput() ) {
+			SDL_EndInputReplay();
+		}
+	}
+	SDL_InputReplay.injecting = 0;
+	SDL_EndInputPump();
+	SDL_Unlock_EventThread();
+}
+
+int SDL_ReplayWait(Uint32 *timeout)
+{
+	Uint32 now, wait, timer;
+
+	if ( !SDL_InputReplay.src ) {
+		return(0);
+	}
+	now = SDL_GetTicks() - SDL_InputReplay.start;
+	if ( (Sint32)(SDL_InputReplay.time - now) <= 0 ) {
+		/* The next input is due already */
+		return(1);
+	}
+	wait = SDL_InputReplay.time - now;
+	if ( wait > *timeout ) {
+		wait = *timeout;
+	}
+	if ( SDL_InputReplay.flags & SDL_REPLAY_FAST ) {
+		/* Stop at the timers on the way, and give them time to run */
+		if ( SDL_timer_running ) {
+			timer = SDL_ThreadedTimerTimeout();
+			if ( timer == 0 ) {
+				if ( *timeout > 1 ) {
+					*timeout = 1;
+				}
+				return(0);
+			}
+			if ( timer < wait ) {
+				wait = timer;
+			}
+		}
+		if ( SDL_AdvanceTicks(wait) == 0 ) {
+			return(1);
+		}
+	}
+	*timeout = wait;
+	return(0);
+}
+
+void SDL_InputRecordInit(void)
+{
+	const char *file;
+	const char *envr;
+	Uint32 flags;
+
+	file = SDL_getenv("SDL_INPUT_REPLAY");
+	if ( file && *file ) {
+		flags = 0;
+		envr = SDL_getenv("SDL_INPUT_REPLAY_FAST");
+		if ( envr && SDL_atoi(envr) ) {
+			flags |= SDL_REPLAY_FAST;
+		}
+		SDL_StartInputReplay_RW(SDL_RWFromFile(file, "rb"), 1, flags);
+	}
+	file = SDL_getenv("SDL_INPUT_RECORD");
+	if ( file && *file ) {
+		SDL_StartInputRecording_RW(SDL_RWFromFile(file, "wb"), 1);
+	}
+}
+
+void SDL_InputRecordQuit(void)
+{
+	SDL_StopInputRecording();
+	SDL_StopInputReplay();
+}
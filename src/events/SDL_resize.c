@@ -40,6 +40,13 @@ int SDL_PrivateResize(int w, int h)
 	int posted;
 	SDL_Event events[32];
 
+	events[0].type = SDL_VIDEORESIZE;
+	events[0].resize.w = w;
+	events[0].resize.h = h;
+	if ( SDL_RecordInput(&events[0]) ) {
+		return(0);
+	}
+
 	/* See if this event would change the video surface */
 	if ( !w || !h ||
 	     (( last_resize.w == w ) && ( last_resize.h == h )) ||
@@ -62,7 +69,7 @@ int SDL_PrivateResize(int w, int h)
 		event.type = SDL_VIDEORESIZE;
 		event.resize.w = w;
 		event.resize.h = h;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
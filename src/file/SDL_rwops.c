@@ -27,6 +27,7 @@
 
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
+#include "SDL_rwops_c.h"
 
 
 #if defined(__WIN32__) && !defined(__SYMBIAN32__)
@@ -433,6 +434,27 @@ static int SDLCALL mem_close(SDL_RWops *context)
 	return(0);
 }
 
+Uint8 *SDL_RWmapMem(SDL_RWops *context, int maxsize, int *size)
+{
+	Uint8 *data;
+	int available;
+
+	if ( context->read != mem_read ) {
+		return(NULL);
+	}
+	data = context->hidden.mem.here;
+	available = (context->hidden.mem.stop - context->hidden.mem.here);
+	if ( maxsize > available ) {
+		maxsize = available;
+	}
+	if ( maxsize < 0 ) {
+		maxsize = 0;
+	}
+	context->hidden.mem.here += maxsize;
+	*size = maxsize;
+	return(data);
+}
+
 
 /* Functions to create SDL_RWops structures from various data sources */
 
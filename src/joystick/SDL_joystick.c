@@ -195,6 +195,21 @@ int SDL_JoystickOpened(int device_index)
 	return(opened);
 }
 
+SDL_Joystick *SDL_GetOpenedJoystick(int device_index)
+{
+	int i;
+
+	if ( SDL_joysticks == NULL ) {
+		return(NULL);
+	}
+	for ( i=0; SDL_joysticks[i]; ++i ) {
+		if ( SDL_joysticks[i]->index == (Uint8)device_index ) {
+			return(SDL_joysticks[i]);
+		}
+	}
+	return(NULL);
+}
+
 static int ValidJoystick(SDL_Joystick **joystick)
 {
 	int valid;
@@ -432,6 +447,17 @@ void SDL_JoystickQuit(void)
 int SDL_PrivateJoystickAxis(SDL_Joystick *joystick, Uint8 axis, Sint16 value)
 {
 	int posted;
+#if !SDL_EVENTS_DISABLED
+	SDL_Event input;
+
+	input.type = SDL_JOYAXISMOTION;
+	input.jaxis.which = joystick->index;
+	input.jaxis.axis = axis;
+	input.jaxis.value = value;
+	if ( SDL_RecordInput(&input) ) {
+		return(0);
+	}
+#endif /* !SDL_EVENTS_DISABLED */
 
 	/* Make sure we're not getting garbage events */
 	if (axis >= joystick->naxes) {
@@ -450,7 +476,7 @@ int SDL_PrivateJoystickAxis(SDL_Joystick *joystick, Uint8 axis, Sint16 value)
 		event.jaxis.which = joystick->index;
 		event.jaxis.axis = axis;
 		event.jaxis.value = value;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -462,6 +488,17 @@ int SDL_PrivateJoystickAxis(SDL_Joystick *joystick, Uint8 axis, Sint16 value)
 int SDL_PrivateJoystickHat(SDL_Joystick *joystick, Uint8 hat, Uint8 value)
 {
 	int posted;
+#if !SDL_EVENTS_DISABLED
+	SDL_Event input;
+
+	input.type = SDL_JOYHATMOTION;
+	input.jhat.which = joystick->index;
+	input.jhat.hat = hat;
+	input.jhat.value = value;
+	if ( SDL_RecordInput(&input) ) {
+		return(0);
+	}
+#endif /* !SDL_EVENTS_DISABLED */
 
 	/* Make sure we're not getting garbage events */
 	if (hat >= joystick->nhats) {
@@ -480,7 +517,7 @@ int SDL_PrivateJoystickHat(SDL_Joystick *joystick, Uint8 hat, Uint8 value)
 		event.jhat.which = joystick->index;
 		event.jhat.hat = hat;
 		event.jhat.value = value;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -493,6 +530,18 @@ int SDL_PrivateJoystickBall(SDL_Joystick *joystick, Uint8 ball,
 					Sint16 xrel, Sint16 yrel)
 {
 	int posted;
+#if !SDL_EVENTS_DISABLED
+	SDL_Event input;
+
+	input.type = SDL_JOYBALLMOTION;
+	input.jball.which = joystick->index;
+	input.jball.ball = ball;
+	input.jball.xrel = xrel;
+	input.jball.yrel = yrel;
+	if ( SDL_RecordInput(&input) ) {
+		return(0);
+	}
+#endif /* !SDL_EVENTS_DISABLED */
 
 	/* Make sure we're not getting garbage events */
 	if (ball >= joystick->nballs) {
@@ -513,7 +562,7 @@ int SDL_PrivateJoystickBall(SDL_Joystick *joystick, Uint8 ball,
 		event.jball.ball = ball;
 		event.jball.xrel = xrel;
 		event.jball.yrel = yrel;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -539,6 +588,12 @@ int SDL_PrivateJoystickButton(SDL_Joystick *joystick, Uint8 button, Uint8 state)
 			/* Invalid state -- bail */
 			return(0);
 	}
+	event.jbutton.which = joystick->index;
+	event.jbutton.button = button;
+	event.jbutton.state = state;
+	if ( SDL_RecordInput(&event) ) {
+		return(0);
+	}
 #endif /* !SDL_EVENTS_DISABLED */
 
 	/* Make sure we're not getting garbage events */
@@ -556,7 +611,7 @@ int SDL_PrivateJoystickButton(SDL_Joystick *joystick, Uint8 button, Uint8 state)
 		event.jbutton.which = joystick->index;
 		event.jbutton.button = button;
 		event.jbutton.state = state;
-		if ( (SDL_EventOK == NULL) || (*SDL_EventOK)(&event) ) {
+		if ( SDL_FilterEvent(&event) ) {
 			posted = 1;
 			SDL_PushEvent(&event);
 		}
@@ -27,6 +27,9 @@
 /* The number of available joysticks on the system */
 extern Uint8 SDL_numjoysticks;
 
+/* The opened joystick with the given device index, or NULL */
+extern SDL_Joystick *SDL_GetOpenedJoystick(int device_index);
+
 /* Internal event queueing functions */
 extern int SDL_PrivateJoystickAxis(SDL_Joystick *joystick,
                                    Uint8 axis, Sint16 value);
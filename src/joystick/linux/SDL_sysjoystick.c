@@ -29,6 +29,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/time.h>
 #include <limits.h>		/* For the definition of PATH_MAX */
 #include <linux/joystick.h>
 #if SDL_INPUT_LINUXEV
@@ -36,8 +37,10 @@
 #endif
 
 #include "SDL_joystick.h"
+#include "SDL_timer.h"
 #include "../SDL_sysjoystick.h"
 #include "../SDL_joystick_c.h"
+#include "../../events/SDL_events_c.h"
 
 /* Special joystick configurations */
 static struct {
@@ -1074,9 +1077,28 @@ static __inline__ int EV_AxisCorrect(SDL_Joystick *joystick, int which, int valu
 	return value;
 }
 
+/* Stamp the events queued for an input event with the time the kernel
+   read it, moved from the wall clock to SDL_GetTicksUS() time
+ */
+static void EV_SetEventTime(const struct input_event *event,
+				const struct timeval *now, Uint32 ticks)
+{
+	Sint32 age;
+
+	age = (now->tv_sec - event->time.tv_sec) * 1000000 +
+	      (now->tv_usec - event->time.tv_usec);
+	if ( (age < 0) || (age > 1000000) ) {
+		/* The wall clock was set, or the device uses another clock */
+		age = 0;
+	}
+	SDL_SetEventTimestamp(ticks - age);
+}
+
 static __inline__ void EV_HandleEvents(SDL_Joystick *joystick)
 {
 	struct input_event events[32];
+	struct timeval now;
+	Uint32 ticks;
 	int i, len;
 	int code;
 
@@ -1089,7 +1111,10 @@ static __inline__ void EV_HandleEvents(SDL_Joystick *joystick)
 
 	while ((len=read(joystick->hwdata->fd, events, (sizeof events))) > 0) {
 		len /= sizeof(events[0]);
+		ticks = SDL_GetTicksUS();
+		gettimeofday(&now, NULL);
 		for ( i=0; i<len; ++i ) {
+			EV_SetEventTime(&events[i], &now, ticks);
 			code = events[i].code;
 			switch (events[i].type) {
 			    case EV_KEY:
@@ -1149,6 +1174,7 @@ static __inline__ void EV_HandleEvents(SDL_Joystick *joystick)
 			}
 		}
 	}
+	SDL_ClearEventTimestamp();
 }
 #endif /* SDL_INPUT_LINUXEV */
 
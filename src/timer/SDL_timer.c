@@ -25,6 +25,9 @@
 #include "SDL_timer_c.h"
 #include "SDL_mutex.h"
 #include "SDL_systimer.h"
+#if !SDL_EVENTS_DISABLED
+#include "../events/SDL_events_c.h"
+#endif
 
 /* #define DEBUG_TIMERS */
 
@@ -50,6 +53,23 @@ static SDL_TimerID SDL_timers = NULL;
 static SDL_mutex *SDL_timer_mutex;
 static volatile SDL_bool list_changed = SDL_FALSE;
 
+#ifndef SDL_TIMER_UNIX
+Uint32 SDL_GetTicksUS(void)
+{
+	return SDL_GetTicks() * 1000;
+}
+
+int SDL_AdvanceTicks(Uint32 ms)
+{
+	SDL_Unsupported();
+	return(-1);
+}
+
+void SDL_SkipDelays(int skip)
+{
+}
+#endif
+
 /* Set whether or not the timer should use a thread.
    This should not be called while the timer subsystem is running.
 */
@@ -162,6 +182,30 @@ void SDL_ThreadedTimerCheck(void)
 	SDL_mutexV(SDL_timer_mutex);
 }
 
+Uint32 SDL_ThreadedTimerTimeout(void)
+{
+	Uint32 now, elapsed, due, timeout;
+	SDL_TimerID t;
+
+	timeout = 0xFFFFFFFF;
+	SDL_mutexP(SDL_timer_mutex);
+	now = SDL_GetTicks();
+	for ( t = SDL_timers; t; t = t->next ) {
+		/* SDL_ThreadedTimerCheck() runs it once this much has passed */
+		due = t->interval - SDL_TIMESLICE + 1;
+		elapsed = now - t->last_alarm;
+		if ( (int)elapsed >= (int)due ) {
+			timeout = 0;
+			break;
+		}
+		if ( due - elapsed < timeout ) {
+			timeout = due - elapsed;
+		}
+	}
+	SDL_mutexV(SDL_timer_mutex);
+	return timeout;
+}
+
 static SDL_TimerID SDL_AddTimerInternal(Uint32 interval, SDL_NewTimerCallback callback, void *param)
 {
 	SDL_TimerID t;
@@ -175,6 +219,11 @@ static SDL_TimerID SDL_AddTimerInternal(Uint32 interval, SDL_NewTimerCallback ca
 		SDL_timers = t;
 		++SDL_timer_running;
 		list_changed = SDL_TRUE;
+#if !SDL_EVENTS_DISABLED
+		if ( SDL_timer_threaded == 2 ) {
+			SDL_TimerChanged();
+		}
+#endif
 	}
 #ifdef DEBUG_TIMERS
 	printf("SDL_AddTimer(%d) = %08x num_timers = %d\n", interval, (Uint32)t, SDL_timer_running);
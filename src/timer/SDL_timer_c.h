@@ -42,5 +42,20 @@ extern int SDL_SetTimerThreaded(int value);
 extern int SDL_TimerInit(void);
 extern void SDL_TimerQuit(void);
 
+/* Move the SDL_GetTicks() clock 'ms' milliseconds ahead, to replay input
+   without waiting for it.  Returns -1 if the clock can't be moved.
+ */
+extern int SDL_AdvanceTicks(Uint32 ms);
+
+/* While set, SDL_Delay() called from the current thread moves the clock
+   ahead instead of sleeping
+ */
+extern void SDL_SkipDelays(int skip);
+
 /* This function is called from the SDL event thread if it is available */
 extern void SDL_ThreadedTimerCheck(void);
+
+/* Milliseconds until SDL_ThreadedTimerCheck() has a timer to run,
+   or 0xFFFFFFFF if there are no timers
+ */
+extern Uint32 SDL_ThreadedTimerTimeout(void);
@@ -31,6 +31,7 @@
 #include <errno.h>
 
 #include "SDL_timer.h"
+#include "SDL_thread.h"
 #include "../SDL_timer_c.h"
 
 /* The clock_gettime provides monotonous time, so we should use it if
@@ -57,6 +58,13 @@ static struct timespec start;
 static struct timeval start;
 #endif /* HAVE_CLOCK_GETTIME */
 
+/* Milliseconds the clock was moved ahead by SDL_AdvanceTicks() */
+static Uint32 skipped;
+
+/* The thread whose SDL_Delay() calls move the clock instead of sleeping */
+static Uint32 skip_thread;
+static int skip_delays;
+
 
 void SDL_StartTicks(void)
 {
@@ -66,6 +74,7 @@ void SDL_StartTicks(void)
 #else
 	gettimeofday(&start, NULL);
 #endif
+	skipped = 0;
 }
 
 Uint32 SDL_GetTicks (void)
@@ -75,20 +84,50 @@ Uint32 SDL_GetTicks (void)
 	struct timespec now;
 	clock_gettime(CLOCK_MONOTONIC,&now);
 	ticks=(now.tv_sec-start.tv_sec)*1000+(now.tv_nsec-start.tv_nsec)/1000000;
-	return(ticks);
+	return(ticks+skipped);
 #else
 	Uint32 ticks;
 	struct timeval now;
 	gettimeofday(&now, NULL);
 	ticks=(now.tv_sec-start.tv_sec)*1000+(now.tv_usec-start.tv_usec)/1000;
-	return(ticks);
+	return(ticks+skipped);
+#endif
+}
+
+Uint32 SDL_GetTicksUS (void)
+{
+#if HAVE_CLOCK_GETTIME
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (now.tv_sec-start.tv_sec)*1000000+(now.tv_nsec-start.tv_nsec)/1000+skipped*1000;
+#else
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (now.tv_sec-start.tv_sec)*1000000+(now.tv_usec-start.tv_usec)+skipped*1000;
 #endif
 }
 
+int SDL_AdvanceTicks (Uint32 ms)
+{
+	skipped += ms;
+	return(0);
+}
+
+void SDL_SkipDelays (int skip)
+{
+	skip_thread = SDL_ThreadID();
+	skip_delays = skip;
+}
+
 void SDL_Delay (Uint32 ms)
 {
 #if SDL_THREAD_PTH
 	pth_time_t tv;
+
+	if ( skip_delays && (SDL_ThreadID() == skip_thread) ) {
+		skipped += ms;
+		return;
+	}
 	tv.tv_sec  =  ms/1000;
 	tv.tv_usec = (ms%1000)*1000;
 	pth_nap(tv);
@@ -102,6 +141,12 @@ void SDL_Delay (Uint32 ms)
 	Uint32 then, now, elapsed;
 #endif
 
+	/* Replays skip the time the application would sleep */
+	if ( skip_delays && (SDL_ThreadID() == skip_thread) ) {
+		skipped += ms;
+		return;
+	}
+
 	/* Set the timeout interval */
 #if HAVE_NANOSLEEP
 	elapsed.tv_sec = ms/1000;
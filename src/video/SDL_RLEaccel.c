@@ -90,6 +90,7 @@
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_RLEaccel_c.h"
+#include "SDL_pixels_c.h"
 
 /* Force MMX to 0; this blows up on almost every major compiler now. --ryan. */
 #if 0 && defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && SDL_ASSEMBLY_ROUTINES
@@ -1605,6 +1606,7 @@ static int RLEAlphaSurface(SDL_Surface *surface)
 	if(!p)
 	    p = rlebuf;
 	surface->map->sw_data->aux_data = p;
+	surface->map->sw_data->aux_size = (int)(dst - rlebuf);
     }
 
     return 0;
@@ -1763,6 +1765,7 @@ static int RLEColorkeySurface(SDL_Surface *surface)
 	    if(!p)
 		p = rlebuf;
 	    surface->map->sw_data->aux_data = p;
+	    surface->map->sw_data->aux_size = (int)(dst - rlebuf);
 	}
 
 	return(0);
@@ -1814,6 +1817,160 @@ int SDL_RLESurface(SDL_Surface *surface)
 	return(0);
 }
 
+/*
+ * Walk the <skip> <run> pairs of one scan line of RLE data, checking that
+ * the segments stay inside the line and the data.  Returns the offset of
+ * the next line, 0 at the end of the sequence, or -1 if the data is bad.
+ */
+static int RLECheckLine(const Uint8 *data, int size, int pos, int w,
+                        int countsize, int pixelsize, int first)
+{
+	int ofs = 0;
+	int skip, run;
+
+	do {
+		if ( size - pos < 2 * countsize ) {
+			return(-1);
+		}
+		if ( countsize == 2 ) {
+			skip = ((const Uint16 *)(data + pos))[0];
+			run = ((const Uint16 *)(data + pos))[1];
+		} else {
+			skip = data[pos];
+			run = data[pos + 1];
+		}
+		pos += 2 * countsize;
+		if ( skip == 0 && run == 0 ) {
+			/* Only the end of the sequence starts with a zero pair */
+			return((first && ofs == 0) ? 0 : -1);
+		}
+		ofs += skip;
+		if ( ofs + run > w || (size - pos) / pixelsize < run ) {
+			return(-1);
+		}
+		pos += run * pixelsize;
+		ofs += run;
+	} while ( ofs < w );
+	return(pos);
+}
+
+/*
+ * Check RLE data that was encoded earlier, such as data loaded from a
+ * surface cache, before it is given to SDL_RLESurfaceFrom().  The data
+ * must be in the encoding SDL_RLESurface() would use for the surface, and
+ * its segments must stay inside both the data and the surface.
+ */
+int SDL_RLECheckData(SDL_Surface *surface, const void *data, int size)
+{
+	const Uint8 *buf = (const Uint8 *)data;
+	int w = surface->w;
+	int h = surface->h;
+	int bpp, pos, y;
+
+	if ( w <= 0 || size <= 0 || ((uintptr_t)buf & 3) ) {
+		return(-1);
+	}
+	if ( (surface->flags & SDL_SRCCOLORKEY) == SDL_SRCCOLORKEY ) {
+		bpp = surface->format->BytesPerPixel;
+		pos = 0;
+		for ( y = 0; y <= h; ++y ) {
+			pos = RLECheckLine(buf, size, pos, w,
+			                   (bpp == 4) ? 2 : 1, bpp, 1);
+			if ( pos <= 0 ) {
+				return(pos);
+			}
+		}
+		return(-1);
+	}
+
+	/* Per-pixel alpha data starts with the format it was encoded for */
+	if ( (surface->flags & SDL_SRCALPHA) != SDL_SRCALPHA ||
+	     surface->format->Amask == 0 ||
+	     surface->format->BitsPerPixel != 32 ||
+	     size < (int)sizeof(RLEDestFormat) ) {
+		return(-1);
+	}
+	bpp = ((const RLEDestFormat *)buf)->BytesPerPixel;
+	if ( bpp != 2 && bpp != 4 ) {
+		return(-1);
+	}
+	pos = sizeof(RLEDestFormat);
+	for ( y = 0; y <= h; ++y ) {
+		/* The opaque pixels, then the translucent ones */
+		pos = RLECheckLine(buf, size, pos, w, bpp / 2, bpp, 1);
+		if ( pos <= 0 || y == h ) {
+			return(pos ? -1 : 0);
+		}
+		if ( bpp == 2 ) {
+			pos += pos & 2;
+		}
+		pos = RLECheckLine(buf, size, pos, w, 2, 4, 0);
+		if ( pos < 0 ) {
+			return(-1);
+		}
+	}
+	return(-1);
+}
+
+/*
+ * Use RLE data that was encoded earlier for the same surface, such as
+ * data loaded from a surface cache, instead of encoding the surface.
+ * The surface must already be mapped to its destination without RLE.
+ * If the mapping can't use the data, any missing pixels are decoded
+ * from it, it is freed, and -1 is returned.
+ */
+int SDL_RLESurfaceFrom(SDL_Surface *surface, void *data, int size)
+{
+	SDL_BlitMap *map = surface->map;
+	SDL_blit rleblit = NULL;
+	int blit_index;
+
+	/* Check that the mapping would pick the same kind of RLE blit */
+	blit_index = 0;
+	blit_index |= (!!(surface->flags & SDL_SRCCOLORKEY))      << 0;
+	if ( surface->flags & SDL_SRCALPHA
+	     && (surface->format->alpha != SDL_ALPHA_OPAQUE
+		 || surface->format->Amask) ) {
+	        blit_index |= 2;
+	}
+	if ( map->dst && (surface->flags & SDL_RLEACCELOK)
+	     && (surface->flags & SDL_HWACCEL) != SDL_HWACCEL ) {
+		if ( map->identity
+		     && (blit_index == 1
+			 || (blit_index == 3 && !surface->format->Amask)) ) {
+			rleblit = SDL_RLEBlit;
+		} else if ( blit_index == 2 && surface->format->Amask ) {
+			RLEDestFormat *r = (RLEDestFormat *)data;
+			SDL_PixelFormat *df = map->dst->format;
+
+			if ( r->BytesPerPixel == df->BytesPerPixel
+			     && r->Rmask == df->Rmask
+			     && r->Gmask == df->Gmask
+			     && r->Bmask == df->Bmask ) {
+				rleblit = SDL_RLEAlphaBlit;
+			}
+		}
+	}
+
+	map->sw_data->aux_data = data;
+	map->sw_data->aux_size = size;
+	surface->flags |= SDL_RLEACCEL;
+	if ( rleblit == NULL ) {
+		SDL_UnRLESurface(surface, (surface->pixels == NULL));
+		SDL_InvalidateMap(map);
+		return(-1);
+	}
+	map->sw_blit = rleblit;
+
+	/* Release the original pixels, as if we had encoded them */
+	if((surface->flags & SDL_PREALLOC) != SDL_PREALLOC
+	   && (surface->flags & SDL_HWSURFACE) != SDL_HWSURFACE) {
+	    SDL_free( surface->pixels );
+	    surface->pixels = NULL;
+	}
+	return(0);
+}
+
 /*
  * Un-RLE a surface with pixel alpha
  * This may not give back exactly the image before RLE-encoding; all
@@ -1934,6 +2091,7 @@ void SDL_UnRLESurface(SDL_Surface *surface, int recode)
 	if ( surface->map && surface->map->sw_data->aux_data ) {
 	    SDL_free(surface->map->sw_data->aux_data);
 	    surface->map->sw_data->aux_data = NULL;
+	    surface->map->sw_data->aux_size = 0;
 	}
     }
 }
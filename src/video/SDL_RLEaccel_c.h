@@ -24,6 +24,8 @@
 /* Useful functions and variables from SDL_RLEaccel.c */
 
 extern int SDL_RLESurface(SDL_Surface *surface);
+extern int SDL_RLESurfaceFrom(SDL_Surface *surface, void *data, int size);
+extern int SDL_RLECheckData(SDL_Surface *surface, const void *data, int size);
 extern int SDL_RLEBlit(SDL_Surface *src, SDL_Rect *srcrect,
                        SDL_Surface *dst, SDL_Rect *dstrect);
 extern int SDL_RLEAlphaBlit(SDL_Surface *src, SDL_Rect *srcrect,
@@ -40,8 +40,8 @@
 #endif
 
 /* The general purpose software blit routine */
-static int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
-			SDL_Surface *dst, SDL_Rect *dstrect)
+int SDL_SoftBlit32(SDL_Surface *src, SDL_Rect32 *srcrect,
+			SDL_Surface *dst, SDL_Rect32 *dstrect)
 {
 	int okay;
 	int src_locked;
@@ -73,20 +73,22 @@ static int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
 	if ( okay  && srcrect->w && srcrect->h ) {
 		SDL_BlitInfo info;
 		SDL_loblit RunBlit;
+		Uint32 srcpitch = SDL_SurfacePitch(src);
+		Uint32 dstpitch = SDL_SurfacePitch(dst);
 
 		/* Set up the blit information */
 		info.s_pixels = (Uint8 *)src->pixels +
-				(Uint16)srcrect->y*src->pitch +
-				(Uint16)srcrect->x*src->format->BytesPerPixel;
+				(size_t)srcrect->y*srcpitch +
+				(size_t)srcrect->x*src->format->BytesPerPixel;
 		info.s_width = srcrect->w;
 		info.s_height = srcrect->h;
-		info.s_skip=src->pitch-info.s_width*src->format->BytesPerPixel;
+		info.s_skip=srcpitch-info.s_width*src->format->BytesPerPixel;
 		info.d_pixels = (Uint8 *)dst->pixels +
-				(Uint16)dstrect->y*dst->pitch +
-				(Uint16)dstrect->x*dst->format->BytesPerPixel;
+				(size_t)dstrect->y*dstpitch +
+				(size_t)dstrect->x*dst->format->BytesPerPixel;
 		info.d_width = dstrect->w;
 		info.d_height = dstrect->h;
-		info.d_skip=dst->pitch-info.d_width*dst->format->BytesPerPixel;
+		info.d_skip=dstpitch-info.d_width*dst->format->BytesPerPixel;
 		info.aux_data = src->map->sw_data->aux_data;
 		info.src = src->format;
 		info.table = src->map->table;
@@ -107,6 +109,30 @@ static int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
 	/* Blit is done! */
 	return(okay ? 0 : -1);
 }
+int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
+			SDL_Surface *dst, SDL_Rect *dstrect)
+{
+	SDL_Rect32 sr, dr;
+
+	sr.x = (Uint16)srcrect->x;
+	sr.y = (Uint16)srcrect->y;
+	sr.w = srcrect->w;
+	sr.h = srcrect->h;
+	dr.x = (Uint16)dstrect->x;
+	dr.y = (Uint16)dstrect->y;
+	dr.w = dstrect->w;
+	dr.h = dstrect->h;
+	return SDL_SoftBlit32(src, &sr, dst, &dr);
+}
+
+/* The RLE blitters take SDL_Rect, so only use them for surfaces that
+   it can address.
+ */
+static int SDL_RLEFits(SDL_Surface *surface)
+{
+	return (surface->w <= 32767 && surface->h <= 32767 &&
+	        surface->unused1 == 0);
+}
 
 #ifdef MMX_ASMBLIT
 static __inline__ void SDL_memcpyMMX(Uint8 *to, const Uint8 *from, int len)
@@ -339,7 +365,8 @@ int SDL_CalculateBlit(SDL_Surface *surface)
 
 	/* Choose software blitting function */
 	if(surface->flags & SDL_RLEACCELOK
-	   && (surface->flags & SDL_HWACCEL) != SDL_HWACCEL) {
+	   && (surface->flags & SDL_HWACCEL) != SDL_HWACCEL
+	   && SDL_RLEFits(surface) && SDL_RLEFits(surface->map->dst)) {
 
 	        if(surface->map->identity
 		   && (blit_index == 1
@@ -49,6 +49,7 @@ typedef void (*SDL_loblit)(SDL_BlitInfo *info);
 struct private_swaccel {
 	SDL_loblit blit;
 	void *aux_data;
+	int aux_size;		/* The size of aux_data, if it's RLE data */
 };
 
 /* Blit mapping definition */
@@ -64,11 +65,19 @@ typedef struct SDL_BlitMap {
 	/* the version count matches the destination; mismatch indicates
 	   an invalid mapping */
         unsigned int format_version;
+
+	/* the clip rectangle of the surface this map belongs to, which
+	   surface->clip_rect holds clamped to 16 bits */
+	SDL_Rect32 clip_rect;
 } SDL_BlitMap;
 
 
 /* Functions found in SDL_blit.c */
 extern int SDL_CalculateBlit(SDL_Surface *surface);
+extern int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
+			SDL_Surface *dst, SDL_Rect *dstrect);
+extern int SDL_SoftBlit32(SDL_Surface *src, SDL_Rect32 *srcrect,
+			SDL_Surface *dst, SDL_Rect32 *dstrect);
 
 /* Functions found in SDL_blit_{0,1,N,A}.c */
 extern SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int complex);
@@ -23,6 +23,13 @@
 
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "SDL_cpuinfo.h"
+
+/* SSE2 bitmap expansion for x86-64 */
+#if defined(__GNUC__) && defined(__x86_64__) && SDL_ASSEMBLY_ROUTINES
+#define SDL_BLIT0_SSE2	1
+#include <emmintrin.h>
+#endif
 
 /* Functions to blit from bitmaps to other surfaces */
 
@@ -367,8 +374,8 @@ static void BlitBtoNAlpha(SDL_BlitInfo *info)
 			bit = (byte&0x80)>>7;
 			if ( 1 ) {
 			        Uint32 pixel;
-			        unsigned sR, sG, sB;
-				unsigned dR, dG, dB;
+			        int sR, sG, sB;
+				int dR, dG, dB;
 				sR = srcpal[bit].r;
 				sG = srcpal[bit].g;
 				sB = srcpal[bit].b;
@@ -432,6 +439,420 @@ static void BlitBtoNAlphaKey(SDL_BlitInfo *info)
 	}
 }
 
+#if SDL_BLIT0_SSE2
+/* The SSE2 blitters below handle 8 pixels for each source byte.  They
+   take the byte's 8 pixel masks from this table, blend the two colors
+   through them, and widen them to the destination pixel size.  The C
+   blitters above do the pixels left over at the right of each row.
+ */
+#define BITMAP_MASK(b)	{						\
+	((b)&0x80)?0xFF:0, ((b)&0x40)?0xFF:0, ((b)&0x20)?0xFF:0,	\
+	((b)&0x10)?0xFF:0, ((b)&0x08)?0xFF:0, ((b)&0x04)?0xFF:0,	\
+	((b)&0x02)?0xFF:0, ((b)&0x01)?0xFF:0 }
+#define BITMAP_MASK4(b)	BITMAP_MASK(b), BITMAP_MASK((b)+1),		\
+			BITMAP_MASK((b)+2), BITMAP_MASK((b)+3)
+#define BITMAP_MASK16(b) BITMAP_MASK4(b), BITMAP_MASK4((b)+4),		\
+			BITMAP_MASK4((b)+8), BITMAP_MASK4((b)+12)
+#define BITMAP_MASK64(b) BITMAP_MASK16(b), BITMAP_MASK16((b)+16),	\
+			BITMAP_MASK16((b)+32), BITMAP_MASK16((b)+48)
+
+static const Uint8 bitmap_masks[256][8] = {
+	BITMAP_MASK64(0), BITMAP_MASK64(64),
+	BITMAP_MASK64(128), BITMAP_MASK64(192)
+};
+
+#define BITMAP_MASK8(byte) \
+	_mm_loadl_epi64((const __m128i *)bitmap_masks[byte])
+
+/* Blit the pixels left over at the right of the rows with a C blitter */
+static void BlitBitmapTail(SDL_BlitInfo *info, int bpp, SDL_loblit blit)
+{
+	SDL_BlitInfo tail;
+	int body = (info->d_width & ~7);
+
+	if ( info->d_width == body ) {
+		return;
+	}
+	tail = *info;
+	tail.s_pixels += body/8;
+	tail.s_skip += body;
+	tail.d_pixels += body*bpp;
+	tail.d_skip += body*bpp;
+	tail.d_width -= body;
+	blit(&tail);
+}
+
+/* Select the pixels of a keyed blit that get drawn.  The key is the
+   value of the bits that are skipped, so any other value draws them all.
+ */
+static __inline__ __m128i BitmapKeyMask(__m128i mask, Uint32 ckey)
+{
+	if ( ckey == 0 ) {
+		return mask;
+	}
+	if ( ckey == 1 ) {
+		return _mm_xor_si128(mask, _mm_set1_epi32(-1));
+	}
+	return _mm_set1_epi32(-1);
+}
+
+static void BlitBto1SSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7);
+	Uint8 *map = info->table;
+	__m128i bg, diff;
+	int c;
+
+	bg = _mm_set1_epi8(map ? map[0] : 0);
+	diff = _mm_xor_si128(bg, _mm_set1_epi8(map ? map[1] : 1));
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BITMAP_MASK8(*src++);
+			_mm_storel_epi64((__m128i *)dst,
+				_mm_xor_si128(bg, _mm_and_si128(mask, diff)));
+			dst += 8;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 1, BlitBto1);
+}
+static void BlitBto2SSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7)*2;
+	Uint16 *map = (Uint16 *)info->table;
+	__m128i bg, diff;
+	int c;
+
+	bg = _mm_set1_epi16(map[0]);
+	diff = _mm_xor_si128(bg, _mm_set1_epi16(map[1]));
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BITMAP_MASK8(*src++);
+			mask = _mm_unpacklo_epi8(mask, mask);
+			_mm_storeu_si128((__m128i *)dst,
+				_mm_xor_si128(bg, _mm_and_si128(mask, diff)));
+			dst += 16;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 2, BlitBto2);
+}
+static void BlitBto4SSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7)*4;
+	Uint32 *map = (Uint32 *)info->table;
+	__m128i bg, diff;
+	int c;
+
+	bg = _mm_set1_epi32(map[0]);
+	diff = _mm_xor_si128(bg, _mm_set1_epi32(map[1]));
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BITMAP_MASK8(*src++);
+			mask = _mm_unpacklo_epi8(mask, mask);
+			_mm_storeu_si128((__m128i *)dst, _mm_xor_si128(bg,
+				_mm_and_si128(_mm_unpacklo_epi16(mask, mask), diff)));
+			_mm_storeu_si128((__m128i *)(dst+16), _mm_xor_si128(bg,
+				_mm_and_si128(_mm_unpackhi_epi16(mask, mask), diff)));
+			dst += 32;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 4, BlitBto4);
+}
+
+/* The keyed blitters only ever draw one of the two colors, so they
+   select between it and the destination.
+ */
+static void BlitBto1KeySSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7);
+	Uint8 *map = info->table;
+	Uint32 ckey = info->src->colorkey;
+	__m128i color;
+	int c;
+
+	if ( ckey > 1 ) {
+		BlitBto1SSE2(info);
+		return;
+	}
+	color = _mm_set1_epi8(map ? map[!ckey] : !ckey);
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BitmapKeyMask(BITMAP_MASK8(*src++), ckey);
+			__m128i d = _mm_loadl_epi64((__m128i *)dst);
+			_mm_storel_epi64((__m128i *)dst,
+				_mm_or_si128(_mm_and_si128(mask, color),
+				             _mm_andnot_si128(mask, d)));
+			dst += 8;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 1, BlitBto1Key);
+}
+static void BlitBto2KeySSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7)*2;
+	Uint16 *map = (Uint16 *)info->table;
+	Uint32 ckey = info->src->colorkey;
+	__m128i color;
+	int c;
+
+	if ( ckey > 1 ) {
+		BlitBto2SSE2(info);
+		return;
+	}
+	color = _mm_set1_epi16(map[!ckey]);
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BitmapKeyMask(BITMAP_MASK8(*src++), ckey);
+			__m128i d = _mm_loadu_si128((__m128i *)dst);
+			mask = _mm_unpacklo_epi8(mask, mask);
+			_mm_storeu_si128((__m128i *)dst,
+				_mm_or_si128(_mm_and_si128(mask, color),
+				             _mm_andnot_si128(mask, d)));
+			dst += 16;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 2, BlitBto2Key);
+}
+static void BlitBto4KeySSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7)*4;
+	Uint32 *map = (Uint32 *)info->table;
+	Uint32 ckey = info->src->colorkey;
+	__m128i color;
+	int c;
+
+	if ( ckey > 1 ) {
+		BlitBto4SSE2(info);
+		return;
+	}
+	color = _mm_set1_epi32(map[!ckey]);
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BitmapKeyMask(BITMAP_MASK8(*src++), ckey);
+			__m128i lo, hi, d;
+			mask = _mm_unpacklo_epi8(mask, mask);
+			lo = _mm_unpacklo_epi16(mask, mask);
+			hi = _mm_unpackhi_epi16(mask, mask);
+			d = _mm_loadu_si128((__m128i *)dst);
+			_mm_storeu_si128((__m128i *)dst,
+				_mm_or_si128(_mm_and_si128(lo, color),
+				             _mm_andnot_si128(lo, d)));
+			d = _mm_loadu_si128((__m128i *)(dst+16));
+			_mm_storeu_si128((__m128i *)(dst+16),
+				_mm_or_si128(_mm_and_si128(hi, color),
+				             _mm_andnot_si128(hi, d)));
+			dst += 32;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 4, BlitBto4Key);
+}
+
+/* ALPHA_BLEND() on 4 pixels with 8-bit channels.  With x = s*A and
+   y = d*(256-A) it computes (x + y + 255) >> 8, which is the same value,
+   without overflowing 16 bits.
+ */
+static __inline__ __m128i BitmapBlend(__m128i s, __m128i d,
+                                      __m128i alpha, __m128i alpha_inv)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi16(0xFF);
+	__m128i x, y, lo, hi;
+
+	x = _mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), alpha);
+	y = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), alpha_inv);
+	lo = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(x, low),
+	                                 _mm_and_si128(y, low)), low);
+	lo = _mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(x, 8),
+	                                 _mm_srli_epi16(y, 8)),
+	                   _mm_srli_epi16(lo, 8));
+	x = _mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), alpha);
+	y = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), alpha_inv);
+	hi = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(x, low),
+	                                 _mm_and_si128(y, low)), low);
+	hi = _mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(x, 8),
+	                                 _mm_srli_epi16(y, 8)),
+	                   _mm_srli_epi16(hi, 8));
+	return _mm_packus_epi16(lo, hi);
+}
+
+/* Palette color in a 32-bit destination pixel, as ASSEMBLE_RGB() makes it */
+static Uint32 BitmapColor(SDL_PixelFormat *fmt, const SDL_Color *color)
+{
+	return ((Uint32)color->r << fmt->Rshift) |
+	       ((Uint32)color->g << fmt->Gshift) |
+	       ((Uint32)color->b << fmt->Bshift);
+}
+
+static void BlitBto4AlphaSSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7)*4;
+	SDL_PixelFormat *dstfmt = info->dst;
+	const SDL_Color *srcpal	= info->src->palette->colors;
+	const int A = info->src->alpha;
+	__m128i bg, diff, alpha, alpha_inv, rgbmask;
+	int c;
+
+	bg = _mm_set1_epi32(BitmapColor(dstfmt, &srcpal[0]));
+	diff = _mm_xor_si128(bg, _mm_set1_epi32(BitmapColor(dstfmt, &srcpal[1])));
+	alpha = _mm_set1_epi16(A);
+	alpha_inv = _mm_set1_epi16(256 - A);
+	rgbmask = _mm_set1_epi32(dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask);
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BITMAP_MASK8(*src++);
+			__m128i s, d;
+			mask = _mm_unpacklo_epi8(mask, mask);
+			s = _mm_xor_si128(bg, _mm_and_si128(
+				_mm_unpacklo_epi16(mask, mask), diff));
+			d = _mm_loadu_si128((__m128i *)dst);
+			_mm_storeu_si128((__m128i *)dst, _mm_and_si128(rgbmask,
+				BitmapBlend(s, d, alpha, alpha_inv)));
+			s = _mm_xor_si128(bg, _mm_and_si128(
+				_mm_unpackhi_epi16(mask, mask), diff));
+			d = _mm_loadu_si128((__m128i *)(dst+16));
+			_mm_storeu_si128((__m128i *)(dst+16), _mm_and_si128(rgbmask,
+				BitmapBlend(s, d, alpha, alpha_inv)));
+			dst += 32;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 4, BlitBtoNAlpha);
+}
+static void BlitBto4AlphaKeySSE2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	Uint8 *dst = info->d_pixels;
+	int srcskip = info->s_skip + width - width/8;
+	int dstskip = info->d_skip + (width & 7)*4;
+	SDL_PixelFormat *dstfmt = info->dst;
+	const SDL_Color *srcpal	= info->src->palette->colors;
+	const int A = info->src->alpha;
+	Uint32 ckey = info->src->colorkey;
+	__m128i color, alpha, alpha_inv, rgbmask;
+	int c;
+
+	if ( ckey > 1 ) {
+		BlitBto4AlphaSSE2(info);
+		return;
+	}
+	color = _mm_set1_epi32(BitmapColor(dstfmt, &srcpal[!ckey]));
+	alpha = _mm_set1_epi16(A);
+	alpha_inv = _mm_set1_epi16(256 - A);
+	rgbmask = _mm_set1_epi32(dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask);
+	while ( height-- ) {
+		for ( c = width/8; c; --c ) {
+			__m128i mask = BitmapKeyMask(BITMAP_MASK8(*src++), ckey);
+			__m128i lo, hi, d;
+			mask = _mm_unpacklo_epi8(mask, mask);
+			lo = _mm_unpacklo_epi16(mask, mask);
+			hi = _mm_unpackhi_epi16(mask, mask);
+			d = _mm_loadu_si128((__m128i *)dst);
+			_mm_storeu_si128((__m128i *)dst, _mm_or_si128(
+				_mm_and_si128(lo, _mm_and_si128(rgbmask,
+					BitmapBlend(color, d, alpha, alpha_inv))),
+				_mm_andnot_si128(lo, d)));
+			d = _mm_loadu_si128((__m128i *)(dst+16));
+			_mm_storeu_si128((__m128i *)(dst+16), _mm_or_si128(
+				_mm_and_si128(hi, _mm_and_si128(rgbmask,
+					BitmapBlend(color, d, alpha, alpha_inv))),
+				_mm_andnot_si128(hi, d)));
+			dst += 32;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+	BlitBitmapTail(info, 4, BlitBtoNAlphaKey);
+}
+
+static SDL_loblit CalculateBlit0SSE2(SDL_Surface *surface, int blit_index,
+                                     int which)
+{
+	SDL_PixelFormat *dstfmt = surface->map->dst->format;
+	int readsdst = (blit_index != 0);
+
+	/* Reading video memory is slow, leave those to the C blitters */
+	if ( readsdst && (surface->map->dst->flags & SDL_HWSURFACE) ) {
+		return NULL;
+	}
+	switch (blit_index) {
+	case 0:
+	    switch (which) {
+		case 1: return BlitBto1SSE2;
+		case 2: return BlitBto2SSE2;
+		case 4: return BlitBto4SSE2;
+	    }
+	    break;
+	case 1:
+	    switch (which) {
+		case 1: return BlitBto1KeySSE2;
+		case 2: return BlitBto2KeySSE2;
+		case 4: return BlitBto4KeySSE2;
+	    }
+	    break;
+	case 2:
+	case 3:
+	    /* 8 bits per channel on byte boundaries */
+	    if ( which == 4 &&
+	         dstfmt->Rloss == 0 && dstfmt->Gloss == 0 && dstfmt->Bloss == 0 &&
+	         (dstfmt->Rshift % 8) == 0 && (dstfmt->Gshift % 8) == 0 &&
+	         (dstfmt->Bshift % 8) == 0 ) {
+		return (blit_index == 2) ? BlitBto4AlphaSSE2 : BlitBto4AlphaKeySSE2;
+	    }
+	    break;
+	}
+	return NULL;
+}
+#endif /* SDL_BLIT0_SSE2 */
+
 static SDL_loblit bitmap_blit[] = {
 	NULL, BlitBto1, BlitBto2, BlitBto3, BlitBto4
 };
@@ -453,6 +874,14 @@ SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int blit_index)
 	} else {
 		which = surface->map->dst->format->BytesPerPixel;
 	}
+#if SDL_BLIT0_SSE2
+	if ( SDL_HasSSE2() ) {
+		SDL_loblit blit = CalculateBlit0SSE2(surface, blit_index, which);
+		if ( blit ) {
+			return blit;
+		}
+	}
+#endif
 	switch(blit_index) {
 	case 0:			/* copy */
 	    return bitmap_blit[which];
@@ -463,7 +892,7 @@ SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int blit_index)
 	case 2:			/* alpha */
 	    return which >= 2 ? BlitBtoNAlpha : NULL;
 
-	case 4:			/* alpha + colorkey */
+	case 3:			/* alpha + colorkey */
 	    return which >= 2 ? BlitBtoNAlphaKey : NULL;
 	}
 	return NULL;
@@ -25,6 +25,15 @@
 #include "SDL_blit.h"
 #include "SDL_sysvideo.h"
 #include "SDL_endian.h"
+#include "SDL_cpuinfo.h"
+
+/* AVX2 palette expansion for x86-64 */
+#if defined(__GNUC__) && defined(__x86_64__) && SDL_ASSEMBLY_ROUTINES && \
+    ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)) || defined(__clang__))
+#define SDL_BLIT1_AVX2	1
+#include <immintrin.h>
+#define BLIT1_AVX2	__attribute__((target("avx2")))
+#endif
 
 /* Functions to blit from 8-bit surfaces to other surfaces */
 
@@ -403,6 +412,161 @@ static void Blit1to4Key(SDL_BlitInfo *info)
 	}
 }
 
+#if SDL_BLIT1_AVX2
+/* These look up 8 pixels at a time with a gather, which is about twice
+   as fast as the C loops above on large blits.  The 16-bit versions read
+   32 bits per entry, so Map1toN() leaves room at the end of the table.
+ */
+static void BLIT1_AVX2 Blit1to2AVX2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint16 *dst = (Uint16 *)info->d_pixels;
+	int dstskip = info->d_skip/2;
+	Uint16 *map = (Uint16 *)info->table;
+	const __m256i lo = _mm256_set1_epi32(0xFFFF);
+
+	while ( height-- ) {
+		int c;
+		for ( c = width; c >= 16; c -= 16 ) {
+			__m128i index = _mm_loadu_si128((__m128i *)src);
+			__m256i a, b;
+
+			a = _mm256_i32gather_epi32((int *)map,
+				_mm256_cvtepu8_epi32(index), 2);
+			b = _mm256_i32gather_epi32((int *)map,
+				_mm256_cvtepu8_epi32(_mm_srli_si128(index, 8)), 2);
+			a = _mm256_packus_epi32(_mm256_and_si256(a, lo),
+			                        _mm256_and_si256(b, lo));
+			_mm256_storeu_si256((__m256i *)dst,
+				_mm256_permute4x64_epi64(a, 0xD8));
+			src += 16;
+			dst += 16;
+		}
+		while ( c-- ) {
+			*dst++ = map[*src++];
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+static void BLIT1_AVX2 Blit1to4AVX2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint32 *dst = (Uint32 *)info->d_pixels;
+	int dstskip = info->d_skip/4;
+	Uint32 *map = (Uint32 *)info->table;
+
+	while ( height-- ) {
+		int c;
+		for ( c = width; c >= 8; c -= 8 ) {
+			__m256i index = _mm256_cvtepu8_epi32(
+				_mm_loadl_epi64((__m128i *)src));
+			_mm256_storeu_si256((__m256i *)dst,
+				_mm256_i32gather_epi32((int *)map, index, 4));
+			src += 8;
+			dst += 8;
+		}
+		while ( c-- ) {
+			*dst++ = map[*src++];
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+/* This one reads the destination to blend in the keyed pixels, so it
+   is only used for software surfaces.
+ */
+static void BLIT1_AVX2 Blit1to2KeyAVX2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint16 *dst = (Uint16 *)info->d_pixels;
+	int dstskip = info->d_skip/2;
+	Uint16 *map = (Uint16 *)info->table;
+	Uint32 ckey = info->src->colorkey;
+	const __m256i lo = _mm256_set1_epi32(0xFFFF);
+	const __m256i key = _mm256_set1_epi16((ckey < 256) ? (short)ckey : -1);
+
+	while ( height-- ) {
+		int c;
+		for ( c = width; c >= 16; c -= 16 ) {
+			__m128i index = _mm_loadu_si128((__m128i *)src);
+			__m256i a, b, keyed;
+
+			a = _mm256_i32gather_epi32((int *)map,
+				_mm256_cvtepu8_epi32(index), 2);
+			b = _mm256_i32gather_epi32((int *)map,
+				_mm256_cvtepu8_epi32(_mm_srli_si128(index, 8)), 2);
+			a = _mm256_packus_epi32(_mm256_and_si256(a, lo),
+			                        _mm256_and_si256(b, lo));
+			a = _mm256_permute4x64_epi64(a, 0xD8);
+			keyed = _mm256_cmpeq_epi16(_mm256_cvtepu8_epi16(index), key);
+			a = _mm256_blendv_epi8(a,
+				_mm256_loadu_si256((__m256i *)dst), keyed);
+			_mm256_storeu_si256((__m256i *)dst, a);
+			src += 16;
+			dst += 16;
+		}
+		while ( c-- ) {
+			if ( *src != ckey ) {
+				*dst = map[*src];
+			}
+			src++;
+			dst++;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+static void BLIT1_AVX2 Blit1to4KeyAVX2(SDL_BlitInfo *info)
+{
+	int width = info->d_width;
+	int height = info->d_height;
+	Uint8 *src = info->s_pixels;
+	int srcskip = info->s_skip;
+	Uint32 *dst = (Uint32 *)info->d_pixels;
+	int dstskip = info->d_skip/4;
+	Uint32 *map = (Uint32 *)info->table;
+	Uint32 ckey = info->src->colorkey;
+	const __m256i key = _mm256_set1_epi32(ckey);
+	const __m256i ones = _mm256_set1_epi32(-1);
+
+	while ( height-- ) {
+		int c;
+		for ( c = width; c >= 8; c -= 8 ) {
+			__m256i index, opaque;
+
+			index = _mm256_cvtepu8_epi32(
+				_mm_loadl_epi64((__m128i *)src));
+			opaque = _mm256_xor_si256(
+				_mm256_cmpeq_epi32(index, key), ones);
+			_mm256_maskstore_epi32((int *)dst, opaque,
+				_mm256_mask_i32gather_epi32(_mm256_setzero_si256(),
+					(int *)map, index, opaque, 4));
+			src += 8;
+			dst += 8;
+		}
+		while ( c-- ) {
+			if ( *src != ckey ) {
+				*dst = map[*src];
+			}
+			src++;
+			dst++;
+		}
+		src += srcskip;
+		dst += dstskip;
+	}
+}
+#endif /* SDL_BLIT1_AVX2 */
+
 static void Blit1toNAlpha(SDL_BlitInfo *info)
 {
 	int width = info->d_width;
@@ -504,9 +668,30 @@ SDL_loblit SDL_CalculateBlit1(SDL_Surface *surface, int blit_index)
 	}
 	switch(blit_index) {
 	case 0:			/* copy */
+#if SDL_BLIT1_AVX2
+	    if ( SDL_HasAVX2() ) {
+		if ( which == 2 ) {
+		    return Blit1to2AVX2;
+		}
+		if ( which == 4 ) {
+		    return Blit1to4AVX2;
+		}
+	    }
+#endif
 	    return one_blit[which];
 
 	case 1:			/* colorkey */
+#if SDL_BLIT1_AVX2
+	    if ( SDL_HasAVX2() ) {
+		if ( which == 2 &&
+		     !(surface->map->dst->flags & SDL_HWSURFACE) ) {
+		    return Blit1to2KeyAVX2;
+		}
+		if ( which == 4 ) {
+		    return Blit1to4KeyAVX2;
+		}
+	    }
+#endif
 	    return one_blitkey[which];
 
 	case 2:			/* alpha */
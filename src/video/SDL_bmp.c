@@ -30,11 +30,15 @@
    and save, and since PNG is so complex that it would bloat the library,
    BMP is a good alternative. 
 
-   This code currently supports Win32 DIBs in uncompressed 8 and 24 bpp.
+   This code currently supports Win32 DIBs in uncompressed 1, 4, 8, 15,
+   16, 24 and 32 bpp, and in RLE compressed 4 and 8 bpp.
 */
 
 #include "SDL_video.h"
 #include "SDL_endian.h"
+#include "SDL_thread.h"
+#include "SDL_pixels_c.h"
+#include "../file/SDL_rwops_c.h"
 
 /* Compression encodings for BMP files */
 #ifndef BI_RGB
@@ -44,22 +48,382 @@
 #define BI_BITFIELDS	3
 #endif
 
+/* The pixel data is read this many bytes at a time, unless it's in memory */
+#define BMP_BLOCK_SIZE	(64*1024)
 
-SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
+/* The 8 pixels packed in each byte of a 1 bit per pixel row */
+#define BMP_E1(b)	{ ((b)>>7)&1, ((b)>>6)&1, ((b)>>5)&1, ((b)>>4)&1, \
+			  ((b)>>3)&1, ((b)>>2)&1, ((b)>>1)&1, (b)&1 }
+#define BMP_E4(b)	BMP_E1(b), BMP_E1((b)+1), BMP_E1((b)+2), BMP_E1((b)+3)
+#define BMP_E16(b)	BMP_E4(b), BMP_E4((b)+4), BMP_E4((b)+8), BMP_E4((b)+12)
+#define BMP_E64(b)	BMP_E16(b), BMP_E16((b)+16), BMP_E16((b)+32), \
+			BMP_E16((b)+48)
+static const Uint8 bmp_expand1[256][8] = {
+	BMP_E64(0), BMP_E64(64), BMP_E64(128), BMP_E64(192)
+};
+
+/* Expand a row of 1 or 4 bit pixels to 8 bits per pixel */
+static void BMP_ExpandRow(Uint8 *dst, const Uint8 *src, int width, int bits)
+{
+	const Uint8 *pixels;
+	int i;
+
+	if ( bits == 1 ) {
+		for ( i = width / 8; i--; dst += 8 ) {
+			pixels = bmp_expand1[*src++];
+			dst[0] = pixels[0];
+			dst[1] = pixels[1];
+			dst[2] = pixels[2];
+			dst[3] = pixels[3];
+			dst[4] = pixels[4];
+			dst[5] = pixels[5];
+			dst[6] = pixels[6];
+			dst[7] = pixels[7];
+		}
+		if ( width & 7 ) {
+			pixels = bmp_expand1[*src];
+			for ( i = 0; i < (width & 7); ++i ) {
+				dst[i] = pixels[i];
+			}
+		}
+	} else {
+		/* A nibble shift is as quick as a table lookup */
+		for ( i = width / 2; i--; dst += 2 ) {
+			dst[0] = (*src >> 4);
+			dst[1] = (*src++ & 0x0F);
+		}
+		if ( width & 1 ) {
+			dst[0] = (*src >> 4);
+		}
+	}
+}
+
+/* Compressed data, read a block at a time unless it's in memory */
+struct bmp_stream {
+	SDL_RWops *src;
+	Uint8 *here;
+	Uint8 *stop;
+	Uint8 *buffer;
+};
+
+/* Make sure there are at least n bytes of compressed data available */
+static SDL_bool BMP_Need(struct bmp_stream *stream, int n)
+{
+	int left, got;
+
+	left = (int)(stream->stop - stream->here);
+	if ( left >= n ) {
+		return SDL_TRUE;
+	}
+	if ( stream->buffer == NULL ) {
+		return SDL_FALSE;
+	}
+	SDL_memmove(stream->buffer, stream->here, left);
+	got = SDL_RWread(stream->src, stream->buffer + left, 1,
+	                 BMP_BLOCK_SIZE - left);
+	if ( got < 0 ) {
+		got = 0;
+	}
+	stream->here = stream->buffer;
+	stream->stop = stream->buffer + left + got;
+	return (left + got >= n) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Decode RLE8 or RLE4 data straight into the rows of an 8 bpp surface.
+   Runs are clipped to the surface, and pixels that are skipped over are
+   left at 0.
+ */
+static int BMP_DecodeRLE(SDL_RWops *src, SDL_Surface *surface, int bits,
+                         SDL_bool topDown)
+{
+	struct bmp_stream stream;
+	Uint8 *here, *stop;
+	Uint8 *row, *dst;
+	int w, h;
+	long pitch;
+	int x, y, n;
+	int count, value;
+	int length, i;
+	int retval;
+
+	stream.src = src;
+	stream.buffer = NULL;
+	stream.here = SDL_RWmapMem(src, 0x7FFFFFFF, &length);
+	if ( stream.here ) {
+		stream.stop = stream.here + length;
+	} else {
+		stream.buffer = (Uint8 *)SDL_malloc(BMP_BLOCK_SIZE);
+		if ( stream.buffer == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		stream.here = stream.stop = stream.buffer;
+	}
+
+	/* Keep the stream and surface in locals, since the byte stores into
+	   the rows would otherwise force them to be reloaded every token.
+	 */
+	w = surface->w;
+	h = surface->h;
+	pitch = (long)SDL_SurfacePitch(surface);
+	if ( ! topDown ) {
+		pitch = -pitch;
+	}
+	here = stream.here;
+	stop = stream.stop;
+	retval = -1;
+	x = y = 0;
+	row = (Uint8 *)surface->pixels;
+	if ( ! topDown ) {
+		row += (size_t)(h - 1) * SDL_SurfacePitch(surface);
+	}
+	while ( y < h ) {
+		if ( x > w ) {
+			x = w;
+		}
+		if ( (stop - here) < 2 ) {
+			stream.here = here;
+			if ( ! BMP_Need(&stream, 2) ) {
+				break;
+			}
+			here = stream.here;
+			stop = stream.stop;
+		}
+		count = here[0];
+		value = here[1];
+		here += 2;
+
+		if ( count ) {
+			/* A run of one color, or two alternating ones */
+			n = w - x;
+			if ( n > count ) {
+				n = count;
+			}
+			if ( n > 0 ) {
+				if ( (bits == 8) || ((value >> 4) == (value & 0x0F)) ) {
+					value &= ((1 << bits) - 1);
+					/* Most runs in dithered art are short, and
+					   the compiler turns loops or memset() into a
+					   string store that is slow to start up.
+					 */
+					dst = row + x;
+					if ( n > 64 ) {
+						SDL_memset(dst, value, n);
+						n = 0;
+					}
+					while ( n > 8 ) {
+						dst[0] = value; dst[1] = value;
+						dst[2] = value; dst[3] = value;
+						dst[4] = value; dst[5] = value;
+						dst[6] = value; dst[7] = value;
+						dst += 8;
+						n -= 8;
+					}
+					switch (n) {
+					    case 8: dst[7] = value;
+					    case 7: dst[6] = value;
+					    case 6: dst[5] = value;
+					    case 5: dst[4] = value;
+					    case 4: dst[3] = value;
+					    case 3: dst[2] = value;
+					    case 2: dst[1] = value;
+					    case 1: dst[0] = value;
+					}
+				} else {
+					for ( i = 0; i < n; ++i ) {
+						row[x+i] = (i & 1) ?
+						           (value & 0x0F) : (value >> 4);
+					}
+				}
+			}
+			x += count;
+			continue;
+		}
+
+		switch (value) {
+		    case 0:	/* End of line */
+			x = 0;
+			++y;
+			row += pitch;
+			break;
+		    case 1:	/* End of bitmap */
+			y = h;
+			break;
+		    case 2:	/* Move right and up */
+			stream.here = here;
+			if ( ! BMP_Need(&stream, 2) ) {
+				goto done;
+			}
+			here = stream.here;
+			stop = stream.stop;
+			x += here[0];
+			y += here[1];
+			row += here[1] * pitch;
+			here += 2;
+			break;
+		    default:	/* A run of literal pixels, padded to a word */
+			length = (bits == 8) ? value : (value + 1) / 2;
+			length = (length + 1) & ~1;
+			stream.here = here;
+			if ( ! BMP_Need(&stream, length) ) {
+				goto done;
+			}
+			here = stream.here;
+			stop = stream.stop;
+			n = w - x;
+			if ( n > value ) {
+				n = value;
+			}
+			if ( n > 0 ) {
+				if ( bits == 8 ) {
+					SDL_memcpy(row + x, here, n);
+				} else {
+					BMP_ExpandRow(row + x, here, n, 4);
+				}
+			}
+			here += length;
+			x += value;
+			break;
+		}
+	}
+	stream.here = here;
+	if ( y >= surface->h ) {
+		retval = 0;
+	}
+done:
+	if ( retval < 0 ) {
+		SDL_SetError("Error reading from BMP");
+	}
+	/* Leave the data source just past the data we used */
+	SDL_RWseek(src, -(int)(stream.stop - stream.here), RW_SEEK_CUR);
+	if ( stream.buffer ) {
+		SDL_free(stream.buffer);
+	}
+	return(retval);
+}
+
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+/* Byte-swap a row of 16 or 32 bit pixels.  Rows are 4 byte aligned, so
+   the 16 bit pixels can be swapped in pairs.
+ */
+static void BMP_SwapRow(Uint8 *bits, int width, int bpp)
+{
+	Uint32 *pix = (Uint32 *)bits;
+	int i;
+
+	if ( bpp == 2 ) {
+		for ( i = width / 2; i--; ++pix ) {
+			*pix = ((*pix & 0xFF00FF00) >> 8) | ((*pix & 0x00FF00FF) << 8);
+		}
+		if ( width & 1 ) {
+			*(Uint16 *)pix = SDL_Swap16(*(Uint16 *)pix);
+		}
+	} else {
+		for ( i = width; i--; ++pix ) {
+			*pix = SDL_Swap32(*pix);
+		}
+	}
+}
+#endif
+
+/* Create the surface that a BMP file is converted into as it is read,
+   the same way SDL_ConvertSurface() does.
+ */
+static SDL_Surface *BMP_CreateConverted(int w, int h,
+                                        SDL_PixelFormat *fmt, Uint32 flags)
+{
+	SDL_Surface *image;
+
+	/* Check for empty destination palette! (results in empty image) */
+	if ( fmt->palette != NULL ) {
+		int i;
+		for ( i=0; i<fmt->palette->ncolors; ++i ) {
+			if ( (fmt->palette->colors[i].r != 0) ||
+			     (fmt->palette->colors[i].g != 0) ||
+			     (fmt->palette->colors[i].b != 0) )
+				break;
+		}
+		if ( i == fmt->palette->ncolors ) {
+			SDL_SetError("Empty destination palette");
+			return(NULL);
+		}
+	}
+
+	/* Only create hw surfaces with alpha channel if hw alpha blits
+	   are supported */
+	if ( fmt->Amask != 0 && (flags & SDL_HWSURFACE) ) {
+		const SDL_VideoInfo *vi = SDL_GetVideoInfo();
+		if ( !vi || !vi->blit_hw_A )
+			flags &= ~SDL_HWSURFACE;
+	}
+
+	image = SDL_CreateRGBSurface(flags, w, h, fmt->BitsPerPixel,
+			fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	if ( image == NULL ) {
+		return(NULL);
+	}
+	if ( fmt->palette && image->format->palette ) {
+		SDL_memcpy(image->format->palette->colors,
+				fmt->palette->colors,
+				fmt->palette->ncolors*sizeof(SDL_Color));
+		image->format->palette->ncolors = fmt->palette->ncolors;
+	}
+	return(image);
+}
+
+/* Set the color key and surface alpha of a converted image.  If RLE
+   acceleration is wanted, the image is mapped to the display right away,
+   so the encoding is done now instead of on the first blit.
+ */
+static void BMP_FinishConverted(SDL_Surface *image,
+                                SDL_PixelFormat *fmt, Uint32 flags)
+{
+	SDL_Surface *screen;
+	Uint32 rleflags;
+
+	rleflags = (flags & (SDL_RLEACCEL|SDL_RLEACCELOK)) ? SDL_RLEACCEL : 0;
+	if ( (flags & SDL_SRCCOLORKEY) == SDL_SRCCOLORKEY ) {
+		SDL_SetColorKey(image, SDL_SRCCOLORKEY|rleflags, fmt->colorkey);
+	}
+	if ( ((flags & SDL_SRCALPHA) == SDL_SRCALPHA) && !fmt->Amask ) {
+		SDL_SetAlpha(image, SDL_SRCALPHA|rleflags, fmt->alpha);
+	} else if ( image->format->Amask && rleflags ) {
+		SDL_SetAlpha(image, SDL_SRCALPHA|rleflags, SDL_ALPHA_OPAQUE);
+	}
+
+	screen = SDL_GetVideoSurface();
+	if ( rleflags && screen &&
+	     (image->flags & (SDL_SRCCOLORKEY|SDL_SRCALPHA)) ) {
+		SDL_MapSurface(image, screen);
+	}
+}
+
+static SDL_Surface *BMP_Load(SDL_RWops *src, int freesrc,
+                             SDL_PixelFormat *fmt, Uint32 flags)
 {
 	SDL_bool was_error;
 	long fp_offset = 0;
 	int bmpPitch;
+	size_t pitch;
 	int i, pad;
 	SDL_Surface *surface;
 	Uint32 Rmask;
 	Uint32 Gmask;
 	Uint32 Bmask;
 	SDL_Palette *palette;
+	Uint8 colors[256*4];
+	int colorSize;
 	Uint8 *bits;
 	Uint8 *top, *end;
 	SDL_bool topDown;
 	int ExpandBMP;
+	int rowSize;
+	int y, rows, blockRows;
+	int total, got;
+	Uint8 *data, *buffer;
+	SDL_Surface *image;
+	SDL_Rect32 srect, drect;
+	int convRows;
 
 	/* The Win32 BMP file header (14 bytes) */
 	char   magic[2];
@@ -83,6 +447,8 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 
 	/* Make sure we are passed a valid data source */
 	surface = NULL;
+	image = NULL;
+	buffer = NULL;
 	was_error = SDL_FALSE;
 	if ( src == NULL ) {
 		was_error = SDL_TRUE;
@@ -168,7 +534,7 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			break;
 	}
 
-	/* We don't support any BMP compression right now */
+	/* Find the masks for uncompressed 15, 16 and 32 bpp images */
 	Rmask = Gmask = Bmask = 0;
 	switch (biCompression) {
 		case BI_RGB:
@@ -214,15 +580,48 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 					break;
 			}
 			break;
+		case BI_RLE8:
+		case BI_RLE4:
+			/* These are decoded to 8 bpp after the palette */
+			if ( (biBitCount != 8) ||
+			     (ExpandBMP != ((biCompression == BI_RLE4) ? 4 : 0)) ) {
+				SDL_SetError("Invalid BMP compression for its bit depth");
+				was_error = SDL_TRUE;
+				goto done;
+			}
+			break;
 		default:
 			SDL_SetError("Compressed BMP files not supported");
 			was_error = SDL_TRUE;
 			goto done;
 	}
 
+	/* When converting, uncompressed rows are read into a small surface
+	   a block at a time, and blitted from there into the final image.
+	 */
+	convRows = biHeight;
+	if ( fmt ) {
+		image = BMP_CreateConverted(biWidth, biHeight, fmt, flags);
+		if ( image == NULL ) {
+			was_error = SDL_TRUE;
+			goto done;
+		}
+		if ( (biCompression != BI_RLE8) && (biCompression != BI_RLE4) &&
+		     (biWidth > 0) ) {
+			convRows = BMP_BLOCK_SIZE /
+			           (((biBitCount + 7) / 8) * biWidth);
+			if ( convRows < 1 ) {
+				convRows = 1;
+			}
+			if ( convRows > biHeight ) {
+				convRows = biHeight;
+			}
+		}
+	}
+
 	/* Create a compatible surface, note that the colors are RGB ordered */
 	surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
-			biWidth, biHeight, biBitCount, Rmask, Gmask, Bmask, 0);
+			biWidth, convRows, biBitCount, Rmask, Gmask, Bmask, 0);
 	if ( surface == NULL ) {
 		was_error = SDL_TRUE;
 		goto done;
@@ -232,22 +631,26 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 	palette = (surface->format)->palette;
 	if ( palette ) {
 		if ( biClrUsed == 0 ) {
-			biClrUsed = 1 << biBitCount;
-		}
-		if ( biSize == 12 ) {
-			for ( i = 0; i < (int)biClrUsed; ++i ) {
-				SDL_RWread(src, &palette->colors[i].b, 1, 1);
-				SDL_RWread(src, &palette->colors[i].g, 1, 1);
-				SDL_RWread(src, &palette->colors[i].r, 1, 1);
-				palette->colors[i].unused = 0;
-			}	
-		} else {
-			for ( i = 0; i < (int)biClrUsed; ++i ) {
-				SDL_RWread(src, &palette->colors[i].b, 1, 1);
-				SDL_RWread(src, &palette->colors[i].g, 1, 1);
-				SDL_RWread(src, &palette->colors[i].r, 1, 1);
-				SDL_RWread(src, &palette->colors[i].unused, 1, 1);
-			}	
+			biClrUsed = 1 << (ExpandBMP ? ExpandBMP : biBitCount);
+		}
+		if ( biClrUsed > (Uint32)palette->ncolors ) {
+			SDL_SetError("BMP file has an invalid number of colors");
+			was_error = SDL_TRUE;
+			goto done;
+		}
+		colorSize = (biSize == 12) ? 3 : 4;
+		if ( SDL_RWread(src, colors, colorSize, biClrUsed) !=
+							(int)biClrUsed ) {
+			SDL_Error(SDL_EFREAD);
+			was_error = SDL_TRUE;
+			goto done;
+		}
+		for ( i = 0; i < (int)biClrUsed; ++i ) {
+			palette->colors[i].b = colors[i*colorSize+0];
+			palette->colors[i].g = colors[i*colorSize+1];
+			palette->colors[i].r = colors[i*colorSize+2];
+			palette->colors[i].unused =
+				(colorSize == 4) ? colors[i*colorSize+3] : 0;
 		}
 		palette->ncolors = biClrUsed;
 	}
@@ -258,90 +661,143 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 		was_error = SDL_TRUE;
 		goto done;
 	}
+	if ( (biCompression == BI_RLE8) || (biCompression == BI_RLE4) ) {
+		if ( BMP_DecodeRLE(src, surface, (ExpandBMP ? ExpandBMP : 8),
+		                   topDown) < 0 ) {
+			was_error = SDL_TRUE;
+		} else if ( image ) {
+			srect.x = 0;
+			srect.y = 0;
+			srect.w = surface->w;
+			srect.h = surface->h;
+			drect = srect;
+			SDL_LowerBlit32(surface, &srect, image, &drect);
+		}
+		goto done;
+	}
+	pitch = SDL_SurfacePitch(surface);
 	top = (Uint8 *)surface->pixels;
-	end = (Uint8 *)surface->pixels+(surface->h*surface->pitch);
+	end = (Uint8 *)surface->pixels+(surface->h*pitch);
 	switch (ExpandBMP) {
 		case 1:
 			bmpPitch = (biWidth + 7) >> 3;
-			pad  = (((bmpPitch)%4) ? (4-((bmpPitch)%4)) : 0);
 			break;
 		case 4:
 			bmpPitch = (biWidth + 1) >> 1;
-			pad  = (((bmpPitch)%4) ? (4-((bmpPitch)%4)) : 0);
 			break;
 		default:
-			pad  = ((surface->pitch%4) ?
-					(4-(surface->pitch%4)) : 0);
+			bmpPitch = (int)pitch;
 			break;
 	}
-	if ( topDown ) {
-		bits = top;
-	} else {
-		bits = end - surface->pitch;
-	}
-	while ( bits >= top && bits < end ) {
-		switch (ExpandBMP) {
-			case 1:
-			case 4: {
-			Uint8 pixel = 0;
-			int   shift = (8-ExpandBMP);
-			for ( i=0; i<surface->w; ++i ) {
-				if ( i%(8/ExpandBMP) == 0 ) {
-					if ( !SDL_RWread(src, &pixel, 1, 1) ) {
-						SDL_SetError(
-					"Error reading from BMP");
-						was_error = SDL_TRUE;
-						goto done;
-					}
-				}
-				*(bits+i) = (pixel>>shift);
-				pixel <<= ExpandBMP;
-			} }
-			break;
+	pad  = (((bmpPitch)%4) ? (4-((bmpPitch)%4)) : 0);
+	rowSize = bmpPitch + pad;
+	if ( biHeight == 0 ) {
+		goto done;
+	}
 
-			default:
-			if ( SDL_RWread(src, bits, 1, surface->pitch)
-							 != surface->pitch ) {
+	/* Use the rows where they are if the data source is in memory,
+	   otherwise read them in large blocks.  Some writers leave out the
+	   padding after the last row, so we don't insist on it.
+	 */
+	total = biHeight * rowSize - pad;
+	data = SDL_RWmapMem(src, total, &got);
+	if ( data ) {
+		if ( got != total ) {
+			SDL_Error(SDL_EFREAD);
+			was_error = SDL_TRUE;
+			goto done;
+		}
+		blockRows = convRows;
+	} else {
+		blockRows = BMP_BLOCK_SIZE / rowSize;
+		if ( blockRows < 1 ) {
+			blockRows = 1;
+		}
+		if ( blockRows > convRows ) {
+			blockRows = convRows;
+		}
+		buffer = (Uint8 *)SDL_malloc(blockRows * rowSize);
+		if ( buffer == NULL ) {
+			SDL_OutOfMemory();
+			was_error = SDL_TRUE;
+			goto done;
+		}
+	}
+	for ( y = 0; y < biHeight; y += rows ) {
+		rows = biHeight - y;
+		if ( rows > blockRows ) {
+			rows = blockRows;
+		}
+		if ( buffer ) {
+			total = rows * rowSize;
+			if ( y + rows == biHeight ) {
+				total -= pad;
+			}
+			if ( SDL_RWread(src, buffer, 1, total) != total ) {
 				SDL_Error(SDL_EFREAD);
 				was_error = SDL_TRUE;
 				goto done;
 			}
+			data = buffer;
+		}
+		for ( i = 0; i < rows; ++i, data += rowSize ) {
+			if ( image ) {
+				/* The block is in top down order */
+				if ( topDown ) {
+					bits = top + i * pitch;
+				} else {
+					bits = top + (rows - i - 1) * pitch;
+				}
+			} else if ( topDown ) {
+				bits = top + (y + i) * pitch;
+			} else {
+				bits = end - (y + i + 1) * pitch;
+			}
+			if ( ExpandBMP ) {
+				BMP_ExpandRow(bits, data, surface->w, ExpandBMP);
+				continue;
+			}
+			SDL_memcpy(bits, data, pitch);
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
 			/* Byte-swap the pixels if needed. Note that the 24bpp
 			   case has already been taken care of above. */
 			switch(biBitCount) {
 				case 15:
-				case 16: {
-				        Uint16 *pix = (Uint16 *)bits;
-					for(i = 0; i < surface->w; i++)
-					        pix[i] = SDL_Swap16(pix[i]);
+				case 16:
+					BMP_SwapRow(bits, surface->w, 2);
 					break;
-				}
-
-				case 32: {
-				        Uint32 *pix = (Uint32 *)bits;
-					for(i = 0; i < surface->w; i++)
-					        pix[i] = SDL_Swap32(pix[i]);
+				case 32:
+					BMP_SwapRow(bits, surface->w, 4);
 					break;
-				}
 			}
 #endif
-			break;
 		}
-		/* Skip padding bytes, ugh */
-		if ( pad ) {
-			Uint8 padbyte;
-			for ( i=0; i<pad; ++i ) {
-				SDL_RWread(src, &padbyte, 1, 1);
+		if ( image ) {
+			srect.x = 0;
+			srect.y = 0;
+			srect.w = surface->w;
+			srect.h = rows;
+			drect = srect;
+			drect.y = topDown ? y : (biHeight - y - rows);
+			if ( SDL_LowerBlit32(surface, &srect, image, &drect) < 0 ) {
+				was_error = SDL_TRUE;
+				goto done;
 			}
 		}
-		if ( topDown ) {
-			bits += surface->pitch;
-		} else {
-			bits -= surface->pitch;
-		}
 	}
 done:
+	if ( buffer ) {
+		SDL_free(buffer);
+	}
+	if ( image ) {
+		if ( surface ) {
+			SDL_FreeSurface(surface);
+		}
+		surface = image;
+		if ( ! was_error ) {
+			BMP_FinishConverted(surface, fmt, flags);
+		}
+	}
 	if ( was_error ) {
 		if ( src ) {
 			SDL_RWseek(src, fp_offset, RW_SEEK_SET);
@@ -357,39 +813,77 @@ done:
 	return(surface);
 }
 
+SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
+{
+	return(BMP_Load(src, freesrc, NULL, 0));
+}
+
+SDL_Surface * SDL_LoadBMP_RW_Format (SDL_RWops *src, int freesrc,
+                                     SDL_PixelFormat *fmt, Uint32 flags)
+{
+	if ( fmt == NULL ) {
+		SDL_SetError("Passed a NULL pixel format");
+		if ( freesrc && src ) {
+			SDL_RWclose(src);
+		}
+		return(NULL);
+	}
+	return(BMP_Load(src, freesrc, fmt, flags));
+}
+
+static void BMP_Put16(Uint8 *p, Uint16 value)
+{
+	p[0] = (Uint8)(value & 0xFF);
+	p[1] = (Uint8)(value >> 8);
+}
+
+static void BMP_Put32(Uint8 *p, Uint32 value)
+{
+	BMP_Put16(p, (Uint16)(value & 0xFFFF));
+	BMP_Put16(p + 2, (Uint16)(value >> 16));
+}
+
 int SDL_SaveBMP_RW (SDL_Surface *saveme, SDL_RWops *dst, int freedst)
 {
-	long fp_offset;
 	int i, pad;
 	SDL_Surface *surface;
+	SDL_Surface *convert;
+	SDL_bool converting;
+	SDL_Rect32 srect, drect;
 	Uint8 *bits;
+	Uint8 header[14+40+12];
+	Uint8 colors[256*4];
+	Uint8 *buffer, *data;
+	int bw, rowSize;
+	size_t pitch;
+	int y, rows, blockRows;
+	int headerSize;
+	Uint32 surface_flags;
+	Uint32 colorkey;
+	Uint8 alpha;
 
 	/* The Win32 BMP file header (14 bytes) */
-	char   magic[2] = { 'B', 'M' };
 	Uint32 bfSize;
-	Uint16 bfReserved1;
-	Uint16 bfReserved2;
 	Uint32 bfOffBits;
 
 	/* The Win32 BITMAPINFOHEADER struct (40 bytes) */
 	Uint32 biSize;
-	Sint32 biWidth;
-	Sint32 biHeight;
-	Uint16 biPlanes;
 	Uint16 biBitCount;
 	Uint32 biCompression;
-	Uint32 biSizeImage;
-	Sint32 biXPelsPerMeter;
-	Sint32 biYPelsPerMeter;
 	Uint32 biClrUsed;
-	Uint32 biClrImportant;
 
 	/* Make sure we have somewhere to save */
 	surface = NULL;
+	convert = NULL;
+	buffer = NULL;
+	converting = SDL_FALSE;
+	biBitCount = 24;
+	biCompression = BI_RGB;
 	if ( dst ) {
 		if ( saveme->format->palette ) {
 			if ( saveme->format->BitsPerPixel == 8 ) {
 				surface = saveme;
+				biBitCount = 8;
 			} else {
 				SDL_SetError("%d bpp BMP files not supported",
 						saveme->format->BitsPerPixel);
@@ -407,139 +901,198 @@ int SDL_SaveBMP_RW (SDL_Surface *saveme, SDL_RWops *dst, int freedst)
 #endif
 			  ) {
 			surface = saveme;
+		}
+		else if ( saveme->format->BitsPerPixel == 32 ) {
+			/* Write the pixels as they are, with their masks */
+			surface = saveme;
+			biBitCount = 32;
+			if ( (saveme->format->Rmask != 0x00FF0000) ||
+			     (saveme->format->Gmask != 0x0000FF00) ||
+			     (saveme->format->Bmask != 0x000000FF) ) {
+				biCompression = BI_BITFIELDS;
+			}
 		} else {
-			SDL_Rect bounds;
+			/* Convert to 24 bits per pixel, a block at a time */
+			surface = saveme;
+			converting = SDL_TRUE;
+		}
+	}
 
-			/* Convert to 24 bits per pixel */
-			surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
-					saveme->w, saveme->h, 24,
+	if ( surface ) {
+		/* Set up the rows, which are written a block at a time */
+		bw = surface->w * (biBitCount / 8);
+		pad  = ((bw%4) ? (4-(bw%4)) : 0);
+		rowSize = bw + pad;
+		blockRows = rowSize ? (BMP_BLOCK_SIZE / rowSize) : 1;
+		if ( blockRows < 1 ) {
+			blockRows = 1;
+		}
+		if ( blockRows > surface->h ) {
+			blockRows = surface->h;
+		}
+		if ( blockRows > 0 ) {
+			buffer = (Uint8 *)SDL_malloc(blockRows * rowSize);
+			if ( buffer == NULL ) {
+				SDL_OutOfMemory();
+				surface = NULL;
+			}
+		}
+	}
+	if ( surface && converting ) {
+		convert = SDL_CreateRGBSurface(SDL_SWSURFACE,
+				surface->w, blockRows, 24,
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
-					0x00FF0000, 0x0000FF00, 0x000000FF,
+				0x00FF0000, 0x0000FF00, 0x000000FF,
 #else
-					0x000000FF, 0x0000FF00, 0x00FF0000,
+				0x000000FF, 0x0000FF00, 0x00FF0000,
 #endif
-					0);
-			if ( surface != NULL ) {
-				bounds.x = 0;
-				bounds.y = 0;
-				bounds.w = saveme->w;
-				bounds.h = saveme->h;
-				if ( SDL_LowerBlit(saveme, &bounds, surface,
-							&bounds) < 0 ) {
-					SDL_FreeSurface(surface);
-					SDL_SetError(
-					"Couldn't convert image to 24 bpp");
-					surface = NULL;
-				}
-			}
+				0);
+		if ( convert == NULL ) {
+			surface = NULL;
 		}
 	}
 
-	if ( surface && (SDL_LockSurface(surface) == 0) ) {
-		const int bw = surface->w*surface->format->BytesPerPixel;
-
-		/* Set the BMP file header values */
-		bfSize = 0;		 /* We'll write this when we're done */
-		bfReserved1 = 0;
-		bfReserved2 = 0;
-		bfOffBits = 0;		/* We'll write this when we're done */
+	/* The block is reused, so copy the pixels without the color key and
+	   alpha, as SDL_ConvertSurface() does, or they'd be blended with the
+	   previous block.
+	 */
+	surface_flags = 0;
+	colorkey = 0;
+	alpha = 0;
+	if ( surface && convert ) {
+		surface_flags = surface->flags;
+		colorkey = surface->format->colorkey;
+		alpha = surface->format->alpha;
+		if ( surface_flags & SDL_SRCCOLORKEY ) {
+			SDL_SetColorKey(surface, 0, 0);
+		}
+		if ( surface_flags & SDL_SRCALPHA ) {
+			SDL_SetAlpha(surface, 0, 0);
+		}
+	}
 
-		/* Write the BMP file header values */
-		fp_offset = SDL_RWtell(dst);
+	if ( surface && (SDL_LockSurface(surface) == 0) ) {
 		SDL_ClearError();
-		SDL_RWwrite(dst, magic, 2, 1);
-		SDL_WriteLE32(dst, bfSize);
-		SDL_WriteLE16(dst, bfReserved1);
-		SDL_WriteLE16(dst, bfReserved2);
-		SDL_WriteLE32(dst, bfOffBits);
 
-		/* Set the BMP info values */
+		/* Set the BMP header values, the sizes are all known up front */
 		biSize = 40;
-		biWidth = surface->w;
-		biHeight = surface->h;
-		biPlanes = 1;
-		biBitCount = surface->format->BitsPerPixel;
-		biCompression = BI_RGB;
-		biSizeImage = surface->h*surface->pitch;
-		biXPelsPerMeter = 0;
-		biYPelsPerMeter = 0;
+		headerSize = 14 + biSize;
+		if ( biCompression == BI_BITFIELDS ) {
+			headerSize += 12;
+		}
 		if ( surface->format->palette ) {
 			biClrUsed = surface->format->palette->ncolors;
 		} else {
 			biClrUsed = 0;
 		}
-		biClrImportant = 0;
-
-		/* Write the BMP info values */
-		SDL_WriteLE32(dst, biSize);
-		SDL_WriteLE32(dst, biWidth);
-		SDL_WriteLE32(dst, biHeight);
-		SDL_WriteLE16(dst, biPlanes);
-		SDL_WriteLE16(dst, biBitCount);
-		SDL_WriteLE32(dst, biCompression);
-		SDL_WriteLE32(dst, biSizeImage);
-		SDL_WriteLE32(dst, biXPelsPerMeter);
-		SDL_WriteLE32(dst, biYPelsPerMeter);
-		SDL_WriteLE32(dst, biClrUsed);
-		SDL_WriteLE32(dst, biClrImportant);
+		bfOffBits = headerSize + biClrUsed * 4;
+		bfSize = bfOffBits + surface->h * rowSize;
 
-		/* Write the palette (in BGR color order) */
-		if ( surface->format->palette ) {
-			SDL_Color *colors;
-			int       ncolors;
-
-			colors = surface->format->palette->colors;
-			ncolors = surface->format->palette->ncolors;
-			for ( i=0; i<ncolors; ++i ) {
-				SDL_RWwrite(dst, &colors[i].b, 1, 1);
-				SDL_RWwrite(dst, &colors[i].g, 1, 1);
-				SDL_RWwrite(dst, &colors[i].r, 1, 1);
-				SDL_RWwrite(dst, &colors[i].unused, 1, 1);
-			}
+		/* Write the BMP file header and info values */
+		SDL_memset(header, 0, sizeof(header));
+		header[0] = 'B';
+		header[1] = 'M';
+		BMP_Put32(&header[2], bfSize);
+		BMP_Put32(&header[10], bfOffBits);
+		BMP_Put32(&header[14], biSize);
+		BMP_Put32(&header[18], surface->w);
+		BMP_Put32(&header[22], surface->h);
+		BMP_Put16(&header[26], 1);
+		BMP_Put16(&header[28], biBitCount);
+		BMP_Put32(&header[30], biCompression);
+		BMP_Put32(&header[34], surface->h * rowSize);
+		BMP_Put32(&header[46], biClrUsed);
+		if ( biCompression == BI_BITFIELDS ) {
+			BMP_Put32(&header[54], surface->format->Rmask);
+			BMP_Put32(&header[58], surface->format->Gmask);
+			BMP_Put32(&header[62], surface->format->Bmask);
 		}
-
-		/* Write the bitmap offset */
-		bfOffBits = SDL_RWtell(dst)-fp_offset;
-		if ( SDL_RWseek(dst, fp_offset+10, RW_SEEK_SET) < 0 ) {
-			SDL_Error(SDL_EFSEEK);
-		}
-		SDL_WriteLE32(dst, bfOffBits);
-		if ( SDL_RWseek(dst, fp_offset+bfOffBits, RW_SEEK_SET) < 0 ) {
-			SDL_Error(SDL_EFSEEK);
+		if ( SDL_RWwrite(dst, header, 1, headerSize) != headerSize ) {
+			SDL_Error(SDL_EFWRITE);
 		}
 
-		/* Write the bitmap image upside down */
-		bits = (Uint8 *)surface->pixels+(surface->h*surface->pitch);
-		pad  = ((bw%4) ? (4-(bw%4)) : 0);
-		while ( bits > (Uint8 *)surface->pixels ) {
-			bits -= surface->pitch;
-			if ( SDL_RWwrite(dst, bits, 1, bw) != bw) {
+		/* Write the palette (in BGR color order) */
+		if ( biClrUsed && (SDL_strcmp(SDL_GetError(), "") == 0) ) {
+			SDL_Color *pal = surface->format->palette->colors;
+
+			for ( i=0; i<(int)biClrUsed; ++i ) {
+				colors[i*4+0] = pal[i].b;
+				colors[i*4+1] = pal[i].g;
+				colors[i*4+2] = pal[i].r;
+				colors[i*4+3] = pal[i].unused;
+			}
+			if ( SDL_RWwrite(dst, colors, 4, biClrUsed) !=
+							(int)biClrUsed ) {
 				SDL_Error(SDL_EFWRITE);
+			}
+		}
+
+		/* Write the bitmap image upside down, a block of rows at a time.
+		   Rows that need converting are blitted into a 24 bpp block
+		   first, which is then copied bottom row first.
+		 */
+		for ( y = 0; y < surface->h; y += rows ) {
+			if ( SDL_strcmp(SDL_GetError(), "") != 0 ) {
 				break;
 			}
-			if ( pad ) {
-				const Uint8 padbyte = 0;
-				for ( i=0; i<pad; ++i ) {
-					SDL_RWwrite(dst, &padbyte, 1, 1);
+			rows = surface->h - y;
+			if ( rows > blockRows ) {
+				rows = blockRows;
+			}
+			if ( convert ) {
+				srect.x = 0;
+				srect.y = surface->h - y - rows;
+				srect.w = surface->w;
+				srect.h = rows;
+				drect = srect;
+				drect.y = 0;
+				if ( SDL_LowerBlit32(surface, &srect, convert,
+							&drect) < 0 ) {
+					SDL_SetError(
+					"Couldn't convert image to 24 bpp");
+					break;
 				}
+				pitch = SDL_SurfacePitch(convert);
+				bits = (Uint8 *)convert->pixels + rows * pitch;
+			} else {
+				pitch = SDL_SurfacePitch(surface);
+				bits = (Uint8 *)surface->pixels +
+				       (surface->h - y) * pitch;
+			}
+			for ( data = buffer; data < buffer + rows * rowSize;
+			      data += rowSize ) {
+				bits -= pitch;
+				SDL_memcpy(data, bits, bw);
+				if ( pad ) {
+					SDL_memset(data + bw, 0, pad);
+				}
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+				if ( biBitCount == 32 ) {
+					BMP_SwapRow(data, surface->w, 4);
+				}
+#endif
+			}
+			if ( SDL_RWwrite(dst, buffer, rowSize, rows) != rows ) {
+				SDL_Error(SDL_EFWRITE);
 			}
-		}
-
-		/* Write the BMP file size */
-		bfSize = SDL_RWtell(dst)-fp_offset;
-		if ( SDL_RWseek(dst, fp_offset+2, RW_SEEK_SET) < 0 ) {
-			SDL_Error(SDL_EFSEEK);
-		}
-		SDL_WriteLE32(dst, bfSize);
-		if ( SDL_RWseek(dst, fp_offset+bfSize, RW_SEEK_SET) < 0 ) {
-			SDL_Error(SDL_EFSEEK);
 		}
 
 		/* Close it up.. */
 		SDL_UnlockSurface(surface);
-		if ( surface != saveme ) {
-			SDL_FreeSurface(surface);
-		}
+	}
+	if ( surface_flags & SDL_SRCCOLORKEY ) {
+		SDL_SetColorKey(surface,
+			surface_flags&(SDL_SRCCOLORKEY|SDL_RLEACCELOK), colorkey);
+	}
+	if ( surface_flags & SDL_SRCALPHA ) {
+		SDL_SetAlpha(surface,
+			surface_flags&(SDL_SRCALPHA|SDL_RLEACCELOK), alpha);
+	}
+	if ( convert ) {
+		SDL_FreeSurface(convert);
+	}
+	if ( buffer ) {
+		SDL_free(buffer);
 	}
 
 	if ( freedst && dst ) {
@@ -547,3 +1100,89 @@ int SDL_SaveBMP_RW (SDL_Surface *saveme, SDL_RWops *dst, int freedst)
 	}
 	return((SDL_strcmp(SDL_GetError(), "") == 0) ? 0 : -1);
 }
+
+/* A snapshot of a surface being saved on a background thread */
+struct bmp_save {
+	SDL_Surface *surface;
+	SDL_RWops *dst;
+	int freedst;
+};
+
+static int SDLCALL BMP_SaveThread(void *data)
+{
+	struct bmp_save *save = (struct bmp_save *)data;
+	int retval;
+
+	retval = SDL_SaveBMP_RW(save->surface, save->dst, save->freedst);
+	SDL_FreeSurface(save->surface);
+	SDL_free(save);
+	return(retval);
+}
+
+SDL_Thread * SDL_SaveBMP_RW_Async (SDL_Surface *saveme, SDL_RWops *dst,
+                                   int freedst)
+{
+	struct bmp_save *save;
+	SDL_Surface *copy;
+	SDL_Thread *thread;
+	SDL_PixelFormat *fmt;
+	int y, bw;
+
+	if ( dst == NULL ) {
+		return(NULL);
+	}
+
+	/* Copy the pixels, so the application can go on drawing, and leave
+	   any conversion to the saving thread.
+	 */
+	thread = NULL;
+	save = (struct bmp_save *)SDL_malloc(sizeof(*save));
+	fmt = saveme->format;
+	copy = SDL_CreateRGBSurface(SDL_SWSURFACE, saveme->w, saveme->h,
+		fmt->BitsPerPixel, fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+	if ( (save == NULL) || (copy == NULL) ) {
+		if ( save == NULL ) {
+			SDL_OutOfMemory();
+		}
+		goto done;
+	}
+	if ( fmt->palette && copy->format->palette ) {
+		SDL_memcpy(copy->format->palette->colors, fmt->palette->colors,
+				fmt->palette->ncolors*sizeof(SDL_Color));
+		copy->format->palette->ncolors = fmt->palette->ncolors;
+	}
+	if ( SDL_LockSurface(saveme) < 0 ) {
+		goto done;
+	}
+	bw = saveme->w * fmt->BytesPerPixel;
+	for ( y = 0; y < saveme->h; ++y ) {
+		SDL_memcpy((Uint8 *)copy->pixels +
+		           (size_t)y * SDL_SurfacePitch(copy),
+		           (Uint8 *)saveme->pixels +
+		           (size_t)y * SDL_SurfacePitch(saveme), bw);
+	}
+	SDL_UnlockSurface(saveme);
+
+	save->surface = copy;
+	save->dst = dst;
+	save->freedst = freedst;
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThread
+	thread = SDL_CreateThread(BMP_SaveThread, save, NULL, NULL);
+#else
+	thread = SDL_CreateThread(BMP_SaveThread, save);
+#endif
+done:
+	if ( thread == NULL ) {
+		if ( copy ) {
+			SDL_FreeSurface(copy);
+		}
+		if ( save ) {
+			SDL_free(save);
+		}
+		if ( freedst ) {
+			SDL_RWclose(dst);
+		}
+	}
+	return(thread);
+}
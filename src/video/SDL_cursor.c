@@ -294,6 +294,7 @@ void SDL_WarpMouse (Uint16 x, Uint16 y)
 {
 	SDL_VideoDevice *video = current_video;
 	SDL_VideoDevice *this  = current_video;
+	Uint32 pitch;
 
 	if ( !video || !SDL_PublicSurface ) {
 		SDL_SetError("A video mode must be set before warping mouse");
@@ -301,13 +302,14 @@ void SDL_WarpMouse (Uint16 x, Uint16 y)
 	}
 
 	/* If we have an offset video mode, offset the mouse coordinates */
-	if (this->screen->pitch == 0) {
+	pitch = SDL_SurfacePitch(this->screen);
+	if (pitch == 0) {
 		x += this->screen->offset / this->screen->format->BytesPerPixel;
 		y += this->screen->offset;
 	} else {
-		x += (this->screen->offset % this->screen->pitch) /
+		x += (this->screen->offset % pitch) /
 		      this->screen->format->BytesPerPixel;
-		y += (this->screen->offset / this->screen->pitch);
+		y += (this->screen->offset / pitch);
 	}
 
 	/* This generates a mouse motion event */
@@ -372,9 +374,11 @@ static void SDL_DrawCursorFast(SDL_Surface *screen, SDL_Rect *area)
 {
 	const Uint32 pixels[2] = { 0xFFFFFFFF, 0x00000000 };
 	int i, w, h;
+	Uint32 pitch;
 	Uint8 *data, datab;
 	Uint8 *mask, maskb;
 
+	pitch = SDL_SurfacePitch(screen);
 	data = SDL_cursor->data + area->y * SDL_cursor->area.w/8;
 	mask = SDL_cursor->mask + area->y * SDL_cursor->area.w/8;
 	switch (screen->format->BytesPerPixel) {
@@ -389,9 +393,9 @@ static void SDL_DrawCursorFast(SDL_Surface *screen, SDL_Rect *area)
 			palette_changed = 0;
 		}
 		dst = (Uint8 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch +
+                       (size_t)(SDL_cursor->area.y+area->y)*pitch +
                        SDL_cursor->area.x;
-		dstskip = screen->pitch-area->w;
+		dstskip = pitch-area->w;
 
 		for ( h=area->h; h; h-- ) {
 			for ( w=area->w/8; w; w-- ) {
@@ -416,9 +420,9 @@ static void SDL_DrawCursorFast(SDL_Surface *screen, SDL_Rect *area)
 		int dstskip;
 
 		dst = (Uint16 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch/2 +
+                       (size_t)(SDL_cursor->area.y+area->y)*(pitch/2) +
                        SDL_cursor->area.x;
-		dstskip = (screen->pitch/2)-area->w;
+		dstskip = (pitch/2)-area->w;
 
 		for ( h=area->h; h; h-- ) {
 			for ( w=area->w/8; w; w-- ) {
@@ -443,9 +447,9 @@ static void SDL_DrawCursorFast(SDL_Surface *screen, SDL_Rect *area)
 		int dstskip;
 
 		dst = (Uint8 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch +
+                       (size_t)(SDL_cursor->area.y+area->y)*pitch +
                        SDL_cursor->area.x*3;
-		dstskip = screen->pitch-area->w*3;
+		dstskip = pitch-area->w*3;
 
 		for ( h=area->h; h; h-- ) {
 			for ( w=area->w/8; w; w-- ) {
@@ -470,9 +474,9 @@ static void SDL_DrawCursorFast(SDL_Surface *screen, SDL_Rect *area)
 		int dstskip;
 
 		dst = (Uint32 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch/4 +
+                       (size_t)(SDL_cursor->area.y+area->y)*(pitch/4) +
                        SDL_cursor->area.x;
-		dstskip = (screen->pitch/4)-area->w;
+		dstskip = (pitch/4)-area->w;
 
 		for ( h=area->h; h; h-- ) {
 			for ( w=area->w/8; w; w-- ) {
@@ -503,14 +507,16 @@ static void SDL_DrawCursorSlow(SDL_Surface *screen, SDL_Rect *area)
 	Uint8 *mask, maskb = 0;
 	Uint8 *dst;
 	int dstbpp, dstskip;
+	Uint32 pitch;
 
 	data = SDL_cursor->data + area->y * SDL_cursor->area.w/8;
 	mask = SDL_cursor->mask + area->y * SDL_cursor->area.w/8;
 	dstbpp = screen->format->BytesPerPixel;
+	pitch = SDL_SurfacePitch(screen);
 	dst = (Uint8 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch +
+                       (size_t)(SDL_cursor->area.y+area->y)*pitch +
                        SDL_cursor->area.x*dstbpp;
-	dstskip = screen->pitch-SDL_cursor->area.w*dstbpp;
+	dstskip = pitch-SDL_cursor->area.w*dstbpp;
 
 	minx = area->x;
 	maxx = area->x+area->w;
@@ -604,6 +610,7 @@ void SDL_DrawCursorNoLock(SDL_Surface *screen)
 
 	/* Copy mouse background */
 	{ int w, h, screenbpp;
+	  Uint32 pitch;
 	  Uint8 *src, *dst;
 
 	  /* Set up the copy pointers */
@@ -614,7 +621,8 @@ void SDL_DrawCursorNoLock(SDL_Surface *screen)
 	  } else {
 		dst = SDL_cursor->save[1];
 	  }
-	  src = (Uint8 *)screen->pixels + area.y * screen->pitch +
+	  pitch = SDL_SurfacePitch(screen);
+	  src = (Uint8 *)screen->pixels + (size_t)area.y * pitch +
                                           area.x * screenbpp;
 
 	  /* Perform the copy */
@@ -623,7 +631,7 @@ void SDL_DrawCursorNoLock(SDL_Surface *screen)
 	  while ( h-- ) {
 		  SDL_memcpy(dst, src, w);
 		  dst += w;
-		  src += screen->pitch;
+		  src += pitch;
 	  }
 	}
 
@@ -682,6 +690,7 @@ void SDL_EraseCursorNoLock(SDL_Surface *screen)
 
 	/* Copy mouse background */
 	{ int w, h, screenbpp;
+	  Uint32 pitch;
 	  Uint8 *src, *dst;
 
 	  /* Set up the copy pointers */
@@ -692,7 +701,8 @@ void SDL_EraseCursorNoLock(SDL_Surface *screen)
 	  } else {
 		src = SDL_cursor->save[1];
 	  }
-	  dst = (Uint8 *)screen->pixels + area.y * screen->pitch +
+	  pitch = SDL_SurfacePitch(screen);
+	  dst = (Uint8 *)screen->pixels + (size_t)area.y * pitch +
                                           area.x * screenbpp;
 
 	  /* Perform the copy */
@@ -701,7 +711,7 @@ void SDL_EraseCursorNoLock(SDL_Surface *screen)
 	  while ( h-- ) {
 		  SDL_memcpy(dst, src, w);
 		  src += w;
-		  dst += screen->pitch;
+		  dst += pitch;
 	  }
 
 	  /* Perform pixel conversion on cursor background */
@@ -288,9 +288,9 @@ void SDL_DitherColors(SDL_Color *colors, int bpp)
 /* 
  * Calculate the pad-aligned scanline width of a surface
  */
-Uint16 SDL_CalculatePitch(SDL_Surface *surface)
+Uint32 SDL_CalculatePitch(SDL_Surface *surface)
 {
-	Uint16 pitch;
+	Uint32 pitch;
 
 	/* Surface should be 4-byte aligned for speed */
 	pitch = surface->w*surface->format->BytesPerPixel;
@@ -469,12 +469,16 @@ static Uint8 *Map1toN(SDL_PixelFormat *src, SDL_PixelFormat *dst)
 	unsigned alpha;
 	SDL_Palette *pal = src->palette;
 
+	/* The blitters look up all 256 pixel values, and the vector ones
+	   in SDL_blit_1.c read 4 bytes per entry, so pad the table out.
+	 */
 	bpp = ((dst->BytesPerPixel == 3) ? 4 : dst->BytesPerPixel);
-	map = (Uint8 *)SDL_malloc(pal->ncolors*bpp);
+	map = (Uint8 *)SDL_malloc(256*bpp+4);
 	if ( map == NULL ) {
 		SDL_OutOfMemory();
 		return(NULL);
 	}
+	SDL_memset(map, 0, 256*bpp+4);
 
 	alpha = dst->Amask ? src->alpha : 0;
 	/* We memory copy to the pixel map so the endianness is preserved */
@@ -40,7 +40,13 @@ extern int SDL_MapSurface (SDL_Surface *src, SDL_Surface *dst);
 extern void SDL_FreeBlitMap(SDL_BlitMap *map);
 
 /* Miscellaneous functions */
-extern Uint16 SDL_CalculatePitch(SDL_Surface *surface);
+extern Uint32 SDL_CalculatePitch(SDL_Surface *surface);
+
+/* Rows over 65535 bytes don't fit in surface->pitch, which is 0 for them,
+   so the pitch of those surfaces is kept in unused1.
+ */
+#define SDL_SurfacePitch(surface) \
+	((surface)->unused1 ? (surface)->unused1 : (Uint32)(surface)->pitch)
 extern void SDL_DitherColors(SDL_Color *colors, int bpp);
 extern Uint8 SDL_FindColor(SDL_Palette *pal, Uint8 r, Uint8 g, Uint8 b);
 extern void SDL_ApplyGamma(Uint16 *gamma, SDL_Color *colors, SDL_Color *output, int ncolors);
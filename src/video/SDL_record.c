@@ -0,0 +1,482 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Records display updates to a stream on a background thread.
+
+   The game thread only copies the updated rectangles into a packet that
+   is already laid out the way it is written to disk, and hands it to the
+   writer thread through a queue bounded in bytes.  When the writer falls
+   behind, the game thread waits for room, or with SDL_RECORD_DROP skips
+   the frame and includes its rectangles in the next one instead.
+ */
+
+#include "SDL_video.h"
+#include "SDL_endian.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_record_c.h"
+#include "SDL_pixels_c.h"
+
+/* The default queue size, in kilobytes */
+#define RECORD_QUEUE_KB	16384
+
+typedef struct SDL_RecordPacket {
+	struct SDL_RecordPacket *next;
+	Uint32 size;
+} SDL_RecordPacket;
+
+#define PACKET_DATA(packet)	((Uint8 *)((packet) + 1))
+
+typedef struct SDL_Recorder {
+	SDL_RWops *dst;
+	int freedst;
+	Uint32 flags;
+
+	/* Shared with the writer thread */
+	SDL_mutex *lock;
+	SDL_cond *cond;
+	SDL_Thread *thread;
+	SDL_RecordPacket *head;
+	SDL_RecordPacket *tail;
+	Uint32 queued;
+	Uint32 queue_max;
+	int quit;
+	int error;
+
+	/* Game thread state: the mode and palette last written */
+	int have_mode;
+	int w, h;
+	Uint32 mode[9];
+	int ncolors;
+	SDL_Color colors[256];
+
+	/* Bounding box of the rectangles of dropped frames */
+	int dropped;
+	int drop_x1, drop_y1, drop_x2, drop_y2;
+
+	Uint32 frames;
+	Uint32 dropped_frames;
+	Uint32 waits;
+} SDL_Recorder;
+
+static SDL_Recorder *SDL_recorder = NULL;
+static int SDL_record_env_started = 0;
+
+static int SDLCALL SDL_RecordThread(void *data)
+{
+	SDL_Recorder *rec = (SDL_Recorder *)data;
+	SDL_RecordPacket *packet;
+
+	for ( ; ; ) {
+		SDL_mutexP(rec->lock);
+		while ( !rec->head && !rec->quit ) {
+			SDL_CondWait(rec->cond, rec->lock);
+		}
+		packet = rec->head;
+		if ( packet ) {
+			rec->head = packet->next;
+			if ( !rec->head ) {
+				rec->tail = NULL;
+			}
+		}
+		SDL_mutexV(rec->lock);
+		if ( !packet ) {
+			break;
+		}
+
+		if ( !rec->error &&
+		     SDL_RWwrite(rec->dst, PACKET_DATA(packet), packet->size, 1) != 1 ) {
+			rec->error = 1;
+		}
+
+		SDL_mutexP(rec->lock);
+		rec->queued -= packet->size;
+		SDL_CondBroadcast(rec->cond);
+		SDL_mutexV(rec->lock);
+		SDL_free(packet);
+	}
+	return(0);
+}
+
+static void SDL_FreeRecorder(SDL_Recorder *rec)
+{
+	SDL_RecordPacket *packet;
+
+	while ( rec->head ) {
+		packet = rec->head;
+		rec->head = packet->next;
+		SDL_free(packet);
+	}
+	if ( rec->cond ) {
+		SDL_DestroyCond(rec->cond);
+	}
+	if ( rec->lock ) {
+		SDL_DestroyMutex(rec->lock);
+	}
+	if ( rec->freedst && rec->dst ) {
+		SDL_RWclose(rec->dst);
+	}
+	SDL_free(rec);
+}
+
+int SDL_StartRecording_RW(SDL_RWops *dst, int freedst, Uint32 flags)
+{
+	SDL_Recorder *rec;
+	const char *envr;
+
+	if ( dst == NULL ) {
+		return(-1);
+	}
+	if ( SDL_recorder ) {
+		SDL_SetError("Already recording");
+		if ( freedst ) {
+			SDL_RWclose(dst);
+		}
+		return(-1);
+	}
+
+	rec = (SDL_Recorder *)SDL_malloc(sizeof(*rec));
+	if ( rec == NULL ) {
+		SDL_OutOfMemory();
+		if ( freedst ) {
+			SDL_RWclose(dst);
+		}
+		return(-1);
+	}
+	SDL_memset(rec, 0, sizeof(*rec));
+	rec->dst = dst;
+	rec->freedst = freedst;
+	rec->flags = flags;
+	rec->queue_max = RECORD_QUEUE_KB * 1024;
+	envr = SDL_getenv("SDL_VIDEO_RECORD_QUEUE");
+	if ( envr && (SDL_atoi(envr) > 0) ) {
+		rec->queue_max = (Uint32)SDL_atoi(envr) * 1024;
+	}
+
+	if ( !SDL_WriteLE32(dst, SDL_RECORD_MAGIC) ||
+	     !SDL_WriteLE32(dst, SDL_RECORD_VERSION) ) {
+		SDL_Error(SDL_EFWRITE);
+		SDL_FreeRecorder(rec);
+		return(-1);
+	}
+
+	rec->lock = SDL_CreateMutex();
+	rec->cond = SDL_CreateCond();
+	if ( !rec->lock || !rec->cond ) {
+		SDL_FreeRecorder(rec);
+		return(-1);
+	}
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThread
+	rec->thread = SDL_CreateThread(SDL_RecordThread, rec, NULL, NULL);
+#else
+	rec->thread = SDL_CreateThread(SDL_RecordThread, rec);
+#endif
+	if ( !rec->thread ) {
+		SDL_FreeRecorder(rec);
+		return(-1);
+	}
+	SDL_recorder = rec;
+	return(0);
+}
+
+int SDL_StopRecording(void)
+{
+	SDL_Recorder *rec = SDL_recorder;
+	int retval = 0;
+
+	if ( !rec ) {
+		return(0);
+	}
+	SDL_recorder = NULL;
+
+	SDL_mutexP(rec->lock);
+	rec->quit = 1;
+	SDL_CondBroadcast(rec->cond);
+	SDL_mutexV(rec->lock);
+	SDL_WaitThread(rec->thread, NULL);
+
+	if ( rec->error ) {
+		SDL_Error(SDL_EFWRITE);
+		retval = -1;
+	}
+	SDL_FreeRecorder(rec);
+	return(retval);
+}
+
+int SDL_GetRecordingStats(Uint32 *frames, Uint32 *dropped, Uint32 *waits)
+{
+	SDL_Recorder *rec = SDL_recorder;
+
+	if ( !rec ) {
+		SDL_SetError("Not recording");
+		return(-1);
+	}
+	if ( frames ) {
+		*frames = rec->frames;
+	}
+	if ( dropped ) {
+		*dropped = rec->dropped_frames;
+	}
+	if ( waits ) {
+		*waits = rec->waits;
+	}
+	return(0);
+}
+
+static Uint8 *SDL_RecordWord(Uint8 *data, Uint32 value)
+{
+	value = SDL_SwapLE32(value);
+	SDL_memcpy(data, &value, 4);
+	return(data + 4);
+}
+
+/* Grow the bounding box of the frames that were dropped */
+static void SDL_RecordDrop(SDL_Recorder *rec, int numrects, SDL_Rect *rects)
+{
+	int i;
+
+	for ( i = 0; i < numrects; ++i ) {
+		int x2 = rects[i].x + rects[i].w;
+		int y2 = rects[i].y + rects[i].h;
+
+		if ( !rec->dropped ) {
+			rec->drop_x1 = rects[i].x;
+			rec->drop_y1 = rects[i].y;
+			rec->drop_x2 = x2;
+			rec->drop_y2 = y2;
+			rec->dropped = 1;
+			continue;
+		}
+		if ( rects[i].x < rec->drop_x1 ) rec->drop_x1 = rects[i].x;
+		if ( rects[i].y < rec->drop_y1 ) rec->drop_y1 = rects[i].y;
+		if ( x2 > rec->drop_x2 ) rec->drop_x2 = x2;
+		if ( y2 > rec->drop_y2 ) rec->drop_y2 = y2;
+	}
+}
+
+void SDL_RecordUpdate(SDL_Surface *screen, int numrects, SDL_Rect *rects)
+{
+	SDL_Recorder *rec = SDL_recorder;
+	SDL_PixelFormat *format;
+	SDL_RecordPacket *packet;
+	SDL_Rect *clipped;
+	Uint32 mode[9];
+	Uint32 size;
+	int new_mode, new_palette;
+	int i, n, y, bpp;
+	Uint8 *data;
+
+	if ( !rec || (numrects <= 0) ) {
+		return;
+	}
+	format = screen->format;
+	bpp = format->BytesPerPixel;
+
+	mode[0] = screen->w;
+	mode[1] = screen->h;
+	mode[2] = bpp;
+	mode[3] = format->BitsPerPixel;
+	mode[4] = format->Rmask;
+	mode[5] = format->Gmask;
+	mode[6] = format->Bmask;
+	mode[7] = format->Amask;
+	mode[8] = (SDL_BYTEORDER == SDL_BIG_ENDIAN);
+	new_mode = !rec->have_mode ||
+	           (SDL_memcmp(mode, rec->mode, sizeof(mode)) != 0);
+	new_palette = format->palette &&
+	              (new_mode || (format->palette->ncolors != rec->ncolors) ||
+	               SDL_memcmp(format->palette->colors, rec->colors,
+	                          rec->ncolors * sizeof(SDL_Color)) != 0);
+
+	/* Clip the rectangles, adding the ones of any dropped frames */
+	clipped = (SDL_Rect *)SDL_stack_alloc(SDL_Rect, numrects + 1);
+	if ( !clipped ) {
+		return;
+	}
+	n = 0;
+	if ( new_mode ) {
+		clipped[n].x = 0;
+		clipped[n].y = 0;
+		clipped[n].w = screen->w;
+		clipped[n].h = screen->h;
+		++n;
+	} else {
+		for ( i = 0; i <= numrects; ++i ) {
+			int x1, y1, x2, y2;
+
+			if ( i < numrects ) {
+				x1 = rects[i].x;
+				y1 = rects[i].y;
+				x2 = x1 + rects[i].w;
+				y2 = y1 + rects[i].h;
+			} else if ( rec->dropped ) {
+				x1 = rec->drop_x1;
+				y1 = rec->drop_y1;
+				x2 = rec->drop_x2;
+				y2 = rec->drop_y2;
+			} else {
+				break;
+			}
+			if ( x1 < 0 ) x1 = 0;
+			if ( y1 < 0 ) y1 = 0;
+			if ( x2 > screen->w ) x2 = screen->w;
+			if ( y2 > screen->h ) y2 = screen->h;
+			if ( (x2 <= x1) || (y2 <= y1) ) {
+				continue;
+			}
+			clipped[n].x = x1;
+			clipped[n].y = y1;
+			clipped[n].w = x2 - x1;
+			clipped[n].h = y2 - y1;
+			++n;
+		}
+	}
+
+	size = 5*4;
+	if ( new_mode ) {
+		size += 2*4 + sizeof(mode);
+	}
+	if ( new_palette ) {
+		size += 3*4 + format->palette->ncolors * 4;
+	}
+	for ( i = 0; i < n; ++i ) {
+		size += 4*4 + (Uint32)clipped[i].w * clipped[i].h * bpp;
+	}
+
+	/* Wait for room in the queue, or drop the frame */
+	SDL_mutexP(rec->lock);
+	if ( rec->queued && (rec->queued + size > rec->queue_max) ) {
+		if ( rec->flags & SDL_RECORD_DROP ) {
+			SDL_mutexV(rec->lock);
+			SDL_RecordDrop(rec, n, clipped);
+			++rec->dropped_frames;
+			SDL_stack_free(clipped);
+			return;
+		}
+		++rec->waits;
+		while ( rec->queued && (rec->queued + size > rec->queue_max) ) {
+			SDL_CondWait(rec->cond, rec->lock);
+		}
+	}
+	rec->queued += size;
+	SDL_mutexV(rec->lock);
+
+	packet = (SDL_RecordPacket *)SDL_malloc(sizeof(*packet) + size);
+	if ( !packet || (SDL_LockSurface(screen) < 0) ) {
+		SDL_mutexP(rec->lock);
+		rec->queued -= size;
+		SDL_mutexV(rec->lock);
+		SDL_free(packet);
+		SDL_RecordDrop(rec, n, clipped);
+		++rec->dropped_frames;
+		SDL_stack_free(clipped);
+		return;
+	}
+	packet->next = NULL;
+	packet->size = size;
+
+	data = PACKET_DATA(packet);
+	if ( new_mode ) {
+		data = SDL_RecordWord(data, SDL_RECORD_MODE);
+		data = SDL_RecordWord(data, sizeof(mode));
+		for ( i = 0; i < SDL_arraysize(mode); ++i ) {
+			data = SDL_RecordWord(data, mode[i]);
+		}
+		SDL_memcpy(rec->mode, mode, sizeof(mode));
+		rec->have_mode = 1;
+	}
+	if ( new_palette ) {
+		SDL_Palette *pal = format->palette;
+
+		data = SDL_RecordWord(data, SDL_RECORD_PALETTE);
+		data = SDL_RecordWord(data, 4 + pal->ncolors * 4);
+		data = SDL_RecordWord(data, pal->ncolors);
+		for ( i = 0; i < pal->ncolors; ++i ) {
+			*data++ = pal->colors[i].r;
+			*data++ = pal->colors[i].g;
+			*data++ = pal->colors[i].b;
+			*data++ = 0;
+		}
+		rec->ncolors = pal->ncolors;
+		SDL_memcpy(rec->colors, pal->colors,
+		           pal->ncolors * sizeof(SDL_Color));
+	}
+	data = SDL_RecordWord(data, SDL_RECORD_FRAME);
+	data = SDL_RecordWord(data, size - (data + 4 - PACKET_DATA(packet)));
+	data = SDL_RecordWord(data, ++rec->frames + rec->dropped_frames);
+	data = SDL_RecordWord(data, SDL_GetTicks());
+	data = SDL_RecordWord(data, n);
+	for ( i = 0; i < n; ++i ) {
+		int rowlen = clipped[i].w * bpp;
+		Uint8 *src = (Uint8 *)screen->pixels +
+		             (size_t)clipped[i].y * SDL_SurfacePitch(screen) +
+		             clipped[i].x * bpp;
+
+		data = SDL_RecordWord(data, clipped[i].x);
+		data = SDL_RecordWord(data, clipped[i].y);
+		data = SDL_RecordWord(data, clipped[i].w);
+		data = SDL_RecordWord(data, clipped[i].h);
+		for ( y = clipped[i].h; y--; ) {
+			SDL_memcpy(data, src, rowlen);
+			src += SDL_SurfacePitch(screen);
+			data += rowlen;
+		}
+	}
+	SDL_UnlockSurface(screen);
+	SDL_stack_free(clipped);
+	rec->dropped = 0;
+
+	SDL_mutexP(rec->lock);
+	if ( rec->tail ) {
+		rec->tail->next = packet;
+	} else {
+		rec->head = packet;
+	}
+	rec->tail = packet;
+	SDL_CondBroadcast(rec->cond);
+	SDL_mutexV(rec->lock);
+}
+
+void SDL_RecordVideoMode(void)
+{
+	const char *file = SDL_getenv("SDL_VIDEO_RECORD");
+	const char *envr;
+	Uint32 flags = 0;
+
+	if ( !file || !*file || SDL_recorder || SDL_record_env_started ) {
+		return;
+	}
+	envr = SDL_getenv("SDL_VIDEO_RECORD_DROP");
+	if ( envr && SDL_atoi(envr) ) {
+		flags |= SDL_RECORD_DROP;
+	}
+	SDL_record_env_started = 1;
+	SDL_StartRecording_RW(SDL_RWFromFile(file, "wb"), 1, flags);
+}
+
+void SDL_RecordQuit(void)
+{
+	SDL_StopRecording();
+	SDL_record_env_started = 0;
+}
@@ -0,0 +1,54 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Session recording of the display, see SDL_StartRecording_RW()
+
+   The stream is a sequence of little endian 32-bit words:
+	"SDLR" magic, format version (1)
+   followed by chunks, each a 32-bit id, a 32-bit payload length and the
+   payload:
+	"MODE"	width, height, bytes per pixel, bits per pixel,
+		Rmask, Gmask, Bmask, Amask, big endian pixels (0 or 1)
+	"PALT"	number of colors, then r, g, b, unused bytes per color
+	"FRAM"	frame number, counting dropped frames, SDL_GetTicks(),
+		number of rectangles, then
+		for each rectangle x, y, w, h and its w*h pixels, packed
+		without padding in the byte order given by "MODE"
+   A "MODE" chunk is always followed by a frame covering the whole screen,
+   every later frame only holds the rectangles that changed.
+ */
+
+#define SDL_RECORD_MAGIC	0x524C4453	/* "SDLR" */
+#define SDL_RECORD_VERSION	1
+#define SDL_RECORD_MODE		0x45444F4D	/* "MODE" */
+#define SDL_RECORD_PALETTE	0x544C4150	/* "PALT" */
+#define SDL_RECORD_FRAME	0x4D415246	/* "FRAM" */
+
+/* Snapshot the given rectangles of the display surface, if recording */
+extern void SDL_RecordUpdate(SDL_Surface *screen, int numrects, SDL_Rect *rects);
+
+/* Start recording to SDL_VIDEO_RECORD, if set, after a video mode change */
+extern void SDL_RecordVideoMode(void);
+
+/* Stop recording when the video subsystem shuts down */
+extern void SDL_RecordQuit(void);
@@ -29,6 +29,7 @@
 
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "SDL_pixels_c.h"
 
 /* This isn't ready for general consumption yet - it should be folded
    into the general blitting mechanism.
@@ -207,6 +208,7 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 	int pos, inc;
 	int dst_maxrow;
 	int src_row, dst_row;
+	size_t srcpitch, dstpitch;
 	Uint8 *srcp = NULL;
 	Uint8 *dstp;
 	SDL_Rect full_src;
@@ -279,6 +281,8 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 	/* Set up the data... */
 	pos = 0x10000;
 	inc = (srcrect->h << 16) / dstrect->h;
+	srcpitch = SDL_SurfacePitch(src);
+	dstpitch = SDL_SurfacePitch(dst);
 	src_row = srcrect->y;
 	dst_row = dstrect->y;
 
@@ -292,10 +296,10 @@ int SDL_SoftStretch(SDL_Surface *src, SDL_Rect *srcrect,
 
 	/* Perform the stretch blit */
 	for ( dst_maxrow = dst_row+dstrect->h; dst_row<dst_maxrow; ++dst_row ) {
-		dstp = (Uint8 *)dst->pixels + (dst_row*dst->pitch)
+		dstp = (Uint8 *)dst->pixels + (dst_row*dstpitch)
 		                            + (dstrect->x*bpp);
 		while ( pos >= 0x10000L ) {
-			srcp = (Uint8 *)src->pixels + (src_row*src->pitch)
+			srcp = (Uint8 *)src->pixels + (src_row*srcpitch)
 			                            + (srcrect->x*bpp);
 			++src_row;
 			pos -= 0x10000L;
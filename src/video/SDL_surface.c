@@ -30,6 +30,20 @@
 #include "SDL_leaks.h"
 
 
+/* Set the pitch of a surface, which for rows over 65535 bytes doesn't
+   fit in surface->pitch and goes in unused1 (see SDL_SurfacePitch())
+ */
+static void SDL_SetPitch(SDL_Surface *surface, Uint32 pitch)
+{
+	if ( pitch > 0xFFFF ) {
+		surface->pitch = 0;
+		surface->unused1 = pitch;
+	} else {
+		surface->pitch = (Uint16)pitch;
+		surface->unused1 = 0;
+	}
+}
+
 /* Public routines */
 /*
  * Create an empty RGB surface of the appropriate depth
@@ -45,7 +59,8 @@ SDL_Surface * SDL_CreateRGBSurface (Uint32 flags,
 
 	/* Make sure the size requested doesn't overflow our datatypes */
 	/* Next time I write a library like SDL, I'll use int for size. :) */
-	if ( width >= 16384 || height >= 65536 ) {
+	if ( width < 0 || height < 0 ||
+	     width >= 0x1000000 || height >= 0x1000000 ) {
 		SDL_SetError("Width or height is too large");
 		return(NULL);
 	}
@@ -109,40 +124,46 @@ SDL_Surface * SDL_CreateRGBSurface (Uint32 flags,
 	}
 	surface->w = width;
 	surface->h = height;
-	surface->pitch = SDL_CalculatePitch(surface);
+	SDL_SetPitch(surface, SDL_CalculatePitch(surface));
 	surface->pixels = NULL;
 	surface->offset = 0;
 	surface->hwdata = NULL;
 	surface->locked = 0;
-	surface->map = NULL;
-	surface->unused1 = 0;
+	surface->refcount = 1;
+
+	/* Allocate an empty mapping, which holds the clip rectangle */
+	surface->map = SDL_AllocBlitMap();
+	if ( surface->map == NULL ) {
+		SDL_FreeSurface(surface);
+		return(NULL);
+	}
 	SDL_SetClipRect(surface, NULL);
 	SDL_FormatChanged(surface);
 
+	/* The pixels can't be more than 2 GB */
+	if ( height && SDL_GetSurfacePitch(surface) > 0x7FFFFFFF/height ) {
+		SDL_FreeSurface(surface);
+		SDL_SetError("Width or height is too large");
+		return(NULL);
+	}
+
 	/* Get the pixels */
 	if ( ((flags&SDL_HWSURFACE) == SDL_SWSURFACE) || 
 				(video->AllocHWSurface(this, surface) < 0) ) {
 		if ( surface->w && surface->h ) {
-			surface->pixels = SDL_malloc(surface->h*surface->pitch);
+			size_t size = (size_t)surface->h*SDL_GetSurfacePitch(surface);
+			surface->pixels = SDL_malloc(size);
 			if ( surface->pixels == NULL ) {
 				SDL_FreeSurface(surface);
 				SDL_OutOfMemory();
 				return(NULL);
 			}
 			/* This is important for bitmaps */
-			SDL_memset(surface->pixels, 0, surface->h*surface->pitch);
+			SDL_memset(surface->pixels, 0, size);
 		}
 	}
 
-	/* Allocate an empty mapping */
-	surface->map = SDL_AllocBlitMap();
-	if ( surface->map == NULL ) {
-		SDL_FreeSurface(surface);
-		return(NULL);
-	}
-
 	/* The surface is ready to go */
-	surface->refcount = 1;
 #ifdef CHECK_LEAKS
 	++surfaces_allocated;
 #endif
@@ -164,11 +185,15 @@ SDL_Surface * SDL_CreateRGBSurfaceFrom (void *pixels,
 		surface->pixels = pixels;
 		surface->w = width;
 		surface->h = height;
-		surface->pitch = pitch;
+		SDL_SetPitch(surface, pitch);
 		SDL_SetClipRect(surface, NULL);
 	}
 	return(surface);
 }
+Uint32 SDL_GetSurfacePitch(SDL_Surface *surface)
+{
+	return SDL_SurfacePitch(surface);
+}
 /*
  * Set the color key in a blittable surface
  */
@@ -315,7 +340,8 @@ int SDL_SetAlphaChannel(SDL_Surface *surface, Uint8 value)
 	row = surface->h;
 	while (row--) {
 		col = surface->w;
-		buf = (Uint8 *)surface->pixels + row * surface->pitch + offset;
+		buf = (Uint8 *)surface->pixels +
+			(size_t)row * SDL_SurfacePitch(surface) + offset;
 		while(col--) {
 			*buf = value;
 			buf += 4;
@@ -362,12 +388,62 @@ SDL_bool SDL_IntersectRect(const SDL_Rect *A, const SDL_Rect *B, SDL_Rect *inter
 
 	return (intersection->w && intersection->h);
 }
+/* SDL_IntersectRect() for 32-bit rectangles */
+static SDL_bool SDL_IntersectRect32(const SDL_Rect32 *A, const SDL_Rect32 *B, SDL_Rect32 *intersection)
+{
+	Sint32 Amin, Amax, Bmin, Bmax;
+
+	/* Horizontal intersection */
+	Amin = A->x;
+	Amax = Amin + A->w;
+	Bmin = B->x;
+	Bmax = Bmin + B->w;
+	if(Bmin > Amin)
+	        Amin = Bmin;
+	intersection->x = Amin;
+	if(Bmax < Amax)
+	        Amax = Bmax;
+	intersection->w = Amax - Amin > 0 ? Amax - Amin : 0;
+
+	/* Vertical intersection */
+	Amin = A->y;
+	Amax = Amin + A->h;
+	Bmin = B->y;
+	Bmax = Bmin + B->h;
+	if(Bmin > Amin)
+	        Amin = Bmin;
+	intersection->y = Amin;
+	if(Bmax < Amax)
+	        Amax = Bmax;
+	intersection->h = Amax - Amin > 0 ? Amax - Amin : 0;
+
+	return (intersection->w && intersection->h);
+}
+static void SDL_Rect16To32(const SDL_Rect *rect, SDL_Rect32 *rect32)
+{
+	rect32->x = rect->x;
+	rect32->y = rect->y;
+	rect32->w = rect->w;
+	rect32->h = rect->h;
+}
+/* Returns 0 if the rectangle doesn't fit in an SDL_Rect */
+static int SDL_Rect32To16(const SDL_Rect32 *rect32, SDL_Rect *rect)
+{
+	rect->x = (Sint16)rect32->x;
+	rect->y = (Sint16)rect32->y;
+	rect->w = (Uint16)rect32->w;
+	rect->h = (Uint16)rect32->h;
+	return (rect->x == rect32->x && rect->y == rect32->y &&
+	        rect->w == rect32->w && rect->h == rect32->h);
+}
 /*
  * Set the clipping rectangle for a blittable surface
  */
-SDL_bool SDL_SetClipRect(SDL_Surface *surface, const SDL_Rect *rect)
+SDL_bool SDL_SetClipRect32(SDL_Surface *surface, const SDL_Rect32 *rect)
 {
-	SDL_Rect full_rect;
+	SDL_Rect32 full_rect;
+	SDL_Rect32 *clip;
+	SDL_bool result = SDL_TRUE;
 
 	/* Don't do anything if there's no surface to act on */
 	if ( ! surface ) {
@@ -381,11 +457,35 @@ SDL_bool SDL_SetClipRect(SDL_Surface *surface, const SDL_Rect *rect)
 	full_rect.h = surface->h;
 
 	/* Set the clipping rectangle */
+	clip = &surface->map->clip_rect;
+	if ( ! rect ) {
+		*clip = full_rect;
+	} else {
+		result = SDL_IntersectRect32(rect, &full_rect, clip);
+	}
+
+	/* Keep as much of it as SDL_Rect can hold in surface->clip_rect */
+	surface->clip_rect.x = (Sint16)SDL_min(clip->x, 32767);
+	surface->clip_rect.y = (Sint16)SDL_min(clip->y, 32767);
+	surface->clip_rect.w = (Uint16)SDL_min(clip->w, 65535);
+	surface->clip_rect.h = (Uint16)SDL_min(clip->h, 65535);
+	return result;
+}
+SDL_bool SDL_SetClipRect(SDL_Surface *surface, const SDL_Rect *rect)
+{
+	SDL_Rect32 rect32;
+
 	if ( ! rect ) {
-		surface->clip_rect = full_rect;
-		return 1;
+		return SDL_SetClipRect32(surface, NULL);
+	}
+	SDL_Rect16To32(rect, &rect32);
+	return SDL_SetClipRect32(surface, &rect32);
+}
+void SDL_GetClipRect32(SDL_Surface *surface, SDL_Rect32 *rect)
+{
+	if ( surface && rect ) {
+		*rect = surface->map->clip_rect;
 	}
-	return SDL_IntersectRect(rect, &full_rect, &surface->clip_rect);
 }
 void SDL_GetClipRect(SDL_Surface *surface, SDL_Rect *rect)
 {
@@ -441,10 +541,39 @@ int SDL_LowerBlit (SDL_Surface *src, SDL_Rect *srcrect,
 }
 
 
-int SDL_UpperBlit (SDL_Surface *src, SDL_Rect *srcrect,
-		   SDL_Surface *dst, SDL_Rect *dstrect)
+int SDL_LowerBlit32 (SDL_Surface *src, SDL_Rect32 *srcrect,
+				SDL_Surface *dst, SDL_Rect32 *dstrect)
 {
-        SDL_Rect fulldst;
+	SDL_Rect sr, dr;
+
+	/* Check to make sure the blit mapping is valid */
+	if ( (src->map->dst != dst) ||
+             (src->map->dst->format_version != src->map->format_version) ) {
+		if ( SDL_MapSurface(src, dst) < 0 ) {
+			return(-1);
+		}
+	}
+
+	/* Software blits can take the rectangles as they are */
+	if ( ((src->flags & SDL_HWACCEL) != SDL_HWACCEL) &&
+	     (src->map->sw_blit == SDL_SoftBlit) ) {
+		return(SDL_SoftBlit32(src, srcrect, dst, dstrect));
+	}
+
+	/* Hardware and RLE blits are only set up for surfaces small enough
+	   for SDL_Rect, so this only fails if the rectangles are bad */
+	if ( ! SDL_Rect32To16(srcrect, &sr) || ! SDL_Rect32To16(dstrect, &dr) ) {
+		SDL_SetError("Blit rectangle is out of range");
+		return(-1);
+	}
+	return(SDL_LowerBlit(src, &sr, dst, &dr));
+}
+
+
+int SDL_UpperBlit32 (SDL_Surface *src, SDL_Rect32 *srcrect,
+		   SDL_Surface *dst, SDL_Rect32 *dstrect)
+{
+        SDL_Rect32 fulldst;
 	int srcx, srcy, w, h;
 
 	/* Make sure the surfaces aren't locked */
@@ -497,7 +626,7 @@ int SDL_UpperBlit (SDL_Surface *src, SDL_Rect *srcrect,
 
 	/* clip the destination rectangle against the clip rectangle */
 	{
-	        SDL_Rect *clip = &dst->clip_rect;
+	        SDL_Rect32 *clip = &dst->map->clip_rect;
 		int dx, dy;
 
 		dx = clip->x - dstrect->x;
@@ -522,25 +651,45 @@ int SDL_UpperBlit (SDL_Surface *src, SDL_Rect *srcrect,
 	}
 
 	if(w > 0 && h > 0) {
-	        SDL_Rect sr;
+	        SDL_Rect32 sr;
 	        sr.x = srcx;
 		sr.y = srcy;
 		sr.w = dstrect->w = w;
 		sr.h = dstrect->h = h;
-		return SDL_LowerBlit(src, &sr, dst, dstrect);
+		return SDL_LowerBlit32(src, &sr, dst, dstrect);
 	}
 	dstrect->w = dstrect->h = 0;
 	return 0;
 }
 
-static int SDL_FillRect1(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
+int SDL_UpperBlit (SDL_Surface *src, SDL_Rect *srcrect,
+		   SDL_Surface *dst, SDL_Rect *dstrect)
+{
+	SDL_Rect32 sr, dr;
+	int retval;
+
+	if ( srcrect ) {
+		SDL_Rect16To32(srcrect, &sr);
+	}
+	if ( dstrect ) {
+		SDL_Rect16To32(dstrect, &dr);
+	}
+	retval = SDL_UpperBlit32(src, srcrect ? &sr : NULL,
+	                         dst, dstrect ? &dr : NULL);
+	if ( dstrect ) {
+		SDL_Rect32To16(&dr, dstrect);
+	}
+	return retval;
+}
+
+static int SDL_FillRect1(SDL_Surface *dst, SDL_Rect32 *dstrect, Uint32 color)
 {
 	/* FIXME: We have to worry about packing order.. *sigh* */
 	SDL_SetError("1-bpp rect fill not yet implemented");
 	return -1;
 }
 
-static int SDL_FillRect4(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
+static int SDL_FillRect4(SDL_Surface *dst, SDL_Rect32 *dstrect, Uint32 color)
 {
 	/* FIXME: We have to worry about packing order.. *sigh* */
 	SDL_SetError("4-bpp rect fill not yet implemented");
@@ -550,12 +699,13 @@ static int SDL_FillRect4(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 /* 
  * This function performs a fast fill of the given rectangle with 'color'
  */
-int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
+int SDL_FillRect32(SDL_Surface *dst, SDL_Rect32 *dstrect, Uint32 color)
 {
 	SDL_VideoDevice *video = current_video;
 	SDL_VideoDevice *this  = current_video;
 	int x, y;
 	Uint8 *row;
+	Uint32 pitch;
 
 	/* This function doesn't work on surfaces < 8 bpp */
 	if ( dst->format->BitsPerPixel < 8 ) {
@@ -576,39 +726,42 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 	/* If 'dstrect' == NULL, then fill the whole surface */
 	if ( dstrect ) {
 		/* Perform clipping */
-		if ( !SDL_IntersectRect(dstrect, &dst->clip_rect, dstrect) ) {
+		if ( !SDL_IntersectRect32(dstrect, &dst->map->clip_rect, dstrect) ) {
 			return(0);
 		}
 	} else {
-		dstrect = &dst->clip_rect;
+		dstrect = &dst->map->clip_rect;
+		if ( !dstrect->w || !dstrect->h ) {
+			return(0);
+		}
 	}
 
 	/* Check for hardware acceleration */
 	if ( ((dst->flags & SDL_HWSURFACE) == SDL_HWSURFACE) &&
 					video->info.blit_fill ) {
 		SDL_Rect hw_rect;
+		SDL_Rect32To16(dstrect, &hw_rect);
 		if ( dst == SDL_VideoSurface ) {
-			hw_rect = *dstrect;
 			hw_rect.x += current_video->offset_x;
 			hw_rect.y += current_video->offset_y;
-			dstrect = &hw_rect;
 		}
-		return(video->FillHWRect(this, dst, dstrect, color));
+		return(video->FillHWRect(this, dst, &hw_rect, color));
 	}
 
 	/* Perform software fill */
 	if ( SDL_LockSurface(dst) != 0 ) {
 		return(-1);
 	}
-	row = (Uint8 *)dst->pixels+dstrect->y*dst->pitch+
-			dstrect->x*dst->format->BytesPerPixel;
+	pitch = SDL_SurfacePitch(dst);
+	row = (Uint8 *)dst->pixels+(size_t)dstrect->y*pitch+
+			(size_t)dstrect->x*dst->format->BytesPerPixel;
 	if ( dst->format->palette || (color == 0) ) {
 		x = dstrect->w*dst->format->BytesPerPixel;
-		if ( !color && !((uintptr_t)row&3) && !(x&3) && !(dst->pitch&3) ) {
+		if ( !color && !((uintptr_t)row&3) && !(x&3) && !(pitch&3) ) {
 			int n = x >> 2;
 			for ( y=dstrect->h; y; --y ) {
 				SDL_memset4(row, 0, n);
-				row += dst->pitch;
+				row += pitch;
 			}
 		} else {
 #ifdef __powerpc__
@@ -658,7 +811,7 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 							*d++ = c;
 							n--;
 						}
-						row += dst->pitch;
+						row += pitch;
 					}
 				} else {
 					/* narrow boxes */
@@ -670,7 +823,7 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 							*d++ = c;
 							n--;
 						}
-						row += dst->pitch;
+						row += pitch;
 					}
 				}
 			} else
@@ -678,7 +831,7 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 			{
 				for(y = dstrect->h; y; y--) {
 					SDL_memset(row, color, x);
-					row += dst->pitch;
+					row += pitch;
 				}
 			}
 		}
@@ -698,7 +851,7 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 					SDL_memset4(pixels, cc, n >> 1);
 				if(n & 1)
 					pixels[n - 1] = c;
-				row += dst->pitch;
+				row += pitch;
 			}
 			break;
 
@@ -712,14 +865,14 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 					SDL_memcpy(pixels, &color, 3);
 					pixels += 3;
 				}
-				row += dst->pitch;
+				row += pitch;
 			}
 			break;
 
 		    case 4:
 			for(y = dstrect->h; y; --y) {
 				SDL_memset4(row, color, dstrect->w);
-				row += dst->pitch;
+				row += pitch;
 			}
 			break;
 		}
@@ -729,6 +882,19 @@ int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
 	/* We're done! */
 	return(0);
 }
+int SDL_FillRect(SDL_Surface *dst, SDL_Rect *dstrect, Uint32 color)
+{
+	SDL_Rect32 rect;
+	int retval;
+
+	if ( ! dstrect ) {
+		return SDL_FillRect32(dst, NULL, color);
+	}
+	SDL_Rect16To32(dstrect, &rect);
+	retval = SDL_FillRect32(dst, &rect, color);
+	SDL_Rect32To16(&rect, dstrect);
+	return retval;
+}
 
 /*
  * Lock a surface to directly access the pixels
@@ -795,7 +961,7 @@ SDL_Surface * SDL_ConvertSurface (SDL_Surface *surface,
 	Uint32 colorkey = 0;
 	Uint8 alpha = 0;
 	Uint32 surface_flags;
-	SDL_Rect bounds;
+	SDL_Rect32 bounds;
 
 	/* Check for empty destination palette! (results in empty image) */
 	if ( format->palette != NULL ) {
@@ -863,11 +1029,11 @@ SDL_Surface * SDL_ConvertSurface (SDL_Surface *surface,
 	bounds.y = 0;
 	bounds.w = surface->w;
 	bounds.h = surface->h;
-	SDL_LowerBlit(surface, &bounds, convert, &bounds);
+	SDL_LowerBlit32(surface, &bounds, convert, &bounds);
 
 	/* Clean up the original surface, and update converted surface */
 	if ( convert != NULL ) {
-		SDL_SetClipRect(convert, &surface->clip_rect);
+		SDL_SetClipRect32(convert, &surface->map->clip_rect);
 	}
 	if ( (surface_flags & SDL_SRCCOLORKEY) == SDL_SRCCOLORKEY ) {
 		Uint32 cflags = surface_flags&(SDL_SRCCOLORKEY|SDL_RLEACCELOK);
@@ -0,0 +1,399 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/*
+   Code to save surfaces that are ready to blit to the display, and load
+   them back without any decoding or conversion.
+
+   A cache file is only meant to be read on the machine that wrote it:
+   everything is stored in native byte order, and the file records the
+   display format the surface was prepared for.  The layout is:
+
+	header		CACHE_HEADER_WORDS 32-bit words, see below
+	palette		'ncolors' SDL_Color entries
+	pixels		'pitch' * 'h' bytes, 16 byte aligned in the file,
+			left out if the surface was RLE encoded
+	RLE data	the encoding made by SDL_RLEaccel.c, if any
+*/
+
+#include "SDL_video.h"
+#include "SDL_blit.h"
+#include "SDL_RLEaccel_c.h"
+#include "SDL_pixels_c.h"
+#include "../file/SDL_rwops_c.h"
+
+#define CACHE_MAGIC		0x43534453	/* "SDSC" on little endian */
+#define CACHE_VERSION		1
+#define CACHE_BYTEORDER		0x01020304
+
+/* The header words */
+enum {
+	CACHE_MAGIC_WORD,
+	CACHE_VERSION_WORD,
+	CACHE_BYTEORDER_WORD,
+	CACHE_KEY,
+	CACHE_FLAGS,
+	CACHE_W,
+	CACHE_H,
+	CACHE_PITCH,
+	CACHE_BPP,
+	CACHE_RMASK,
+	CACHE_GMASK,
+	CACHE_BMASK,
+	CACHE_AMASK,
+	CACHE_COLORKEY,
+	CACHE_ALPHA,
+	CACHE_NCOLORS,
+	CACHE_DISPLAY_BPP,
+	CACHE_DISPLAY_RMASK,
+	CACHE_DISPLAY_GMASK,
+	CACHE_DISPLAY_BMASK,
+	CACHE_DISPLAY_AMASK,
+	CACHE_PIXELS_SIZE,
+	CACHE_RLE_SIZE,
+	CACHE_HEADER_WORDS
+};
+#define CACHE_HEADER_SIZE	(CACHE_HEADER_WORDS * 4)
+
+/* The surface state that is saved along with the pixels */
+#define CACHE_SURFACE_FLAGS	(SDL_SRCCOLORKEY|SDL_SRCALPHA|SDL_RLEACCELOK)
+
+/* The offset of the pixels, after the header and palette */
+#define CACHE_PIXELS_OFFSET(ncolors) \
+	((CACHE_HEADER_SIZE + (ncolors) * 4 + 15) & ~15)
+
+/* Record the format of the display, or zeros if there's no video mode */
+static void CacheDisplayFormat(Uint32 *header)
+{
+	SDL_Surface *screen = SDL_GetVideoSurface();
+
+	if ( screen ) {
+		header[CACHE_DISPLAY_BPP] = screen->format->BitsPerPixel;
+		header[CACHE_DISPLAY_RMASK] = screen->format->Rmask;
+		header[CACHE_DISPLAY_GMASK] = screen->format->Gmask;
+		header[CACHE_DISPLAY_BMASK] = screen->format->Bmask;
+		header[CACHE_DISPLAY_AMASK] = screen->format->Amask;
+	} else {
+		header[CACHE_DISPLAY_BPP] = 0;
+		header[CACHE_DISPLAY_RMASK] = 0;
+		header[CACHE_DISPLAY_GMASK] = 0;
+		header[CACHE_DISPLAY_BMASK] = 0;
+		header[CACHE_DISPLAY_AMASK] = 0;
+	}
+}
+
+int SDL_SaveSurfaceCache_RW (SDL_Surface *surface, Uint32 key,
+                             SDL_RWops *dst, int freedst)
+{
+	Uint32 header[CACHE_HEADER_WORDS];
+	SDL_Surface *screen;
+	SDL_Palette *palette;
+	SDL_bool locked;
+	Uint8 padding[16];
+	int ncolors, offset;
+	Uint8 *rle;
+	int rle_size;
+	Uint32 pitch;
+	int y;
+
+	if ( ! dst ) {
+		return(-1);
+	}
+	if ( ! surface ) {
+		SDL_SetError("Passed a NULL surface");
+		goto done;
+	}
+
+	/* Do any RLE encoding now, so it can be saved too */
+	screen = SDL_GetVideoSurface();
+	if ( screen && (surface->flags & SDL_RLEACCELOK) &&
+	     !(surface->flags & SDL_RLEACCEL) ) {
+		SDL_MapSurface(surface, screen);
+	}
+	rle = NULL;
+	rle_size = 0;
+	if ( (surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL ) {
+		rle = (Uint8 *)surface->map->sw_data->aux_data;
+		rle_size = surface->map->sw_data->aux_size;
+	}
+
+	palette = surface->format->palette;
+	ncolors = palette ? palette->ncolors : 0;
+	header[CACHE_MAGIC_WORD] = CACHE_MAGIC;
+	header[CACHE_VERSION_WORD] = CACHE_VERSION;
+	header[CACHE_BYTEORDER_WORD] = CACHE_BYTEORDER;
+	header[CACHE_KEY] = key;
+	header[CACHE_FLAGS] = (surface->flags & CACHE_SURFACE_FLAGS);
+	header[CACHE_W] = surface->w;
+	header[CACHE_H] = surface->h;
+	pitch = SDL_SurfacePitch(surface);
+	header[CACHE_PITCH] = pitch;
+	header[CACHE_BPP] = surface->format->BitsPerPixel;
+	header[CACHE_RMASK] = surface->format->Rmask;
+	header[CACHE_GMASK] = surface->format->Gmask;
+	header[CACHE_BMASK] = surface->format->Bmask;
+	header[CACHE_AMASK] = surface->format->Amask;
+	header[CACHE_COLORKEY] = surface->format->colorkey;
+	header[CACHE_ALPHA] = surface->format->alpha;
+	header[CACHE_NCOLORS] = ncolors;
+	CacheDisplayFormat(header);
+	/* The pixels of RLE encoded surfaces are rebuilt from the encoding */
+	header[CACHE_PIXELS_SIZE] = rle ? 0 : surface->h * pitch;
+	header[CACHE_RLE_SIZE] = rle_size;
+
+	SDL_ClearError();
+	if ( SDL_RWwrite(dst, header, CACHE_HEADER_SIZE, 1) != 1 ||
+	     (ncolors && SDL_RWwrite(dst, palette->colors,
+	                             sizeof(SDL_Color), ncolors) != ncolors) ) {
+		SDL_Error(SDL_EFWRITE);
+		goto done;
+	}
+	offset = CACHE_HEADER_SIZE + ncolors * 4;
+	if ( offset < CACHE_PIXELS_OFFSET(ncolors) ) {
+		SDL_memset(padding, 0, sizeof(padding));
+		if ( SDL_RWwrite(dst, padding, 1,
+		         CACHE_PIXELS_OFFSET(ncolors) - offset) !=
+		         CACHE_PIXELS_OFFSET(ncolors) - offset ) {
+			SDL_Error(SDL_EFWRITE);
+			goto done;
+		}
+	}
+
+	if ( rle ) {
+		if ( SDL_RWwrite(dst, rle, 1, rle_size) != rle_size ) {
+			SDL_Error(SDL_EFWRITE);
+		}
+		goto done;
+	}
+	locked = SDL_FALSE;
+	if ( SDL_MUSTLOCK(surface) ) {
+		if ( SDL_LockSurface(surface) < 0 ) {
+			goto done;
+		}
+		locked = SDL_TRUE;
+	}
+	for ( y = 0; y < surface->h; ++y ) {
+		if ( SDL_RWwrite(dst, (Uint8 *)surface->pixels +
+		                      (size_t)y * pitch, pitch, 1) != 1 ) {
+			SDL_Error(SDL_EFWRITE);
+			break;
+		}
+	}
+	if ( locked ) {
+		SDL_UnlockSurface(surface);
+	}
+done:
+	if ( freedst ) {
+		SDL_RWclose(dst);
+	}
+	return((SDL_strcmp(SDL_GetError(), "") == 0) ? 0 : -1);
+}
+
+SDL_Surface * SDL_LoadSurfaceCache_RW (SDL_RWops *src, int freesrc,
+                                       Uint32 key)
+{
+	Uint32 header[CACHE_HEADER_WORDS];
+	Uint32 display[CACHE_HEADER_WORDS];
+	SDL_Surface *surface;
+	SDL_Surface *screen;
+	SDL_Color colors[256];
+	Uint8 *pixels;
+	Uint8 *rle;
+	int ncolors, pixels_size, rle_size;
+	int got, y, skip;
+	Uint32 pitch;
+	Uint32 flags;
+
+	surface = NULL;
+	rle = NULL;
+	if ( ! src ) {
+		return(NULL);
+	}
+
+	/* Check that the cache fits this machine, source and display */
+	if ( SDL_RWread(src, header, CACHE_HEADER_SIZE, 1) != 1 ) {
+		SDL_Error(SDL_EFREAD);
+		goto error;
+	}
+	if ( header[CACHE_MAGIC_WORD] != CACHE_MAGIC ||
+	     header[CACHE_VERSION_WORD] != CACHE_VERSION ||
+	     header[CACHE_BYTEORDER_WORD] != CACHE_BYTEORDER ) {
+		SDL_SetError("Not a surface cache file for this platform");
+		goto error;
+	}
+	if ( header[CACHE_KEY] != key ) {
+		SDL_SetError("Surface cache is out of date");
+		goto error;
+	}
+	CacheDisplayFormat(display);
+	if ( SDL_memcmp(&header[CACHE_DISPLAY_BPP], &display[CACHE_DISPLAY_BPP],
+	                5 * sizeof(Uint32)) != 0 ) {
+		SDL_SetError("Surface cache is for another display format");
+		goto error;
+	}
+	ncolors = header[CACHE_NCOLORS];
+	pixels_size = header[CACHE_PIXELS_SIZE];
+	rle_size = header[CACHE_RLE_SIZE];
+	if ( ncolors > 256 || pixels_size < 0 || rle_size < 0 ||
+	     (pixels_size == 0 && rle_size == 0 && header[CACHE_H] != 0) ||
+	     header[CACHE_BPP] < 1 || header[CACHE_BPP] > 32 ||
+	     header[CACHE_W] >
+	       header[CACHE_PITCH] / ((header[CACHE_BPP] + 7) / 8) ||
+	     (pixels_size &&
+	      (header[CACHE_PITCH] == 0 ||
+	       header[CACHE_H] > 0x7FFFFFFF / header[CACHE_PITCH] ||
+	       pixels_size != (int)(header[CACHE_H] * header[CACHE_PITCH]))) ) {
+		SDL_SetError("Corrupt surface cache file");
+		goto error;
+	}
+	if ( ncolors &&
+	     SDL_RWread(src, colors, sizeof(SDL_Color), ncolors) != ncolors ) {
+		SDL_Error(SDL_EFREAD);
+		goto error;
+	}
+	if ( SDL_RWseek(src, CACHE_PIXELS_OFFSET(ncolors) -
+	                     (CACHE_HEADER_SIZE + ncolors * 4),
+	                RW_SEEK_CUR) < 0 ) {
+		SDL_Error(SDL_EFSEEK);
+		goto error;
+	}
+
+	/* Use the pixels in place if the cache is in memory */
+	pixels = NULL;
+	if ( pixels_size ) {
+		pixels = SDL_RWmapMem(src, pixels_size, &got);
+		if ( pixels && (got != pixels_size) ) {
+			SDL_Error(SDL_EFREAD);
+			goto error;
+		}
+		if ( pixels && ((size_t)pixels & 3) ) {
+			/* Not aligned, read a copy instead */
+			SDL_RWseek(src, -got, RW_SEEK_CUR);
+			pixels = NULL;
+		}
+	}
+	if ( pixels ) {
+		surface = SDL_CreateRGBSurfaceFrom(pixels,
+				header[CACHE_W], header[CACHE_H],
+				header[CACHE_BPP], header[CACHE_PITCH],
+				header[CACHE_RMASK], header[CACHE_GMASK],
+				header[CACHE_BMASK], header[CACHE_AMASK]);
+	} else {
+		surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
+				header[CACHE_W], header[CACHE_H],
+				header[CACHE_BPP],
+				header[CACHE_RMASK], header[CACHE_GMASK],
+				header[CACHE_BMASK], header[CACHE_AMASK]);
+	}
+	if ( surface == NULL ) {
+		goto error;
+	}
+	pitch = SDL_SurfacePitch(surface);
+	if ( pitch > header[CACHE_PITCH] ) {
+		SDL_SetError("Corrupt surface cache file");
+		goto error;
+	}
+	if ( pixels_size && !pixels ) {
+		/* The saved surface may have had a wider pitch */
+		skip = header[CACHE_PITCH] - pitch;
+		for ( y = 0; y < surface->h; ++y ) {
+			if ( SDL_RWread(src, (Uint8 *)surface->pixels +
+			                     (size_t)y * pitch,
+			                pitch, 1) != 1 ||
+			     (skip && SDL_RWseek(src, skip, RW_SEEK_CUR) < 0) ) {
+				SDL_Error(SDL_EFREAD);
+				goto error;
+			}
+		}
+	}
+	if ( ncolors && surface->format->palette ) {
+		SDL_memcpy(surface->format->palette->colors, colors,
+		           ncolors * sizeof(SDL_Color));
+		surface->format->palette->ncolors = ncolors;
+	}
+
+	/* Restore the color key and alpha, without encoding anything */
+	flags = header[CACHE_FLAGS];
+	if ( flags & SDL_SRCCOLORKEY ) {
+		SDL_SetColorKey(surface, flags & (SDL_SRCCOLORKEY|SDL_RLEACCELOK),
+		                header[CACHE_COLORKEY]);
+	}
+	if ( flags & SDL_SRCALPHA ) {
+		SDL_SetAlpha(surface, flags & (SDL_SRCALPHA|SDL_RLEACCELOK),
+		             (Uint8)header[CACHE_ALPHA]);
+	} else if ( surface->format->Amask ) {
+		SDL_SetAlpha(surface, 0, (Uint8)header[CACHE_ALPHA]);
+	}
+
+	/* Map the surface to the display with the saved RLE data */
+	if ( rle_size ) {
+		rle = (Uint8 *)SDL_malloc(rle_size);
+		if ( rle == NULL ) {
+			SDL_OutOfMemory();
+			goto error;
+		}
+		if ( SDL_RWread(src, rle, 1, rle_size) != rle_size ) {
+			SDL_Error(SDL_EFREAD);
+			goto error;
+		}
+		if ( SDL_RLECheckData(surface, rle, rle_size) < 0 ) {
+			SDL_SetError("Corrupt surface cache file");
+			goto error;
+		}
+		if ( pixels_size == 0 ) {
+			/* The pixels are rebuilt from the RLE data if needed */
+			SDL_free(surface->pixels);
+			surface->pixels = NULL;
+		}
+		screen = SDL_GetVideoSurface();
+		if ( screen ) {
+			surface->flags &= ~SDL_RLEACCELOK;
+			SDL_MapSurface(surface, screen);
+			surface->flags |= (flags & SDL_RLEACCELOK);
+		}
+		SDL_RLESurfaceFrom(surface, rle, rle_size);
+		rle = NULL;
+		if ( surface->pixels == NULL &&
+		     (surface->flags & SDL_RLEACCEL) != SDL_RLEACCEL ) {
+			SDL_OutOfMemory();
+			goto error;
+		}
+	}
+
+	if ( freesrc ) {
+		SDL_RWclose(src);
+	}
+	return(surface);
+
+error:
+	if ( rle ) {
+		SDL_free(rle);
+	}
+	if ( surface ) {
+		SDL_FreeSurface(surface);
+	}
+	if ( freesrc ) {
+		SDL_RWclose(src);
+	}
+	return(NULL);
+}
@@ -106,6 +106,16 @@ struct SDL_VideoDevice {
 	 */
 	void (*UpdateRects)(_THIS, int numrects, SDL_Rect *rects);
 
+	/* If not NULL, get a frame the driver kept after presenting it,
+	   index 0 being the last one, and optionally copy it into a new
+	   software surface returned in 'capture'.
+	 */
+	int (*GetFrame)(_THIS, int index, SDL_FrameInfo *info,
+	                SDL_Surface **capture);
+
+	/* If not NULL, get statistics about the presents of this mode */
+	int (*GetPresentStats)(_THIS, SDL_PresentStats *stats);
+
 	/* Reverse the effects VideoInit() -- called if VideoInit() fails
 	   or if the application is shutting down the video subsystem.
 	*/
@@ -258,6 +268,14 @@ struct SDL_VideoDevice {
 	/* Handle any queued OS events */
 	void (*PumpEvents)(_THIS);
 
+	/* Store up to 'maxfds' file descriptors that OS events arrive on,
+	   so SDL_WaitEvent() can sleep until one of them is readable, and
+	   return how many there are, or -1 if events are already waiting.
+	   Drivers that need pumping by a certain time lower '*timeout',
+	   in milliseconds.
+	 */
+	int (*GetEventFDs)(_THIS, int *fds, int maxfds, Uint32 *timeout);
+
 	/* * * */
 	/* Data common to all drivers */
 	SDL_Surface *screen;
@@ -0,0 +1,147 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Cache-blocked copies for rotated and mirrored pixel transfers */
+
+#include "SDL_video.h"
+#include "SDL_tile_c.h"
+
+/* The tile edge in pixels.  A tile touches TILE_SIZE source lines and
+   TILE_SIZE destination lines of at most TILE_SIZE*4 bytes each, which
+   keeps a 32 bpp tile at 8K, comfortably inside any L1 data cache.
+ */
+#define TILE_SIZE	32
+
+typedef void (*SDL_TileFunc)(const Uint8 *src, int src_right, int src_down,
+                             Uint8 *dst, int dst_pitch, int w, int h);
+
+#define DEFINE_TILE_FUNC(name, type)					\
+static void name(const Uint8 *src, int src_right, int src_down,		\
+                 Uint8 *dst, int dst_pitch, int w, int h)		\
+{									\
+	while ( h-- ) {							\
+		const Uint8 *s = src;					\
+		type *d = (type *)dst;					\
+		int n = w;						\
+									\
+		while ( n >= 4 ) {					\
+			d[0] = *(const type *)s;			\
+			d[1] = *(const type *)(s+src_right);		\
+			d[2] = *(const type *)(s+2*src_right);		\
+			d[3] = *(const type *)(s+3*src_right);		\
+			s += 4*src_right;				\
+			d += 4;						\
+			n -= 4;						\
+		}							\
+		while ( n-- ) {						\
+			*d++ = *(const type *)s;			\
+			s += src_right;					\
+		}							\
+		src += src_down;					\
+		dst += dst_pitch;					\
+	}								\
+}
+
+DEFINE_TILE_FUNC(TileCopy1, Uint8)
+DEFINE_TILE_FUNC(TileCopy2, Uint16)
+DEFINE_TILE_FUNC(TileCopy4, Uint32)
+
+static void TileCopy3(const Uint8 *src, int src_right, int src_down,
+                      Uint8 *dst, int dst_pitch, int w, int h)
+{
+	while ( h-- ) {
+		const Uint8 *s = src;
+		Uint8 *d = dst;
+		int n = w;
+
+		while ( n-- ) {
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+			s += src_right;
+			d += 3;
+		}
+		src += src_down;
+		dst += dst_pitch;
+	}
+}
+
+void SDL_TileCopy(const Uint8 *src, int src_right, int src_down,
+                  Uint8 *dst, int dst_pitch, int bpp, int w, int h)
+{
+	SDL_TileFunc copy;
+	int x, y;
+
+	if ( (w <= 0) || (h <= 0) ) {
+		return;
+	}
+
+	/* Straight copy, one memcpy per line */
+	if ( src_right == bpp ) {
+		while ( h-- ) {
+			SDL_memcpy(dst, src, w*bpp);
+			src += src_down;
+			dst += dst_pitch;
+		}
+		return;
+	}
+
+	switch (bpp) {
+	    case 1:
+		copy = TileCopy1;
+		break;
+	    case 2:
+		copy = TileCopy2;
+		break;
+	    case 3:
+		copy = TileCopy3;
+		break;
+	    case 4:
+		copy = TileCopy4;
+		break;
+	    default:
+		return;
+	}
+
+	/* Mirrored lines still read the source sequentially */
+	if ( src_right == -bpp ) {
+		copy(src, src_right, src_down, dst, dst_pitch, w, h);
+		return;
+	}
+
+	/* Rotated: every destination pixel is on a different source line,
+	   so walk the block one tile at a time.
+	 */
+	for ( y = 0; y < h; y += TILE_SIZE ) {
+		int th = (h - y) < TILE_SIZE ? (h - y) : TILE_SIZE;
+		const Uint8 *srcrow = src + y*src_down;
+		Uint8 *dstrow = dst + y*dst_pitch;
+
+		for ( x = 0; x < w; x += TILE_SIZE ) {
+			int tw = (w - x) < TILE_SIZE ? (w - x) : TILE_SIZE;
+
+			copy(srcrow + x*src_right, src_right, src_down,
+			     dstrow + x*bpp, dst_pitch, tw, th);
+		}
+	}
+}
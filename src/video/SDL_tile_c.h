@@ -0,0 +1,39 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Useful functions for copying pixels along rotated or mirrored axes */
+
+/* Copy a 'w' x 'h' block of 'bpp' byte pixels into 'dst', reading the
+   source along arbitrary directions: moving one pixel right in the
+   destination moves the source pointer by 'src_right' bytes, moving one
+   line down moves it by 'src_down' bytes.  This covers plain copies,
+   mirroring and the 90 degree rotations used by shadow framebuffers.
+
+   When the source is walked across lines (rotation), the block is
+   processed in small square tiles so that both the source columns and
+   the destination rows of a tile stay in the cache instead of touching
+   a new cache line and page for every pixel.
+ */
+extern void SDL_TileCopy(const Uint8 *src, int src_right, int src_down,
+                         Uint8 *dst, int dst_pitch,
+                         int bpp, int w, int h);
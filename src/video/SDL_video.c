@@ -28,6 +28,7 @@
 #include "SDL_blit.h"
 #include "SDL_pixels_c.h"
 #include "SDL_cursor_c.h"
+#include "SDL_record_c.h"
 #include "../events/SDL_sysevents.h"
 #include "../events/SDL_events_c.h"
 
@@ -920,6 +921,9 @@ SDL_Surface * SDL_SetVideoMode (int width, int height, int bpp, Uint32 flags)
 	video->info.current_w = SDL_VideoSurface->w;
 	video->info.current_h = SDL_VideoSurface->h;
 
+	/* Start recording, if SDL_VIDEO_RECORD asks for it */
+	SDL_RecordVideoMode();
+
 	/* We're done! */
 	return(SDL_PublicSurface);
 }
@@ -1085,6 +1089,8 @@ void SDL_UpdateRects (SDL_Surface *screen, int numrects, SDL_Rect *rects)
 		screen = SDL_VideoSurface;
 	}
 	if ( screen == SDL_VideoSurface ) {
+		SDL_RecordUpdate(screen, numrects, rects);
+
 		/* Update the video surface */
 		if ( screen->offset ) {
 			for ( i=0; i<numrects; ++i ) {
@@ -1149,6 +1155,13 @@ int SDL_Flip(SDL_Surface *screen)
 	}
 	if ( (screen->flags & SDL_DOUBLEBUF) == SDL_DOUBLEBUF ) {
 		SDL_VideoDevice *this  = current_video;
+		SDL_Rect rect;
+
+		rect.x = 0;
+		rect.y = 0;
+		rect.w = SDL_VideoSurface->w;
+		rect.h = SDL_VideoSurface->h;
+		SDL_RecordUpdate(SDL_VideoSurface, 1, &rect);
 		return(video->FlipHWSurface(this, SDL_VideoSurface));
 	} else {
 		SDL_UpdateRect(screen, 0, 0, 0, 0);
@@ -1156,6 +1169,46 @@ int SDL_Flip(SDL_Surface *screen)
 	return(0);
 }
 
+int SDL_GetPresentStats(SDL_PresentStats *stats)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+
+	if ( !video || !video->GetPresentStats ) {
+		SDL_SetError("Video driver doesn't keep present statistics");
+		return(-1);
+	}
+	return(video->GetPresentStats(this, stats));
+}
+
+int SDL_GetFrameInfo(int index, SDL_FrameInfo *info)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+
+	if ( !video || !video->GetFrame ) {
+		SDL_SetError("Video driver doesn't keep presented frames");
+		return(-1);
+	}
+	return(video->GetFrame(this, index, info, NULL));
+}
+
+SDL_Surface *SDL_CaptureFrame(int index, SDL_FrameInfo *info)
+{
+	SDL_VideoDevice *video = current_video;
+	SDL_VideoDevice *this  = current_video;
+	SDL_Surface *capture = NULL;
+
+	if ( !video || !video->GetFrame ) {
+		SDL_SetError("Video driver doesn't keep presented frames");
+		return(NULL);
+	}
+	if ( video->GetFrame(this, index, info, &capture) < 0 ) {
+		return(NULL);
+	}
+	return(capture);
+}
+
 static void SetPalette_logical(SDL_Surface *screen, SDL_Color *colors,
 			       int firstcolor, int ncolors)
 {
@@ -1355,6 +1408,9 @@ void SDL_VideoQuit (void)
 		/* Halt event processing before doing anything else */
 		SDL_StopEventLoop();
 
+		/* Write out the rest of any recording */
+		SDL_RecordQuit();
+
 		/* Clean up allocated window manager items */
 		if ( SDL_PublicSurface ) {
 			SDL_PublicSurface = NULL;
@@ -1745,14 +1801,16 @@ static void CreateMaskFromColorKeyOrAlpha(SDL_Surface *icon, Uint8 *mask, int fl
 {
 	int x, y;
 	Uint32 colorkey;
+	size_t pitch;
 #define SET_MASKBIT(icon, x, y, mask) \
 	mask[(y*((icon->w+7)/8))+(x/8)] &= ~(0x01<<(7-(x%8)))
 
 	colorkey = icon->format->colorkey;
+	pitch = SDL_SurfacePitch(icon);
 	switch (icon->format->BytesPerPixel) {
 		case 1: { Uint8 *pixels;
 			for ( y=0; y<icon->h; ++y ) {
-				pixels = (Uint8 *)icon->pixels + y*icon->pitch;
+				pixels = (Uint8 *)icon->pixels + y*pitch;
 				for ( x=0; x<icon->w; ++x ) {
 					if ( *pixels++ == colorkey ) {
 						SET_MASKBIT(icon, x, y, mask);
@@ -1765,7 +1823,7 @@ static void CreateMaskFromColorKeyOrAlpha(SDL_Surface *icon, Uint8 *mask, int fl
 		case 2: { Uint16 *pixels;
 			for ( y=0; y<icon->h; ++y ) {
 				pixels = (Uint16 *)icon->pixels +
-				                   y*icon->pitch/2;
+				                   y*(pitch/2);
 				for ( x=0; x<icon->w; ++x ) {
 					if ( (flags & 1) && *pixels == colorkey ) {
 						SET_MASKBIT(icon, x, y, mask);
@@ -1781,7 +1839,7 @@ static void CreateMaskFromColorKeyOrAlpha(SDL_Surface *icon, Uint8 *mask, int fl
 		case 4: { Uint32 *pixels;
 			for ( y=0; y<icon->h; ++y ) {
 				pixels = (Uint32 *)icon->pixels +
-				                   y*icon->pitch/4;
+				                   y*(pitch/4);
 				for ( x=0; x<icon->w; ++x ) {
 					if ( (flags & 1) && *pixels == colorkey ) {
 						SET_MASKBIT(icon, x, y, mask);
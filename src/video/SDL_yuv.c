@@ -138,6 +138,24 @@ int SDL_DisplayYUVOverlay(SDL_Overlay *overlay, SDL_Rect *dstrect)
 	return overlay->hwfuncs->Display(current_video, overlay, &src, &dst);
 }
 
+int SDL_SetYUVOverlayPlanes(SDL_Overlay *overlay, Uint8 **pixels,
+                            Uint16 *pitches)
+{
+	if ( overlay == NULL ) {
+		SDL_SetError("Passed NULL overlay");
+		return -1;
+	}
+	return SDL_SetPlanesYUV_SW(overlay, pixels, pitches);
+}
+
+Uint32 SDL_GetYUVOverlayConversionTime(SDL_Overlay *overlay)
+{
+	if ( overlay == NULL ) {
+		return 0;
+	}
+	return SDL_GetConversionTimeYUV_SW(overlay);
+}
+
 void SDL_FreeYUVOverlay(SDL_Overlay *overlay)
 {
 	if ( overlay == NULL ) {
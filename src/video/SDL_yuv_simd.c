@@ -0,0 +1,690 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* SSE2 and AVX2 versions of the software YUV colorspace converters */
+
+#include "SDL_video.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_yuvfuncs.h"
+#include "SDL_yuv_sw_c.h"
+
+#if SDL_YUV_SSE2
+
+#include <emmintrin.h>
+#if SDL_YUV_AVX2
+#include <immintrin.h>
+#endif
+
+/* The colortab coefficients from SDL_yuv_sw.c in 2.14 fixed point.
+   These were picked so that truncating |C| * K >> 14 gives exactly the
+   same value as (int)(k * C) for every C in [-128,127], which means the
+   vector converters produce the same pixels as the C versions and can
+   share a frame with them (we use C for the columns at the right edge).
+ */
+#define YUV_CR_R	22960	/*  (0.419/0.299) */
+#define YUV_CR_G	11692	/* -(0.299/0.419) */
+#define YUV_CB_G	5643	/* -(0.114/0.331) */
+#define YUV_CB_B	29055	/*  (0.587/0.331) */
+
+#define YUV_INLINE	static __inline__ __attribute__((always_inline))
+#define YUV_AVX2	__attribute__((target("avx2")))
+
+/* Where each 8-bit channel goes in the display pixel */
+struct yuv_layout {
+	__m128i loss[3];
+	__m128i shift[3];
+};
+
+/* The rgb_2_pix tables end in the full channel mask, so we can recover
+   the pixel layout from them without changing the converter signature.
+ */
+static void YUV_GetLayout(Uint32 *rgb_2_pix, int bpp, struct yuv_layout *layout)
+{
+	int i;
+
+	for ( i = 0; i < 3; ++i ) {
+		Uint32 mask = rgb_2_pix[i*768+511];
+		int shift = 0;
+		int bits = 0;
+
+		if ( bpp == 2 ) {
+			mask &= 0xFFFF;
+		}
+		while ( mask && !(mask & 1) ) {
+			mask >>= 1;
+			++shift;
+		}
+		while ( mask & 1 ) {
+			mask >>= 1;
+			++bits;
+		}
+		layout->loss[i] = _mm_cvtsi32_si128(8 - bits);
+		layout->shift[i] = _mm_cvtsi32_si128(shift);
+	}
+}
+
+/* The C converters, one pixel at a time, for the columns left over */
+YUV_INLINE Uint32 YUV_Pixel(int *colortab, Uint32 *rgb_2_pix,
+                            int L, int cr, int cb)
+{
+	int cr_r  = 0*768+256 + colortab[ cr + 0*256 ];
+	int crb_g = 1*768+256 + colortab[ cr + 1*256 ]
+	                      + colortab[ cb + 2*256 ];
+	int cb_b  = 2*768+256 + colortab[ cb + 3*256 ];
+
+	return (rgb_2_pix[ L + cr_r ] |
+	        rgb_2_pix[ L + crb_g ] |
+	        rgb_2_pix[ L + cb_b ]);
+}
+
+YUV_INLINE void YUV_PutPixel(Uint8 *row, int pitch, int x, Uint32 pix,
+                             int bpp, int scale)
+{
+	int i, j;
+
+	for ( j = 0; j < scale; ++j ) {
+		for ( i = 0; i < scale; ++i ) {
+			if ( bpp == 2 ) {
+				((Uint16 *)row)[x*scale+i] = (Uint16)pix;
+			} else {
+				((Uint32 *)row)[x*scale+i] = pix;
+			}
+		}
+		row += pitch;
+	}
+}
+
+/*
+ * SSE2 versions, 16 pixels (YV12) or 8 pixels (YUY2) at a time
+ */
+
+/* Signed C times the unsigned coefficient K, truncated towards zero */
+YUV_INLINE __m128i YUV_Mul_SSE2(__m128i c, short k)
+{
+	const __m128i sign = _mm_srai_epi16(c, 15);
+	__m128i a;
+
+	a = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+	a = _mm_mulhi_epu16(_mm_slli_epi16(a, 2), _mm_set1_epi16(k));
+	return _mm_sub_epi16(_mm_xor_si128(a, sign), sign);
+}
+
+/* Find the red, green and blue offsets for the chroma in 16-bit lanes */
+YUV_INLINE void YUV_Chroma_SSE2(__m128i cr, __m128i cb, __m128i add[3])
+{
+	const __m128i bias = _mm_set1_epi16(128);
+
+	cr = _mm_sub_epi16(cr, bias);
+	cb = _mm_sub_epi16(cb, bias);
+	add[0] = YUV_Mul_SSE2(cr, YUV_CR_R);
+	add[1] = _mm_sub_epi16(_mm_setzero_si128(),
+	                       _mm_add_epi16(YUV_Mul_SSE2(cr, YUV_CR_G),
+	                                     YUV_Mul_SSE2(cb, YUV_CB_G)));
+	add[2] = YUV_Mul_SSE2(cb, YUV_CB_B);
+}
+
+YUV_INLINE __m128i YUV_Clamp_SSE2(__m128i lum, __m128i add)
+{
+	lum = _mm_add_epi16(lum, add);
+	lum = _mm_max_epi16(lum, _mm_setzero_si128());
+	return _mm_min_epi16(lum, _mm_set1_epi16(255));
+}
+
+/* Convert 8 pixels of luma in 16-bit lanes and write them out */
+YUV_INLINE void YUV_Store8_SSE2(Uint8 *row, int pitch, __m128i lum,
+                                __m128i add[3],
+                                const struct yuv_layout *layout,
+                                int bpp, int scale)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i c, lo, hi;
+	int i;
+
+	if ( bpp == 2 ) {
+		lo = zero;
+		for ( i = 0; i < 3; ++i ) {
+			c = YUV_Clamp_SSE2(lum, add[i]);
+			c = _mm_srl_epi16(c, layout->loss[i]);
+			lo = _mm_or_si128(lo, _mm_sll_epi16(c, layout->shift[i]));
+		}
+		if ( scale == 1 ) {
+			_mm_storeu_si128((__m128i *)row, lo);
+		} else {
+			hi = _mm_unpackhi_epi16(lo, lo);
+			lo = _mm_unpacklo_epi16(lo, lo);
+			_mm_storeu_si128((__m128i *)(row), lo);
+			_mm_storeu_si128((__m128i *)(row+16), hi);
+			_mm_storeu_si128((__m128i *)(row+pitch), lo);
+			_mm_storeu_si128((__m128i *)(row+pitch+16), hi);
+		}
+	} else {
+		lo = hi = zero;
+		for ( i = 0; i < 3; ++i ) {
+			c = YUV_Clamp_SSE2(lum, add[i]);
+			c = _mm_srl_epi16(c, layout->loss[i]);
+			lo = _mm_or_si128(lo, _mm_sll_epi32(
+				_mm_unpacklo_epi16(c, zero), layout->shift[i]));
+			hi = _mm_or_si128(hi, _mm_sll_epi32(
+				_mm_unpackhi_epi16(c, zero), layout->shift[i]));
+		}
+		if ( scale == 1 ) {
+			_mm_storeu_si128((__m128i *)(row), lo);
+			_mm_storeu_si128((__m128i *)(row+16), hi);
+		} else {
+			for ( i = 0; i < 2; ++i ) {
+				__m128i a = _mm_unpacklo_epi32(lo, lo);
+				__m128i b = _mm_unpackhi_epi32(lo, lo);
+				__m128i d = _mm_unpacklo_epi32(hi, hi);
+				__m128i e = _mm_unpackhi_epi32(hi, hi);
+				_mm_storeu_si128((__m128i *)(row), a);
+				_mm_storeu_si128((__m128i *)(row+16), b);
+				_mm_storeu_si128((__m128i *)(row+32), d);
+				_mm_storeu_si128((__m128i *)(row+48), e);
+				row += pitch;
+			}
+		}
+	}
+}
+
+YUV_INLINE void YUV420_SSE2(int *colortab, Uint32 *rgb_2_pix,
+                            unsigned char *lum, unsigned char *cr,
+                            unsigned char *cb, unsigned char *out,
+                            int rows, int cols, int mod,
+                            int lum_pitch, int chroma_pitch, int chroma_step,
+                            int bpp, int scale)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i chroma_mask = _mm_set1_epi16(0x00FF);
+	const int pitch = (cols*scale + mod) * bpp;
+	const int step = scale * bpp;
+	struct yuv_layout layout;
+	__m128i add[3], addlo[3], addhi[3];
+	__m128i lum1, lum2, chroma;
+	__m128i cr_shift, cb_shift;
+	Uint8 *row1, *row2;
+	int x, y, i;
+
+	/* Interleaved chroma pairs are split like the packed formats */
+	cr_shift = _mm_cvtsi32_si128((cr > cb) ? 8 : 0);
+	cb_shift = _mm_cvtsi32_si128((cb > cr) ? 8 : 0);
+
+	YUV_GetLayout(rgb_2_pix, bpp, &layout);
+	y = rows / 2;
+	while ( y-- ) {
+		row1 = out;
+		row2 = out + scale*pitch;
+		for ( x = 0; x + 16 <= cols; x += 16 ) {
+			if ( chroma_step == 1 ) {
+				YUV_Chroma_SSE2(
+				    _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(cr + x/2)), zero),
+				    _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(cb + x/2)), zero),
+				    add);
+			} else {
+				chroma = _mm_loadu_si128((__m128i *)((cr < cb ? cr : cb) + x));
+				YUV_Chroma_SSE2(
+				    _mm_and_si128(_mm_srl_epi16(chroma, cr_shift), chroma_mask),
+				    _mm_and_si128(_mm_srl_epi16(chroma, cb_shift), chroma_mask),
+				    add);
+			}
+			for ( i = 0; i < 3; ++i ) {
+				addlo[i] = _mm_unpacklo_epi16(add[i], add[i]);
+				addhi[i] = _mm_unpackhi_epi16(add[i], add[i]);
+			}
+			lum1 = _mm_loadu_si128((__m128i *)(lum + x));
+			lum2 = _mm_loadu_si128((__m128i *)(lum + lum_pitch + x));
+			YUV_Store8_SSE2(row1 + x*step, pitch,
+			                _mm_unpacklo_epi8(lum1, zero),
+			                addlo, &layout, bpp, scale);
+			YUV_Store8_SSE2(row1 + (x+8)*step, pitch,
+			                _mm_unpackhi_epi8(lum1, zero),
+			                addhi, &layout, bpp, scale);
+			YUV_Store8_SSE2(row2 + x*step, pitch,
+			                _mm_unpacklo_epi8(lum2, zero),
+			                addlo, &layout, bpp, scale);
+			YUV_Store8_SSE2(row2 + (x+8)*step, pitch,
+			                _mm_unpackhi_epi8(lum2, zero),
+			                addhi, &layout, bpp, scale);
+		}
+		for ( ; x + 2 <= cols; x += 2 ) {
+			for ( i = 0; i < 4; ++i ) {
+				int L = lum[(i/2)*lum_pitch + x + (i&1)];
+				YUV_PutPixel((i/2) ? row2 : row1, pitch, x + (i&1),
+				    YUV_Pixel(colortab, rgb_2_pix, L,
+				              cr[(x/2)*chroma_step],
+				              cb[(x/2)*chroma_step]), bpp, scale);
+			}
+		}
+		lum += 2*lum_pitch;
+		cr += chroma_pitch;
+		cb += chroma_pitch;
+		out += 2*scale*pitch;
+	}
+}
+
+YUV_INLINE void YUV422_SSE2(int *colortab, Uint32 *rgb_2_pix,
+                            unsigned char *lum, unsigned char *cr,
+                            unsigned char *cb, unsigned char *out,
+                            int rows, int cols, int mod,
+                            int lum_pitch, int chroma_pitch, int chroma_step,
+                            int bpp, int scale)
+{
+	const int pitch = (cols*scale + mod) * bpp;
+	const int step = scale * bpp;
+	unsigned char *base;
+	__m128i lum_shift, cr_shift, cb_shift;
+	__m128i lum_mask, chroma_mask;
+	struct yuv_layout layout;
+	__m128i add[3], pixels, u, v;
+	int x, y;
+
+	/* The packed formats only differ in the byte order of each pair */
+	base = lum;
+	if ( cr < base ) base = cr;
+	if ( cb < base ) base = cb;
+	lum_shift = _mm_cvtsi32_si128(8 * (int)(lum - base));
+	cr_shift = _mm_cvtsi32_si128(8 * (int)(cr - base));
+	cb_shift = _mm_cvtsi32_si128(8 * (int)(cb - base));
+	lum_mask = _mm_set1_epi16(0x00FF);
+	chroma_mask = _mm_set1_epi32(0x000000FF);
+
+	YUV_GetLayout(rgb_2_pix, bpp, &layout);
+	y = rows;
+	while ( y-- ) {
+		for ( x = 0; x + 8 <= cols; x += 8 ) {
+			pixels = _mm_loadu_si128((__m128i *)(base + 2*x));
+			u = _mm_and_si128(_mm_srl_epi32(pixels, cr_shift),
+			                  chroma_mask);
+			v = _mm_and_si128(_mm_srl_epi32(pixels, cb_shift),
+			                  chroma_mask);
+			YUV_Chroma_SSE2(_mm_or_si128(u, _mm_slli_epi32(u, 16)),
+			                _mm_or_si128(v, _mm_slli_epi32(v, 16)),
+			                add);
+			YUV_Store8_SSE2(out + x*step, pitch,
+			                _mm_and_si128(_mm_srl_epi16(pixels, lum_shift),
+			                              lum_mask),
+			                add, &layout, bpp, scale);
+		}
+		for ( ; x + 2 <= cols; x += 2 ) {
+			YUV_PutPixel(out, pitch, x,
+			    YUV_Pixel(colortab, rgb_2_pix,
+			              lum[2*x], cr[2*x], cb[2*x]), bpp, scale);
+			YUV_PutPixel(out, pitch, x+1,
+			    YUV_Pixel(colortab, rgb_2_pix,
+			              lum[2*x+2], cr[2*x], cb[2*x]), bpp, scale);
+		}
+		base += lum_pitch;
+		lum += lum_pitch;
+		cr += lum_pitch;
+		cb += lum_pitch;
+		out += scale*pitch;
+	}
+}
+
+#if SDL_YUV_AVX2
+
+/*
+ * AVX2 versions, 32 pixels (YV12) or 16 pixels (YUY2) at a time
+ */
+
+YUV_INLINE YUV_AVX2 __m256i YUV_Mul_AVX2(__m256i c, short k)
+{
+	const __m256i sign = _mm256_srai_epi16(c, 15);
+	__m256i a;
+
+	a = _mm256_sub_epi16(_mm256_xor_si256(c, sign), sign);
+	a = _mm256_mulhi_epu16(_mm256_slli_epi16(a, 2), _mm256_set1_epi16(k));
+	return _mm256_sub_epi16(_mm256_xor_si256(a, sign), sign);
+}
+
+YUV_INLINE YUV_AVX2 void YUV_Chroma_AVX2(__m256i cr, __m256i cb, __m256i add[3])
+{
+	const __m256i bias = _mm256_set1_epi16(128);
+
+	cr = _mm256_sub_epi16(cr, bias);
+	cb = _mm256_sub_epi16(cb, bias);
+	add[0] = YUV_Mul_AVX2(cr, YUV_CR_R);
+	add[1] = _mm256_sub_epi16(_mm256_setzero_si256(),
+	                          _mm256_add_epi16(YUV_Mul_AVX2(cr, YUV_CR_G),
+	                                           YUV_Mul_AVX2(cb, YUV_CB_G)));
+	add[2] = YUV_Mul_AVX2(cb, YUV_CB_B);
+}
+
+YUV_INLINE YUV_AVX2 __m256i YUV_Clamp_AVX2(__m256i lum, __m256i add)
+{
+	lum = _mm256_add_epi16(lum, add);
+	lum = _mm256_max_epi16(lum, _mm256_setzero_si256());
+	return _mm256_min_epi16(lum, _mm256_set1_epi16(255));
+}
+
+/* Write out the 256-bit register pair a, b with every pixel doubled.
+   The AVX2 unpacks work within each 128-bit lane, so the halves need
+   to be put back in order afterwards.
+ */
+#define YUV_STORE2X_AVX2(row, a, b) \
+{ \
+	_mm256_storeu_si256((__m256i *)(row), _mm256_permute2x128_si256(a, b, 0x20)); \
+	_mm256_storeu_si256((__m256i *)((row)+32), _mm256_permute2x128_si256(a, b, 0x31)); \
+}
+
+/* Convert 16 pixels of luma in 16-bit lanes and write them out */
+YUV_INLINE YUV_AVX2 void YUV_Store16_AVX2(Uint8 *row, int pitch, __m256i lum,
+                                          __m256i add[3],
+                                          const struct yuv_layout *layout,
+                                          int bpp, int scale)
+{
+	__m256i c, lo, hi, a, b;
+	int i, j;
+
+	if ( bpp == 2 ) {
+		lo = _mm256_setzero_si256();
+		for ( i = 0; i < 3; ++i ) {
+			c = YUV_Clamp_AVX2(lum, add[i]);
+			c = _mm256_srl_epi16(c, layout->loss[i]);
+			lo = _mm256_or_si256(lo, _mm256_sll_epi16(c, layout->shift[i]));
+		}
+		if ( scale == 1 ) {
+			_mm256_storeu_si256((__m256i *)row, lo);
+		} else {
+			a = _mm256_unpacklo_epi16(lo, lo);
+			b = _mm256_unpackhi_epi16(lo, lo);
+			YUV_STORE2X_AVX2(row, a, b);
+			YUV_STORE2X_AVX2(row+pitch, a, b);
+		}
+	} else {
+		lo = hi = _mm256_setzero_si256();
+		for ( i = 0; i < 3; ++i ) {
+			c = YUV_Clamp_AVX2(lum, add[i]);
+			c = _mm256_srl_epi16(c, layout->loss[i]);
+			lo = _mm256_or_si256(lo, _mm256_sll_epi32(
+				_mm256_cvtepu16_epi32(_mm256_castsi256_si128(c)),
+				layout->shift[i]));
+			hi = _mm256_or_si256(hi, _mm256_sll_epi32(
+				_mm256_cvtepu16_epi32(_mm256_extracti128_si256(c, 1)),
+				layout->shift[i]));
+		}
+		if ( scale == 1 ) {
+			_mm256_storeu_si256((__m256i *)(row), lo);
+			_mm256_storeu_si256((__m256i *)(row+32), hi);
+		} else {
+			for ( j = 0; j < 2; ++j ) {
+				a = _mm256_unpacklo_epi32(lo, lo);
+				b = _mm256_unpackhi_epi32(lo, lo);
+				YUV_STORE2X_AVX2(row, a, b);
+				a = _mm256_unpacklo_epi32(hi, hi);
+				b = _mm256_unpackhi_epi32(hi, hi);
+				YUV_STORE2X_AVX2(row+64, a, b);
+				row += pitch;
+			}
+		}
+	}
+}
+
+YUV_INLINE YUV_AVX2 void YUV420_AVX2(int *colortab, Uint32 *rgb_2_pix,
+                                     unsigned char *lum, unsigned char *cr,
+                                     unsigned char *cb, unsigned char *out,
+                                     int rows, int cols, int mod,
+                                     int lum_pitch, int chroma_pitch,
+                                     int chroma_step, int bpp, int scale)
+{
+	const __m256i chroma_mask = _mm256_set1_epi16(0x00FF);
+	const int pitch = (cols*scale + mod) * bpp;
+	const int step = scale * bpp;
+	struct yuv_layout layout;
+	__m256i add[3], addlo[3], addhi[3], t, chroma;
+	__m128i cr_shift, cb_shift;
+	Uint8 *row1, *row2;
+	int x, y, i;
+
+	cr_shift = _mm_cvtsi32_si128((cr > cb) ? 8 : 0);
+	cb_shift = _mm_cvtsi32_si128((cb > cr) ? 8 : 0);
+
+	YUV_GetLayout(rgb_2_pix, bpp, &layout);
+	y = rows / 2;
+	while ( y-- ) {
+		row1 = out;
+		row2 = out + scale*pitch;
+		for ( x = 0; x + 32 <= cols; x += 32 ) {
+			if ( chroma_step == 1 ) {
+				YUV_Chroma_AVX2(
+				    _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(cr + x/2))),
+				    _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(cb + x/2))),
+				    add);
+			} else {
+				chroma = _mm256_loadu_si256((__m256i *)((cr < cb ? cr : cb) + x));
+				YUV_Chroma_AVX2(
+				    _mm256_and_si256(_mm256_srl_epi16(chroma, cr_shift), chroma_mask),
+				    _mm256_and_si256(_mm256_srl_epi16(chroma, cb_shift), chroma_mask),
+				    add);
+			}
+			for ( i = 0; i < 3; ++i ) {
+				/* Quadwords 0,2,1,3 so the in-lane unpacks
+				   double the chroma samples in order */
+				t = _mm256_permute4x64_epi64(add[i], 0xD8);
+				addlo[i] = _mm256_unpacklo_epi16(t, t);
+				addhi[i] = _mm256_unpackhi_epi16(t, t);
+			}
+			YUV_Store16_AVX2(row1 + x*step, pitch,
+			    _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(lum + x))),
+			    addlo, &layout, bpp, scale);
+			YUV_Store16_AVX2(row1 + (x+16)*step, pitch,
+			    _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(lum + x+16))),
+			    addhi, &layout, bpp, scale);
+			YUV_Store16_AVX2(row2 + x*step, pitch,
+			    _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(lum + lum_pitch + x))),
+			    addlo, &layout, bpp, scale);
+			YUV_Store16_AVX2(row2 + (x+16)*step, pitch,
+			    _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i *)(lum + lum_pitch + x+16))),
+			    addhi, &layout, bpp, scale);
+		}
+		for ( ; x + 2 <= cols; x += 2 ) {
+			for ( i = 0; i < 4; ++i ) {
+				int L = lum[(i/2)*lum_pitch + x + (i&1)];
+				YUV_PutPixel((i/2) ? row2 : row1, pitch, x + (i&1),
+				    YUV_Pixel(colortab, rgb_2_pix, L,
+				              cr[(x/2)*chroma_step],
+				              cb[(x/2)*chroma_step]), bpp, scale);
+			}
+		}
+		lum += 2*lum_pitch;
+		cr += chroma_pitch;
+		cb += chroma_pitch;
+		out += 2*scale*pitch;
+	}
+}
+
+YUV_INLINE YUV_AVX2 void YUV422_AVX2(int *colortab, Uint32 *rgb_2_pix,
+                                     unsigned char *lum, unsigned char *cr,
+                                     unsigned char *cb, unsigned char *out,
+                                     int rows, int cols, int mod,
+                                     int lum_pitch, int chroma_pitch,
+                                     int chroma_step, int bpp, int scale)
+{
+	const int pitch = (cols*scale + mod) * bpp;
+	const int step = scale * bpp;
+	unsigned char *base;
+	__m128i lum_shift, cr_shift, cb_shift;
+	__m256i lum_mask, chroma_mask;
+	struct yuv_layout layout;
+	__m256i add[3], pixels, u, v;
+	int x, y;
+
+	base = lum;
+	if ( cr < base ) base = cr;
+	if ( cb < base ) base = cb;
+	lum_shift = _mm_cvtsi32_si128(8 * (int)(lum - base));
+	cr_shift = _mm_cvtsi32_si128(8 * (int)(cr - base));
+	cb_shift = _mm_cvtsi32_si128(8 * (int)(cb - base));
+	lum_mask = _mm256_set1_epi16(0x00FF);
+	chroma_mask = _mm256_set1_epi32(0x000000FF);
+
+	YUV_GetLayout(rgb_2_pix, bpp, &layout);
+	y = rows;
+	while ( y-- ) {
+		for ( x = 0; x + 16 <= cols; x += 16 ) {
+			pixels = _mm256_loadu_si256((__m256i *)(base + 2*x));
+			u = _mm256_and_si256(_mm256_srl_epi32(pixels, cr_shift),
+			                     chroma_mask);
+			v = _mm256_and_si256(_mm256_srl_epi32(pixels, cb_shift),
+			                     chroma_mask);
+			YUV_Chroma_AVX2(_mm256_or_si256(u, _mm256_slli_epi32(u, 16)),
+			                _mm256_or_si256(v, _mm256_slli_epi32(v, 16)),
+			                add);
+			YUV_Store16_AVX2(out + x*step, pitch,
+			    _mm256_and_si256(_mm256_srl_epi16(pixels, lum_shift),
+			                     lum_mask),
+			    add, &layout, bpp, scale);
+		}
+		for ( ; x + 2 <= cols; x += 2 ) {
+			YUV_PutPixel(out, pitch, x,
+			    YUV_Pixel(colortab, rgb_2_pix,
+			              lum[2*x], cr[2*x], cb[2*x]), bpp, scale);
+			YUV_PutPixel(out, pitch, x+1,
+			    YUV_Pixel(colortab, rgb_2_pix,
+			              lum[2*x+2], cr[2*x], cb[2*x]), bpp, scale);
+		}
+		base += lum_pitch;
+		lum += lum_pitch;
+		cr += lum_pitch;
+		cb += lum_pitch;
+		out += scale*pitch;
+	}
+}
+
+#endif /* SDL_YUV_AVX2 */
+
+/* The converters themselves, specialized for each depth and scale */
+#define YUV_CONVERTER(target, name, kernel, bpp, scale) \
+static target void name(int *colortab, Uint32 *rgb_2_pix, \
+                        unsigned char *lum, unsigned char *cr, \
+                        unsigned char *cb, unsigned char *out, \
+                        int rows, int cols, int mod, \
+                        int lum_pitch, int chroma_pitch, int chroma_step) \
+{ \
+	kernel(colortab, rgb_2_pix, lum, cr, cb, out, rows, cols, mod, \
+	       lum_pitch, chroma_pitch, chroma_step, bpp, scale); \
+}
+
+YUV_CONVERTER(, Color16DitherYV12Mod1X_SSE2, YUV420_SSE2, 2, 1)
+YUV_CONVERTER(, Color32DitherYV12Mod1X_SSE2, YUV420_SSE2, 4, 1)
+YUV_CONVERTER(, Color16DitherYV12Mod2X_SSE2, YUV420_SSE2, 2, 2)
+YUV_CONVERTER(, Color32DitherYV12Mod2X_SSE2, YUV420_SSE2, 4, 2)
+YUV_CONVERTER(, Color16DitherYUY2Mod1X_SSE2, YUV422_SSE2, 2, 1)
+YUV_CONVERTER(, Color32DitherYUY2Mod1X_SSE2, YUV422_SSE2, 4, 1)
+YUV_CONVERTER(, Color16DitherYUY2Mod2X_SSE2, YUV422_SSE2, 2, 2)
+YUV_CONVERTER(, Color32DitherYUY2Mod2X_SSE2, YUV422_SSE2, 4, 2)
+#if SDL_YUV_AVX2
+YUV_CONVERTER(YUV_AVX2, Color16DitherYV12Mod1X_AVX2, YUV420_AVX2, 2, 1)
+YUV_CONVERTER(YUV_AVX2, Color32DitherYV12Mod1X_AVX2, YUV420_AVX2, 4, 1)
+YUV_CONVERTER(YUV_AVX2, Color16DitherYV12Mod2X_AVX2, YUV420_AVX2, 2, 2)
+YUV_CONVERTER(YUV_AVX2, Color32DitherYV12Mod2X_AVX2, YUV420_AVX2, 4, 2)
+YUV_CONVERTER(YUV_AVX2, Color16DitherYUY2Mod1X_AVX2, YUV422_AVX2, 2, 1)
+YUV_CONVERTER(YUV_AVX2, Color32DitherYUY2Mod1X_AVX2, YUV422_AVX2, 4, 1)
+YUV_CONVERTER(YUV_AVX2, Color16DitherYUY2Mod2X_AVX2, YUV422_AVX2, 2, 2)
+YUV_CONVERTER(YUV_AVX2, Color32DitherYUY2Mod2X_AVX2, YUV422_AVX2, 4, 2)
+#endif
+
+/* Indexed by [planar][bpp == 4][scale_2x] */
+static const SDL_YUVConverter sse2_converters[2][2][2] = {
+	{ { Color16DitherYUY2Mod1X_SSE2, Color16DitherYUY2Mod2X_SSE2 },
+	  { Color32DitherYUY2Mod1X_SSE2, Color32DitherYUY2Mod2X_SSE2 } },
+	{ { Color16DitherYV12Mod1X_SSE2, Color16DitherYV12Mod2X_SSE2 },
+	  { Color32DitherYV12Mod1X_SSE2, Color32DitherYV12Mod2X_SSE2 } }
+};
+#if SDL_YUV_AVX2
+static const SDL_YUVConverter avx2_converters[2][2][2] = {
+	{ { Color16DitherYUY2Mod1X_AVX2, Color16DitherYUY2Mod2X_AVX2 },
+	  { Color32DitherYUY2Mod1X_AVX2, Color32DitherYUY2Mod2X_AVX2 } },
+	{ { Color16DitherYV12Mod1X_AVX2, Color16DitherYV12Mod2X_AVX2 },
+	  { Color32DitherYV12Mod1X_AVX2, Color32DitherYV12Mod2X_AVX2 } }
+};
+#endif
+
+static int YUV_ChannelBits(Uint32 mask)
+{
+	int bits = 0;
+
+	while ( mask ) {
+		bits += (mask & 1);
+		mask >>= 1;
+	}
+	return bits;
+}
+
+int SDL_YUVSelectSIMD(SDL_PixelFormat *format, Uint32 yuv_format,
+                      SDL_YUVConverter *Display1X,
+                      SDL_YUVConverter *Display2X)
+{
+	const SDL_YUVConverter (*converters)[2];
+	Uint32 masks[3];
+	int planar;
+	int i;
+
+	switch (yuv_format) {
+	    case SDL_YV12_OVERLAY:
+	    case SDL_IYUV_OVERLAY:
+	    case SDL_NV12_OVERLAY:
+	    case SDL_NV21_OVERLAY:
+		planar = 1;
+		break;
+	    case SDL_YUY2_OVERLAY:
+	    case SDL_UYVY_OVERLAY:
+	    case SDL_YVYU_OVERLAY:
+		planar = 0;
+		break;
+	    default:
+		return(-1);
+	}
+
+	/* Each channel is shifted within 16 or 32 bit lanes */
+	if ( (format->BytesPerPixel != 2) && (format->BytesPerPixel != 4) ) {
+		return(-1);
+	}
+	masks[0] = format->Rmask;
+	masks[1] = format->Gmask;
+	masks[2] = format->Bmask;
+	for ( i = 0; i < 3; ++i ) {
+		int bits = YUV_ChannelBits(masks[i]);
+		if ( (bits < 1) || (bits > 8) ) {
+			return(-1);
+		}
+	}
+
+	converters = NULL;
+#if SDL_YUV_AVX2
+	if ( SDL_HasAVX2() ) {
+		converters = avx2_converters[planar];
+	}
+#endif
+	if ( !converters && SDL_HasSSE2() ) {
+		converters = sse2_converters[planar];
+	}
+	if ( !converters ) {
+		return(-1);
+	}
+	i = (format->BytesPerPixel == 4);
+	*Display1X = converters[i][0];
+	*Display2X = converters[i][1];
+	return(0);
+}
+
+#endif /* SDL_YUV_SSE2 */
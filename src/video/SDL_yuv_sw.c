@@ -85,9 +85,11 @@
 
 #include "SDL_video.h"
 #include "SDL_cpuinfo.h"
-#include "SDL_stretch_c.h"
+#include "SDL_thread.h"
 #include "SDL_yuvfuncs.h"
 #include "SDL_yuv_sw_c.h"
+#include "SDL_pixels_c.h"
+#include "../timer/SDL_timer_c.h"
 
 /* The functions used to manipulate software video overlays */
 static struct private_yuvhwfuncs sw_yuvfuncs = {
@@ -97,21 +99,65 @@ static struct private_yuvhwfuncs sw_yuvfuncs = {
 	SDL_FreeYUV_SW
 };
 
+/* Source positions for each destination column of a scaled display */
+struct yuv_column {
+	int lum, lum1;		/* Byte offsets of the two luma samples */
+	int chroma, chroma1;	/* Byte offsets of the two chroma samples */
+	int lum_frac;		/* Bilinear weights of the second samples */
+	int chroma_frac;
+};
+
+/* The frame being converted, split into bands of rows */
+struct yuv_frame {
+	SDL_Overlay *overlay;
+	Uint8 *lum, *Cr, *Cb;
+	int lum_pitch;
+	int chroma_pitch;
+	int chroma_step;	/* Bytes between chroma samples of planar data */
+	SDL_Rect *src, *dst;
+	Uint8 *out;
+	int pitch;
+	int bpp;
+	int mod;
+	int scale;		/* 1 or 2, or 0 for the scaled path */
+	int rows;		/* Source rows, or destination rows if scaled */
+	int band_rows;
+	int num_bands;
+};
+
+#define YUV_FILTER_NEAREST	0
+#define YUV_FILTER_LINEAR	1
+
+/* The most threads SDL_VIDEO_YUV_THREADS can ask for */
+#define YUV_MAX_THREADS		16
+
 /* RGB conversion lookup tables */
 struct private_yuvhwdata {
-	SDL_Surface *stretch;
 	SDL_Surface *display;
 	Uint8 *pixels;
 	int *colortab;
 	Uint32 *rgb_2_pix;
-	void (*Display1X)(int *colortab, Uint32 *rgb_2_pix,
-                          unsigned char *lum, unsigned char *cr,
-                          unsigned char *cb, unsigned char *out,
-                          int rows, int cols, int mod );
-	void (*Display2X)(int *colortab, Uint32 *rgb_2_pix,
-	                  unsigned char *lum, unsigned char *cr,
-                          unsigned char *cb, unsigned char *out,
-                          int rows, int cols, int mod );
+	SDL_YUVConverter Display1X;
+	SDL_YUVConverter Display2X;
+
+	/* Used to clip and scale in the same pass as the conversion */
+	int filter;
+	struct yuv_column *columns;
+	int max_columns;
+
+	/* Worker threads converting bands of the frame in parallel */
+	int num_threads;
+	int min_pixels;
+	SDL_Thread **threads;
+	SDL_sem *band_start;
+	SDL_sem *band_done;
+	SDL_mutex *band_lock;
+	int next_band;
+	volatile int quit;
+	struct yuv_frame frame;
+
+	/* How long the last frame took to convert, in microseconds */
+	Uint32 convert_time;
 
 	/* These are just so we don't have to allocate them separately */
 	Uint16 pitches[3];
@@ -135,7 +181,9 @@ extern void ColorRGBDitherYV12MMX1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color16DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned short* row1;
     unsigned short* row2;
@@ -145,10 +193,12 @@ static void Color16DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = 2*lum_pitch - cols;
+    const int chroma_skip = chroma_pitch - cols_2*chroma_step;
 
     row1 = (unsigned short*) out;
     row2 = row1 + cols + mod;
-    lum2 = lum + cols;
+    lum2 = lum + lum_pitch;
 
     mod += cols + mod;
 
@@ -164,7 +214,7 @@ static void Color16DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
             crb_g  = 1*768+256 + colortab[ *cr + 1*256 ]
                                + colortab[ *cb + 2*256 ];
             cb_b   = 2*768+256 + colortab[ *cb + 3*256 ];
-            ++cr; ++cb;
+            cr += chroma_step; cb += chroma_step;
 
             L = *lum++;
             *row1++ = (unsigned short)(rgb_2_pix[ L + cr_r ] |
@@ -195,8 +245,10 @@ static void Color16DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
          * to the ++'s above),but they need to be at the start
          * of the line after that.
          */
-        lum  += cols;
-        lum2 += cols;
+        lum  += lum_skip;
+        lum2 += lum_skip;
+        cr += chroma_skip;
+        cb += chroma_skip;
         row1 += mod;
         row2 += mod;
     }
@@ -205,7 +257,9 @@ static void Color16DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color24DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int value;
     unsigned char* row1;
@@ -216,10 +270,12 @@ static void Color24DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = 2*lum_pitch - cols;
+    const int chroma_skip = chroma_pitch - cols_2*chroma_step;
 
     row1 = out;
     row2 = row1 + cols*3 + mod*3;
-    lum2 = lum + cols;
+    lum2 = lum + lum_pitch;
 
     mod += cols + mod;
     mod *= 3;
@@ -236,7 +292,7 @@ static void Color24DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
             crb_g  = 1*768+256 + colortab[ *cr + 1*256 ]
                                + colortab[ *cb + 2*256 ];
             cb_b   = 2*768+256 + colortab[ *cb + 3*256 ];
-            ++cr; ++cb;
+            cr += chroma_step; cb += chroma_step;
 
             L = *lum++;
             value = (rgb_2_pix[ L + cr_r ] |
@@ -279,8 +335,10 @@ static void Color24DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
          * to the ++'s above),but they need to be at the start
          * of the line after that.
          */
-        lum  += cols;
-        lum2 += cols;
+        lum  += lum_skip;
+        lum2 += lum_skip;
+        cr += chroma_skip;
+        cb += chroma_skip;
         row1 += mod;
         row2 += mod;
     }
@@ -289,7 +347,9 @@ static void Color24DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color32DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int* row1;
     unsigned int* row2;
@@ -299,10 +359,12 @@ static void Color32DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = 2*lum_pitch - cols;
+    const int chroma_skip = chroma_pitch - cols_2*chroma_step;
 
     row1 = (unsigned int*) out;
     row2 = row1 + cols + mod;
-    lum2 = lum + cols;
+    lum2 = lum + lum_pitch;
 
     mod += cols + mod;
 
@@ -318,7 +380,7 @@ static void Color32DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
             crb_g  = 1*768+256 + colortab[ *cr + 1*256 ]
                                + colortab[ *cb + 2*256 ];
             cb_b   = 2*768+256 + colortab[ *cb + 3*256 ];
-            ++cr; ++cb;
+            cr += chroma_step; cb += chroma_step;
 
             L = *lum++;
             *row1++ = (rgb_2_pix[ L + cr_r ] |
@@ -349,8 +411,10 @@ static void Color32DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
          * to the ++'s above),but they need to be at the start
          * of the line after that.
          */
-        lum  += cols;
-        lum2 += cols;
+        lum  += lum_skip;
+        lum2 += lum_skip;
+        cr += chroma_skip;
+        cb += chroma_skip;
         row1 += mod;
         row2 += mod;
     }
@@ -364,7 +428,9 @@ static void Color32DitherYV12Mod1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color16DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int* row1 = (unsigned int*) out;
     const int next_row = cols+(mod/2);
@@ -375,8 +441,10 @@ static void Color16DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = 2*lum_pitch - cols;
+    const int chroma_skip = chroma_pitch - cols_2*chroma_step;
 
-    lum2 = lum + cols;
+    lum2 = lum + lum_pitch;
 
     mod = (next_row * 3) + (mod/2);
 
@@ -392,7 +460,7 @@ static void Color16DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
             crb_g  = 1*768+256 + colortab[ *cr + 1*256 ]
                                + colortab[ *cb + 2*256 ];
             cb_b   = 2*768+256 + colortab[ *cb + 3*256 ];
-            ++cr; ++cb;
+            cr += chroma_step; cb += chroma_step;
 
             L = *lum++;
             row1[0] = row1[next_row] = (rgb_2_pix[ L + cr_r ] |
@@ -427,8 +495,10 @@ static void Color16DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
          * to the ++'s above),but they need to be at the start
          * of the line after that.
          */
-        lum  += cols;
-        lum2 += cols;
+        lum  += lum_skip;
+        lum2 += lum_skip;
+        cr += chroma_skip;
+        cb += chroma_skip;
         row1 += mod;
         row2 += mod;
     }
@@ -437,7 +507,9 @@ static void Color16DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
 static void Color24DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int value;
     unsigned char* row1 = out;
@@ -449,8 +521,10 @@ static void Color24DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = 2*lum_pitch - cols;
+    const int chroma_skip = chroma_pitch - cols_2*chroma_step;
 
-    lum2 = lum + cols;
+    lum2 = lum + lum_pitch;
 
     mod = next_row*3 + mod*3;
 
@@ -466,7 +540,7 @@ static void Color24DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
             crb_g  = 1*768+256 + colortab[ *cr + 1*256 ]
                                + colortab[ *cb + 2*256 ];
             cb_b   = 2*768+256 + colortab[ *cb + 3*256 ];
-            ++cr; ++cb;
+            cr += chroma_step; cb += chroma_step;
 
             L = *lum++;
             value = (rgb_2_pix[ L + cr_r ] |
@@ -525,8 +599,10 @@ static void Color24DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
          * to the ++'s above),but they need to be at the start
          * of the line after that.
          */
-        lum  += cols;
-        lum2 += cols;
+        lum  += lum_skip;
+        lum2 += lum_skip;
+        cr += chroma_skip;
+        cb += chroma_skip;
         row1 += mod;
         row2 += mod;
     }
@@ -535,7 +611,9 @@ static void Color24DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
 static void Color32DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int* row1 = (unsigned int*) out;
     const int next_row = cols*2+mod;
@@ -546,8 +624,10 @@ static void Color32DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = 2*lum_pitch - cols;
+    const int chroma_skip = chroma_pitch - cols_2*chroma_step;
 
-    lum2 = lum + cols;
+    lum2 = lum + lum_pitch;
 
     mod = (next_row * 3) + mod;
 
@@ -563,7 +643,7 @@ static void Color32DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
             crb_g  = 1*768+256 + colortab[ *cr + 1*256 ]
                                + colortab[ *cb + 2*256 ];
             cb_b   = 2*768+256 + colortab[ *cb + 3*256 ];
-            ++cr; ++cb;
+            cr += chroma_step; cb += chroma_step;
 
             L = *lum++;
             row1[0] = row1[1] = row1[next_row] = row1[next_row+1] =
@@ -602,8 +682,10 @@ static void Color32DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
          * to the ++'s above),but they need to be at the start
          * of the line after that.
          */
-        lum  += cols;
-        lum2 += cols;
+        lum  += lum_skip;
+        lum2 += lum_skip;
+        cr += chroma_skip;
+        cb += chroma_skip;
         row1 += mod;
         row2 += mod;
     }
@@ -612,7 +694,9 @@ static void Color32DitherYV12Mod2X( int *colortab, Uint32 *rgb_2_pix,
 static void Color16DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned short* row;
     int x, y;
@@ -620,6 +704,7 @@ static void Color16DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = lum_pitch - cols*2;
 
     row = (unsigned short*) out;
 
@@ -649,6 +734,9 @@ static void Color16DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
 
         }
 
+        lum += lum_skip;
+        cr += lum_skip;
+        cb += lum_skip;
         row += mod;
     }
 }
@@ -656,7 +744,9 @@ static void Color16DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color24DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int value;
     unsigned char* row;
@@ -665,6 +755,7 @@ static void Color24DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = lum_pitch - cols*2;
 
     row = (unsigned char*) out;
     mod *= 3;
@@ -699,6 +790,9 @@ static void Color24DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
             *row++ = (value >> 16) & 0xFF;
 
         }
+        lum += lum_skip;
+        cr += lum_skip;
+        cb += lum_skip;
         row += mod;
     }
 }
@@ -706,7 +800,9 @@ static void Color24DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color32DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int* row;
     int x, y;
@@ -714,6 +810,7 @@ static void Color32DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = lum_pitch - cols*2;
 
     row = (unsigned int*) out;
     y = rows;
@@ -742,6 +839,9 @@ static void Color32DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
 
 
         }
+        lum += lum_skip;
+        cr += lum_skip;
+        cb += lum_skip;
         row += mod;
     }
 }
@@ -754,7 +854,9 @@ static void Color32DitherYUY2Mod1X( int *colortab, Uint32 *rgb_2_pix,
 static void Color16DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int* row = (unsigned int*) out;
     const int next_row = cols+(mod/2);
@@ -763,6 +865,7 @@ static void Color16DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = lum_pitch - cols*2;
 
     y = rows;
     while( y-- )
@@ -791,6 +894,9 @@ static void Color16DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
             row++;
 
         }
+        lum += lum_skip;
+        cr += lum_skip;
+        cb += lum_skip;
         row += next_row;
     }
 }
@@ -798,7 +904,9 @@ static void Color16DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
 static void Color24DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int value;
     unsigned char* row = out;
@@ -808,6 +916,7 @@ static void Color24DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = lum_pitch - cols*2;
     y = rows;
     while( y-- )
     {
@@ -847,6 +956,9 @@ static void Color24DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
             row += 2*3;
 
         }
+        lum += lum_skip;
+        cr += lum_skip;
+        cb += lum_skip;
         row += next_row;
     }
 }
@@ -854,7 +966,9 @@ static void Color24DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
 static void Color32DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
                                     unsigned char *lum, unsigned char *cr,
                                     unsigned char *cb, unsigned char *out,
-                                    int rows, int cols, int mod )
+                                    int rows, int cols, int mod,
+                                    int lum_pitch, int chroma_pitch,
+                                    int chroma_step )
 {
     unsigned int* row = (unsigned int*) out;
     const int next_row = cols*2+mod;
@@ -863,6 +977,7 @@ static void Color32DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
     int crb_g;
     int cb_b;
     int cols_2 = cols / 2;
+    const int lum_skip = lum_pitch - cols*2;
     mod+=mod;
     y = rows;
     while( y-- )
@@ -895,10 +1010,55 @@ static void Color32DitherYUY2Mod2X( int *colortab, Uint32 *rgb_2_pix,
 
         }
 
+        lum += lum_skip;
+        cr += lum_skip;
+        cb += lum_skip;
         row += next_row;
     }
 }
 
+#if (__GNUC__ > 2) && defined(__i386__) && __OPTIMIZE__ && SDL_ASSEMBLY_ROUTINES
+/*
+ * The MMX converters only handle planes laid out the way the overlay
+ * allocates them, so fall back to C for planes set by the application.
+ */
+static void Color565DitherYV12MMX1XPitch( int *colortab, Uint32 *rgb_2_pix,
+                                          unsigned char *lum, unsigned char *cr,
+                                          unsigned char *cb, unsigned char *out,
+                                          int rows, int cols, int mod,
+                                          int lum_pitch, int chroma_pitch,
+                                          int chroma_step )
+{
+    if ( (lum_pitch == cols) && (chroma_pitch == cols/2) &&
+         (chroma_step == 1) ) {
+        Color565DitherYV12MMX1X(colortab, rgb_2_pix, lum, cr, cb, out,
+                                rows, cols, mod);
+    } else {
+        Color16DitherYV12Mod1X(colortab, rgb_2_pix, lum, cr, cb, out,
+                               rows, cols, mod,
+                               lum_pitch, chroma_pitch, chroma_step);
+    }
+}
+
+static void ColorRGBDitherYV12MMX1XPitch( int *colortab, Uint32 *rgb_2_pix,
+                                          unsigned char *lum, unsigned char *cr,
+                                          unsigned char *cb, unsigned char *out,
+                                          int rows, int cols, int mod,
+                                          int lum_pitch, int chroma_pitch,
+                                          int chroma_step )
+{
+    if ( (lum_pitch == cols) && (chroma_pitch == cols/2) &&
+         (chroma_step == 1) ) {
+        ColorRGBDitherYV12MMX1X(colortab, rgb_2_pix, lum, cr, cb, out,
+                                rows, cols, mod);
+    } else {
+        Color32DitherYV12Mod1X(colortab, rgb_2_pix, lum, cr, cb, out,
+                               rows, cols, mod,
+                               lum_pitch, chroma_pitch, chroma_step);
+    }
+}
+#endif
+
 /*
  * How many 1 bits are there in the Uint32.
  * Low performance, do not call often.
@@ -923,6 +1083,415 @@ static int free_bits_at_bottom( Uint32 a )
 }
 
 
+/*
+ * Scaled display: convert a source rectangle of the overlay straight to a
+ * destination rectangle of any size, either picking the nearest source
+ * pixel or filtering between the four nearest ones.  This is a single pass
+ * over the destination, instead of converting the whole overlay to a
+ * scratch surface and stretching that.
+ */
+static __inline__ Uint32 YUVToPixel(int *colortab, Uint32 *rgb_2_pix,
+                                    int L, int cr, int cb)
+{
+	int cr_r  = 0*768+256 + colortab[ cr + 0*256 ];
+	int crb_g = 1*768+256 + colortab[ cr + 1*256 ]
+	                      + colortab[ cb + 2*256 ];
+	int cb_b  = 2*768+256 + colortab[ cb + 3*256 ];
+
+	return (rgb_2_pix[ L + cr_r ] |
+	        rgb_2_pix[ L + crb_g ] |
+	        rgb_2_pix[ L + cb_b ]);
+}
+
+/* Find the two samples on either side of a 16.16 position, and the weight
+   of the second one, keeping them within [first,last]
+ */
+static void YUVSamplePair(int pos, int first, int last,
+                          int *a, int *b, int *frac)
+{
+	if ( pos <= (first << 16) ) {
+		*a = *b = first;
+		*frac = 0;
+	} else if ( pos >= (last << 16) ) {
+		*a = *b = last;
+		*frac = 0;
+	} else {
+		*a = (pos >> 16);
+		*b = *a + 1;
+		*frac = (pos >> 8) & 0xFF;
+	}
+}
+
+/* Interpolate between four 8-bit samples with 8-bit weights */
+#define YUV_LERP(p0, p1, a, b, fx, fy) \
+	((((p0[a] * (256-(fx)) + p0[b] * (fx)) * (256-(fy)) + \
+	   (p1[a] * (256-(fx)) + p1[b] * (fx)) * (fy)) + 32768) >> 16)
+
+static int SetupYUVColumns(struct private_yuvhwdata *swdata, SDL_Rect *src,
+                           int dst_w, int lum_step, int chroma_step)
+{
+	struct yuv_column *column;
+	int first, last;
+	int step, pos;
+	int a, b, frac;
+	int i;
+
+	if ( dst_w > swdata->max_columns ) {
+		column = (struct yuv_column *)SDL_realloc(swdata->columns,
+		                                  dst_w * sizeof(*column));
+		if ( column == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		swdata->columns = column;
+		swdata->max_columns = dst_w;
+	}
+
+	first = src->x;
+	last = src->x + src->w - 1;
+	step = (src->w << 16) / dst_w;
+	pos = (src->x << 16) + step / 2;
+	column = swdata->columns;
+	if ( swdata->filter == YUV_FILTER_NEAREST ) {
+		for ( i = 0; i < dst_w; ++i, ++column, pos += step ) {
+			a = (pos >> 16);
+			if ( a > last ) {
+				a = last;
+			}
+			column->lum = column->lum1 = a * lum_step;
+			column->chroma = column->chroma1 = (a / 2) * chroma_step;
+			column->lum_frac = column->chroma_frac = 0;
+		}
+	} else {
+		/* Sample at pixel centers, chroma is sited between luma pairs */
+		pos -= 0x8000;
+		for ( i = 0; i < dst_w; ++i, ++column, pos += step ) {
+			YUVSamplePair(pos, first, last, &a, &b, &frac);
+			column->lum = a * lum_step;
+			column->lum1 = b * lum_step;
+			column->lum_frac = frac;
+			YUVSamplePair(((pos + 0x8000) >> 1) - 0x8000,
+			              first / 2, last / 2, &a, &b, &frac);
+			column->chroma = a * chroma_step;
+			column->chroma1 = b * chroma_step;
+			column->chroma_frac = frac;
+		}
+	}
+	return(0);
+}
+
+/* Convert destination rows [first_row, first_row+num_rows), once the
+   columns have been set up by SetupYUVColumns()
+ */
+static void DisplayYUVScaled(struct private_yuvhwdata *swdata,
+                             SDL_Overlay *overlay,
+                             Uint8 *lum, Uint8 *Cr, Uint8 *Cb,
+                             SDL_Rect *src, SDL_Rect *dst,
+                             Uint8 *out, int pitch, int bpp,
+                             int first_row, int num_rows)
+{
+	int *colortab = swdata->colortab;
+	Uint32 *rgb_2_pix = swdata->rgb_2_pix;
+	struct yuv_column *column;
+	int lum_pitch, chroma_pitch;
+	int chroma_vshift;
+	int first, last;
+	int step, pos;
+	int ly, ly1, lfy;
+	int cy, cy1, cfy;
+	Uint8 *l0, *l1, *r0, *r1, *b0, *b1;
+	Uint8 *row;
+	Uint32 pix;
+	int x, y;
+
+	lum_pitch = swdata->frame.lum_pitch;
+	chroma_pitch = swdata->frame.chroma_pitch;
+	chroma_vshift = (overlay->planes > 1);
+
+	first = src->y;
+	last = src->y + src->h - 1;
+	step = (src->h << 16) / dst->h;
+	pos = (src->y << 16) + step / 2 + first_row * step;
+	if ( swdata->filter == YUV_FILTER_LINEAR ) {
+		pos -= 0x8000;
+	}
+	for ( y = first_row; y < first_row + num_rows; ++y, pos += step ) {
+		row = out + y * pitch;
+		column = swdata->columns;
+		if ( swdata->filter == YUV_FILTER_NEAREST ) {
+			ly = (pos >> 16);
+			if ( ly > last ) {
+				ly = last;
+			}
+			cy = (ly >> chroma_vshift);
+			l0 = lum + ly * lum_pitch;
+			r0 = Cr + cy * chroma_pitch;
+			b0 = Cb + cy * chroma_pitch;
+			ly1 = lfy = cy1 = cfy = 0;
+			l1 = r1 = b1 = NULL;
+		} else {
+			YUVSamplePair(pos, first, last, &ly, &ly1, &lfy);
+			if ( chroma_vshift ) {
+				YUVSamplePair(((pos + 0x8000) >> 1) - 0x8000,
+				              first / 2, last / 2, &cy, &cy1, &cfy);
+			} else {
+				cy = ly;
+				cy1 = ly1;
+				cfy = lfy;
+			}
+			l0 = lum + ly * lum_pitch;
+			l1 = lum + ly1 * lum_pitch;
+			r0 = Cr + cy * chroma_pitch;
+			r1 = Cr + cy1 * chroma_pitch;
+			b0 = Cb + cy * chroma_pitch;
+			b1 = Cb + cy1 * chroma_pitch;
+		}
+		for ( x = dst->w; x--; ++column ) {
+			if ( swdata->filter == YUV_FILTER_NEAREST ) {
+				pix = YUVToPixel(colortab, rgb_2_pix,
+				                 l0[column->lum],
+				                 r0[column->chroma],
+				                 b0[column->chroma]);
+			} else {
+				pix = YUVToPixel(colortab, rgb_2_pix,
+				        YUV_LERP(l0, l1, column->lum, column->lum1,
+				                 column->lum_frac, lfy),
+				        YUV_LERP(r0, r1, column->chroma, column->chroma1,
+				                 column->chroma_frac, cfy),
+				        YUV_LERP(b0, b1, column->chroma, column->chroma1,
+				                 column->chroma_frac, cfy));
+			}
+			switch (bpp) {
+			    case 2:
+				*(Uint16 *)row = (Uint16)pix;
+				row += 2;
+				break;
+			    case 3:
+				row[0] = (pix      ) & 0xFF;
+				row[1] = (pix >>  8) & 0xFF;
+				row[2] = (pix >> 16) & 0xFF;
+				row += 3;
+				break;
+			    default:
+				*(Uint32 *)row = pix;
+				row += 4;
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * Threaded display: the frame is split into bands of rows, which the
+ * worker threads and the displaying thread take turns converting.
+ */
+static void ConvertYUVBand(struct private_yuvhwdata *swdata, int band)
+{
+	struct yuv_frame *frame = &swdata->frame;
+	SDL_Overlay *overlay = frame->overlay;
+	int first_row, num_rows;
+	int lum_offset, chroma_offset;
+
+	first_row = band * frame->band_rows;
+	num_rows = frame->rows - first_row;
+	if ( num_rows > frame->band_rows ) {
+		num_rows = frame->band_rows;
+	}
+	if ( num_rows <= 0 ) {
+		return;
+	}
+
+	if ( frame->scale == 0 ) {
+		DisplayYUVScaled(swdata, overlay, frame->lum, frame->Cr, frame->Cb,
+		                 frame->src, frame->dst, frame->out,
+		                 frame->pitch, frame->bpp, first_row, num_rows);
+		return;
+	}
+
+	lum_offset = first_row * frame->lum_pitch;
+	if ( overlay->planes > 1 ) {
+		chroma_offset = (first_row / 2) * frame->chroma_pitch;
+	} else {
+		chroma_offset = lum_offset;
+	}
+	(frame->scale == 2 ? swdata->Display2X : swdata->Display1X)(
+		swdata->colortab, swdata->rgb_2_pix,
+		frame->lum + lum_offset,
+		frame->Cr + chroma_offset,
+		frame->Cb + chroma_offset,
+		frame->out + first_row * frame->scale * frame->pitch,
+		num_rows, overlay->w, frame->mod,
+		frame->lum_pitch, frame->chroma_pitch, frame->chroma_step);
+}
+
+static void ConvertYUVBands(struct private_yuvhwdata *swdata)
+{
+	int band;
+
+	for ( ;; ) {
+		SDL_mutexP(swdata->band_lock);
+		band = swdata->next_band++;
+		SDL_mutexV(swdata->band_lock);
+		if ( band >= swdata->frame.num_bands ) {
+			break;
+		}
+		ConvertYUVBand(swdata, band);
+	}
+}
+
+static int YUVWorkerThread(void *data)
+{
+	struct private_yuvhwdata *swdata = (struct private_yuvhwdata *)data;
+
+	for ( ;; ) {
+		SDL_SemWait(swdata->band_start);
+		if ( swdata->quit ) {
+			break;
+		}
+		ConvertYUVBands(swdata);
+		SDL_SemPost(swdata->band_done);
+	}
+	return(0);
+}
+
+static void StopYUVThreads(struct private_yuvhwdata *swdata)
+{
+	int i;
+
+	if ( swdata->threads ) {
+		swdata->quit = 1;
+		for ( i = 0; i < swdata->num_threads-1; ++i ) {
+			if ( swdata->threads[i] ) {
+				SDL_SemPost(swdata->band_start);
+			}
+		}
+		for ( i = 0; i < swdata->num_threads-1; ++i ) {
+			if ( swdata->threads[i] ) {
+				SDL_WaitThread(swdata->threads[i], NULL);
+			}
+		}
+		SDL_free(swdata->threads);
+		swdata->threads = NULL;
+	}
+	if ( swdata->band_start ) {
+		SDL_DestroySemaphore(swdata->band_start);
+		swdata->band_start = NULL;
+	}
+	if ( swdata->band_done ) {
+		SDL_DestroySemaphore(swdata->band_done);
+		swdata->band_done = NULL;
+	}
+	if ( swdata->band_lock ) {
+		SDL_DestroyMutex(swdata->band_lock);
+		swdata->band_lock = NULL;
+	}
+	swdata->num_threads = 1;
+}
+
+/* Start the worker threads, or fall back to converting on the displaying
+   thread if they can't be created.
+ */
+static void StartYUVThreads(struct private_yuvhwdata *swdata, int num_threads)
+{
+	int i;
+
+	swdata->num_threads = num_threads;
+	swdata->quit = 0;
+	swdata->band_start = SDL_CreateSemaphore(0);
+	swdata->band_done = SDL_CreateSemaphore(0);
+	swdata->band_lock = SDL_CreateMutex();
+	swdata->threads = (SDL_Thread **)SDL_malloc(
+				(num_threads-1) * sizeof(*swdata->threads));
+	if ( !swdata->band_start || !swdata->band_done ||
+	     !swdata->band_lock || !swdata->threads ) {
+		StopYUVThreads(swdata);
+		return;
+	}
+	SDL_memset(swdata->threads, 0, (num_threads-1) * sizeof(*swdata->threads));
+	for ( i = 0; i < num_threads-1; ++i ) {
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThread
+		swdata->threads[i] = SDL_CreateThread(YUVWorkerThread, swdata,
+		                                      NULL, NULL);
+#else
+		swdata->threads[i] = SDL_CreateThread(YUVWorkerThread, swdata);
+#endif
+		if ( ! swdata->threads[i] ) {
+			StopYUVThreads(swdata);
+			return;
+		}
+	}
+}
+
+/* Convert the frame, in parallel if it's big enough to be worthwhile */
+static void ConvertYUVFrame(struct private_yuvhwdata *swdata)
+{
+	struct yuv_frame *frame = &swdata->frame;
+	int i;
+
+	if ( (swdata->num_threads > 1) &&
+	     ((frame->dst->w * frame->dst->h) >= swdata->min_pixels) ) {
+		/* A few bands per thread evens out the load */
+		frame->num_bands = swdata->num_threads * 4;
+		frame->band_rows = (frame->rows + frame->num_bands - 1) /
+		                   frame->num_bands;
+		/* 4:2:0 chroma rows cover pairs of luma rows */
+		frame->band_rows = (frame->band_rows + 1) & ~1;
+		swdata->next_band = 0;
+		for ( i = 0; i < swdata->num_threads-1; ++i ) {
+			SDL_SemPost(swdata->band_start);
+		}
+		ConvertYUVBands(swdata);
+		for ( i = 0; i < swdata->num_threads-1; ++i ) {
+			SDL_SemWait(swdata->band_done);
+		}
+	} else {
+		frame->num_bands = 1;
+		frame->band_rows = frame->rows;
+		ConvertYUVBand(swdata, 0);
+	}
+}
+
+/* Point the overlay at the planes allocated along with it */
+static void SetupYUVPlanes(SDL_Overlay *overlay)
+{
+	struct private_yuvhwdata *swdata = overlay->hwdata;
+
+	switch (overlay->format) {
+	    case SDL_YV12_OVERLAY:
+	    case SDL_IYUV_OVERLAY:
+		overlay->pitches[0] = overlay->w;
+		overlay->pitches[1] = overlay->pitches[0] / 2;
+		overlay->pitches[2] = overlay->pitches[0] / 2;
+	        overlay->pixels[0] = swdata->pixels;
+	        overlay->pixels[1] = overlay->pixels[0] +
+		                     overlay->pitches[0] * overlay->h;
+	        overlay->pixels[2] = overlay->pixels[1] +
+		                     overlay->pitches[1] * overlay->h / 2;
+		overlay->planes = 3;
+		break;
+	    case SDL_NV12_OVERLAY:
+	    case SDL_NV21_OVERLAY:
+		overlay->pitches[0] = overlay->w;
+		overlay->pitches[1] = overlay->w;
+	        overlay->pixels[0] = swdata->pixels;
+	        overlay->pixels[1] = overlay->pixels[0] +
+		                     overlay->pitches[0] * overlay->h;
+		overlay->planes = 2;
+		break;
+	    case SDL_YUY2_OVERLAY:
+	    case SDL_UYVY_OVERLAY:
+	    case SDL_YVYU_OVERLAY:
+		overlay->pitches[0] = overlay->w*2;
+	        overlay->pixels[0] = swdata->pixels;
+		overlay->planes = 1;
+		break;
+	    default:
+		/* We should never get here (caught in SDL_CreateYUV_SW) */
+		break;
+	}
+}
+
 SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_Surface *display)
 {
 	SDL_Overlay *overlay;
@@ -937,6 +1506,9 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 	int i;
 	int CR, CB;
 	Uint32 Rmask, Gmask, Bmask;
+	const char *filter;
+	const char *threads;
+	int num_threads;
 
 	/* Only RGB packed pixel conversion supported */
 	if ( (display->format->BytesPerPixel != 2) &&
@@ -953,6 +1525,8 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 	    case SDL_YUY2_OVERLAY:
 	    case SDL_UYVY_OVERLAY:
 	    case SDL_YVYU_OVERLAY:
+	    case SDL_NV12_OVERLAY:
+	    case SDL_NV21_OVERLAY:
 		break;
 	    default:
 		SDL_SetError("Unsupported YUV format");
@@ -983,8 +1557,22 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 		SDL_FreeYUVOverlay(overlay);
 		return(NULL);
 	}
-	swdata->stretch = NULL;
 	swdata->display = display;
+	swdata->filter = YUV_FILTER_NEAREST;
+	swdata->columns = NULL;
+	swdata->max_columns = 0;
+	swdata->num_threads = 1;
+	swdata->min_pixels = 0;
+	swdata->threads = NULL;
+	swdata->band_start = NULL;
+	swdata->band_done = NULL;
+	swdata->band_lock = NULL;
+	swdata->convert_time = 0;
+	filter = SDL_getenv("SDL_VIDEO_YUV_FILTER");
+	if ( filter && ((SDL_strcasecmp(filter, "linear") == 0) ||
+	                (SDL_strcasecmp(filter, "bilinear") == 0)) ) {
+		swdata->filter = YUV_FILTER_LINEAR;
+	}
 	swdata->pixels = (Uint8 *) SDL_malloc(width*height*2);
 	swdata->colortab = (int *)SDL_malloc(4*256*sizeof(int));
 	Cr_r_tab = &swdata->colortab[0*256];
@@ -1060,6 +1648,8 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 	switch (format) {
 	    case SDL_YV12_OVERLAY:
 	    case SDL_IYUV_OVERLAY:
+	    case SDL_NV12_OVERLAY:
+	    case SDL_NV21_OVERLAY:
 		if ( display->format->BytesPerPixel == 2 ) {
 #if (__GNUC__ > 2) && defined(__i386__) && __OPTIMIZE__ && SDL_ASSEMBLY_ROUTINES
 			/* inline assembly functions */
@@ -1068,7 +1658,7 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 				             (Bmask == 0x001F) &&
 			                     (width & 15) == 0) {
 /*printf("Using MMX 16-bit 565 dither\n");*/
-				swdata->Display1X = Color565DitherYV12MMX1X;
+				swdata->Display1X = Color565DitherYV12MMX1XPitch;
 			} else {
 /*printf("Using C 16-bit dither\n");*/
 				swdata->Display1X = Color16DitherYV12Mod1X;
@@ -1090,7 +1680,7 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 				             (Bmask == 0x000000FF) && 
 			                     (width & 15) == 0) {
 /*printf("Using MMX 32-bit dither\n");*/
-				swdata->Display1X = ColorRGBDitherYV12MMX1X;
+				swdata->Display1X = ColorRGBDitherYV12MMX1XPitch;
 			} else {
 /*printf("Using C 32-bit dither\n");*/
 				swdata->Display1X = Color32DitherYV12Mod1X;
@@ -1121,33 +1711,36 @@ SDL_Overlay *SDL_CreateYUV_SW(_THIS, int width, int height, Uint32 format, SDL_S
 		/* We should never get here (caught above) */
 		break;
 	}
+#if SDL_YUV_SSE2
+	/* The vector converters replace the C ones where the display allows */
+	SDL_YUVSelectSIMD(display->format, format,
+	                  &swdata->Display1X, &swdata->Display2X);
+#endif
 
 	/* Find the pitch and offset values for the overlay */
 	overlay->pitches = swdata->pitches;
 	overlay->pixels = swdata->planes;
-	switch (format) {
-	    case SDL_YV12_OVERLAY:
-	    case SDL_IYUV_OVERLAY:
-		overlay->pitches[0] = overlay->w;
-		overlay->pitches[1] = overlay->pitches[0] / 2;
-		overlay->pitches[2] = overlay->pitches[0] / 2;
-	        overlay->pixels[0] = swdata->pixels;
-	        overlay->pixels[1] = overlay->pixels[0] +
-		                     overlay->pitches[0] * overlay->h;
-	        overlay->pixels[2] = overlay->pixels[1] +
-		                     overlay->pitches[1] * overlay->h / 2;
-		overlay->planes = 3;
-		break;
-	    case SDL_YUY2_OVERLAY:
-	    case SDL_UYVY_OVERLAY:
-	    case SDL_YVYU_OVERLAY:
-		overlay->pitches[0] = overlay->w*2;
-	        overlay->pixels[0] = swdata->pixels;
-		overlay->planes = 1;
-		break;
-	    default:
-		/* We should never get here (caught above) */
-		break;
+	SetupYUVPlanes(overlay);
+
+	/* Convert large frames on several threads if asked to */
+	num_threads = 1;
+	threads = SDL_getenv("SDL_VIDEO_YUV_THREADS");
+	if ( threads ) {
+		num_threads = SDL_atoi(threads);
+		if ( num_threads > YUV_MAX_THREADS ) {
+			num_threads = YUV_MAX_THREADS;
+		}
+		if ( num_threads > height ) {
+			num_threads = height;
+		}
+	}
+	if ( num_threads > 1 ) {
+		swdata->min_pixels = 640*480;
+		threads = SDL_getenv("SDL_VIDEO_YUV_THREAD_MINPIXELS");
+		if ( threads ) {
+			swdata->min_pixels = SDL_atoi(threads);
+		}
+		StartYUVThreads(swdata, num_threads);
 	}
 
 	/* We're all done.. */
@@ -1167,48 +1760,34 @@ void SDL_UnlockYUV_SW(_THIS, SDL_Overlay *overlay)
 int SDL_DisplayYUV_SW(_THIS, SDL_Overlay *overlay, SDL_Rect *src, SDL_Rect *dst)
 {
 	struct private_yuvhwdata *swdata;
-	int stretch;
+	int scaled;
 	int scale_2x;
 	SDL_Surface *display;
 	Uint8 *lum, *Cr, *Cb;
 	Uint8 *dstp;
 	int mod;
+	int retval;
+	Uint32 start;
 
 	swdata = overlay->hwdata;
-	stretch = 0;
+	display = swdata->display;
+	scaled = 0;
 	scale_2x = 0;
 	if ( src->x || src->y || src->w < overlay->w || src->h < overlay->h ) {
 		/* The source rectangle has been clipped.
-		   Using a scratch surface is easier than adding clipped
-		   source support to all the blitters, plus that would
-		   slow them down in the general unclipped case.
+		   Rather than adding clipped source support to all the
+		   converters, which would slow them down in the general
+		   unclipped case, the scaled path handles it.
 		*/
-		stretch = 1;
+		scaled = 1;
 	} else if ( (src->w != dst->w) || (src->h != dst->h) ) {
 		if ( (dst->w == 2*src->w) &&
-		     (dst->h == 2*src->h) ) {
+		     (dst->h == 2*src->h) &&
+		     (swdata->filter == YUV_FILTER_NEAREST) ) {
 			scale_2x = 1;
 		} else {
-			stretch = 1;
-		}
-	}
-	if ( stretch ) {
-		if ( ! swdata->stretch ) {
-			display = swdata->display;
-			swdata->stretch = SDL_CreateRGBSurface(
-				SDL_SWSURFACE,
-				overlay->w, overlay->h,
-				display->format->BitsPerPixel,
-				display->format->Rmask,
-				display->format->Gmask,
-				display->format->Bmask, 0);
-			if ( ! swdata->stretch ) {
-				return(-1);
-			}
+			scaled = 1;
 		}
-		display = swdata->stretch;
-	} else {
-		display = swdata->display;
 	}
 	switch (overlay->format) {
 	    case SDL_YV12_OVERLAY:
@@ -1221,6 +1800,16 @@ int SDL_DisplayYUV_SW(_THIS, SDL_Overlay *overlay, SDL_Rect *src, SDL_Rect *dst)
 		Cr =  overlay->pixels[2];
 		Cb =  overlay->pixels[1];
 		break;
+	    case SDL_NV12_OVERLAY:
+		lum = overlay->pixels[0];
+		Cr =  overlay->pixels[1] + 1;
+		Cb =  overlay->pixels[1];
+		break;
+	    case SDL_NV21_OVERLAY:
+		lum = overlay->pixels[0];
+		Cr =  overlay->pixels[1];
+		Cb =  overlay->pixels[1] + 1;
+		break;
 	    case SDL_YUY2_OVERLAY:
 		lum = overlay->pixels[0];
 		Cr = lum + 3;
@@ -1245,34 +1834,60 @@ int SDL_DisplayYUV_SW(_THIS, SDL_Overlay *overlay, SDL_Rect *src, SDL_Rect *dst)
 			return(-1);
 		}
 	}
-	if ( stretch ) {
-		dstp = (Uint8 *)swdata->stretch->pixels;
+	dstp = (Uint8 *)display->pixels
+		+ dst->x * display->format->BytesPerPixel
+		+ (size_t)dst->y * SDL_SurfacePitch(display);
+	mod = (SDL_SurfacePitch(display) / display->format->BytesPerPixel);
+
+	swdata->frame.overlay = overlay;
+	swdata->frame.lum = lum;
+	swdata->frame.Cr = Cr;
+	swdata->frame.Cb = Cb;
+	swdata->frame.lum_pitch = overlay->pitches[0];
+	if ( overlay->planes > 1 ) {
+		swdata->frame.chroma_pitch = overlay->pitches[1];
+		swdata->frame.chroma_step = (overlay->planes == 2) ? 2 : 1;
 	} else {
-		dstp = (Uint8 *)display->pixels
-			+ dst->x * display->format->BytesPerPixel
-			+ dst->y * display->pitch;
+		swdata->frame.chroma_pitch = overlay->pitches[0];
+		swdata->frame.chroma_step = 4;
 	}
-	mod = (display->pitch / display->format->BytesPerPixel);
-
-	if ( scale_2x ) {
+	swdata->frame.src = src;
+	swdata->frame.dst = dst;
+	swdata->frame.out = dstp;
+	swdata->frame.pitch = SDL_SurfacePitch(display);
+	swdata->frame.bpp = display->format->BytesPerPixel;
+	if ( scaled ) {
+		swdata->frame.scale = 0;
+		swdata->frame.rows = dst->h;
+	} else if ( scale_2x ) {
+		swdata->frame.scale = 2;
+		swdata->frame.rows = overlay->h;
 		mod -= (overlay->w * 2);
-		swdata->Display2X(swdata->colortab, swdata->rgb_2_pix,
-		                  lum, Cr, Cb, dstp, overlay->h, overlay->w, mod);
 	} else {
+		swdata->frame.scale = 1;
+		swdata->frame.rows = overlay->h;
 		mod -= overlay->w;
-		swdata->Display1X(swdata->colortab, swdata->rgb_2_pix,
-		                  lum, Cr, Cb, dstp, overlay->h, overlay->w, mod);
 	}
+	swdata->frame.mod = mod;
+
+	start = SDL_GetTicksUS();
+	retval = 0;
+	if ( scaled ) {
+		retval = SetupYUVColumns(swdata, src, dst->w,
+		                         (overlay->planes > 1) ? 1 : 2,
+		                         swdata->frame.chroma_step);
+	}
+	if ( retval == 0 ) {
+		ConvertYUVFrame(swdata);
+	}
+	swdata->convert_time = SDL_GetTicksUS() - start;
 	if ( SDL_MUSTLOCK(display) ) {
 		SDL_UnlockSurface(display);
 	}
-	if ( stretch ) {
-		display = swdata->display;
-		SDL_SoftStretch(swdata->stretch, src, display, dst);
+	if ( retval == 0 ) {
+		SDL_UpdateRects(display, 1, dst);
 	}
-	SDL_UpdateRects(display, 1, dst);
-
-	return(0);
+	return(retval);
 }
 
 void SDL_FreeYUV_SW(_THIS, SDL_Overlay *overlay)
@@ -1281,8 +1896,9 @@ void SDL_FreeYUV_SW(_THIS, SDL_Overlay *overlay)
 
 	swdata = overlay->hwdata;
 	if ( swdata ) {
-		if ( swdata->stretch ) {
-			SDL_FreeSurface(swdata->stretch);
+		StopYUVThreads(swdata);
+		if ( swdata->columns ) {
+			SDL_free(swdata->columns);
 		}
 		if ( swdata->pixels ) {
 			SDL_free(swdata->pixels);
@@ -1297,3 +1913,66 @@ void SDL_FreeYUV_SW(_THIS, SDL_Overlay *overlay)
 		overlay->hwdata = NULL;
 	}
 }
+
+Uint32 SDL_GetConversionTimeYUV_SW(SDL_Overlay *overlay)
+{
+	if ( overlay->hwfuncs != &sw_yuvfuncs ) {
+		return(0);
+	}
+	return(overlay->hwdata->convert_time);
+}
+
+int SDL_SetPlanesYUV_SW(SDL_Overlay *overlay, Uint8 **pixels, Uint16 *pitches)
+{
+	int min_pitches[3];
+	int i;
+
+	if ( overlay->hwfuncs != &sw_yuvfuncs ) {
+		SDL_SetError("Only software overlays can use external planes");
+		return(-1);
+	}
+	if ( pixels == NULL ) {
+		SetupYUVPlanes(overlay);
+		return(0);
+	}
+	if ( pitches == NULL ) {
+		SDL_SetError("Passed NULL overlay pitches");
+		return(-1);
+	}
+
+	/* The converters need at least a row of samples per pitch */
+	switch (overlay->planes) {
+	    case 3:
+		min_pitches[0] = overlay->w;
+		min_pitches[1] = overlay->w / 2;
+		min_pitches[2] = overlay->w / 2;
+		/* Both chroma planes are walked with the same pitch */
+		if ( pitches[1] != pitches[2] ) {
+			SDL_SetError("The chroma planes must have the same pitch");
+			return(-1);
+		}
+		break;
+	    case 2:
+		min_pitches[0] = overlay->w;
+		min_pitches[1] = overlay->w;
+		break;
+	    default:
+		min_pitches[0] = overlay->w * 2;
+		break;
+	}
+	for ( i = 0; i < overlay->planes; ++i ) {
+		if ( pixels[i] == NULL ) {
+			SDL_SetError("Passed NULL overlay plane");
+			return(-1);
+		}
+		if ( pitches[i] < min_pitches[i] ) {
+			SDL_SetError("Overlay plane pitch is too small");
+			return(-1);
+		}
+	}
+	for ( i = 0; i < overlay->planes; ++i ) {
+		overlay->pixels[i] = pixels[i];
+		overlay->pitches[i] = pitches[i];
+	}
+	return(0);
+}
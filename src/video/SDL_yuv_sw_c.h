@@ -35,3 +35,37 @@ extern void SDL_UnlockYUV_SW(_THIS, SDL_Overlay *overlay);
 extern int SDL_DisplayYUV_SW(_THIS, SDL_Overlay *overlay, SDL_Rect *src, SDL_Rect *dst);
 
 extern void SDL_FreeYUV_SW(_THIS, SDL_Overlay *overlay);
+
+extern Uint32 SDL_GetConversionTimeYUV_SW(SDL_Overlay *overlay);
+
+extern int SDL_SetPlanesYUV_SW(SDL_Overlay *overlay, Uint8 **pixels, Uint16 *pitches);
+
+/* The signature shared by all the colorspace conversion functions.
+   The source pitches are in bytes, and chroma_step is the distance in
+   bytes between neighbouring chroma samples of a planar format (1, or 2
+   for the interleaved chroma of NV12 and NV21).
+ */
+typedef void (*SDL_YUVConverter)(int *colortab, Uint32 *rgb_2_pix,
+                                 unsigned char *lum, unsigned char *cr,
+                                 unsigned char *cb, unsigned char *out,
+                                 int rows, int cols, int mod,
+                                 int lum_pitch, int chroma_pitch,
+                                 int chroma_step);
+
+/* Vector colorspace converters for x86-64 (SDL_yuv_simd.c) */
+#if defined(__GNUC__) && defined(__x86_64__) && SDL_ASSEMBLY_ROUTINES
+#define SDL_YUV_SSE2	1
+#if (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)) || defined(__clang__)
+#define SDL_YUV_AVX2	1
+#endif
+#endif
+
+#if SDL_YUV_SSE2
+/* Fills in the SSE2 or AVX2 converters for the given overlay format and
+   display pixel format, returning 0, or returns -1 if the vector code
+   can't handle the display format.
+ */
+extern int SDL_YUVSelectSIMD(SDL_PixelFormat *format, Uint32 yuv_format,
+                             SDL_YUVConverter *Display1X,
+                             SDL_YUVConverter *Display2X);
+#endif
@@ -149,8 +149,10 @@ void DGA_PumpEvents(_THIS)
 		}
 	}
 
-	while ( X11_Pending(DGA_Display) ) {
-		DGA_DispatchEvent(this);
+	if ( X11_Pending(DGA_Display) ) {
+		do {
+			DGA_DispatchEvent(this);
+		} while ( XEventsQueued(DGA_Display, QueuedAlready) );
 	}
 
 	UNLOCK_DISPLAY();
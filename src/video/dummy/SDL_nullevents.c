@@ -36,6 +36,12 @@ void DUMMY_PumpEvents(_THIS)
 	/* do nothing. */
 }
 
+int DUMMY_GetEventFDs(_THIS, int *fds, int maxfds, Uint32 *timeout)
+{
+	/* No input, only pushed events will wake SDL_WaitEvent() */
+	return(0);
+}
+
 void DUMMY_InitOSKeymap(_THIS)
 {
 	/* do nothing. */
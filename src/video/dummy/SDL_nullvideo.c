@@ -38,9 +38,11 @@
 
 #include "SDL_video.h"
 #include "SDL_mouse.h"
+#include "SDL_timer.h"
 #include "../SDL_sysvideo.h"
 #include "../SDL_pixels_c.h"
 #include "../../events/SDL_events_c.h"
+#include "../../timer/SDL_timer_c.h"
 
 #include "SDL_nullvideo.h"
 #include "SDL_nullevents_c.h"
@@ -60,9 +62,11 @@ static int DUMMY_AllocHWSurface(_THIS, SDL_Surface *surface);
 static int DUMMY_LockHWSurface(_THIS, SDL_Surface *surface);
 static void DUMMY_UnlockHWSurface(_THIS, SDL_Surface *surface);
 static void DUMMY_FreeHWSurface(_THIS, SDL_Surface *surface);
+static int DUMMY_FlipHWSurface(_THIS, SDL_Surface *surface);
 
 /* etc. */
 static void DUMMY_UpdateRects(_THIS, int numrects, SDL_Rect *rects);
+static int DUMMY_GetFrame(_THIS, int index, SDL_FrameInfo *info, SDL_Surface **capture);
 
 /* DUMMY driver bootstrap functions */
 
@@ -109,6 +113,7 @@ static SDL_VideoDevice *DUMMY_CreateDevice(int devindex)
 	device->CreateYUVOverlay = NULL;
 	device->SetColors = DUMMY_SetColors;
 	device->UpdateRects = DUMMY_UpdateRects;
+	device->GetFrame = DUMMY_GetFrame;
 	device->VideoQuit = DUMMY_VideoQuit;
 	device->AllocHWSurface = DUMMY_AllocHWSurface;
 	device->CheckHWBlit = NULL;
@@ -117,7 +122,7 @@ static SDL_VideoDevice *DUMMY_CreateDevice(int devindex)
 	device->SetHWAlpha = NULL;
 	device->LockHWSurface = DUMMY_LockHWSurface;
 	device->UnlockHWSurface = DUMMY_UnlockHWSurface;
-	device->FlipHWSurface = NULL;
+	device->FlipHWSurface = DUMMY_FlipHWSurface;
 	device->FreeHWSurface = DUMMY_FreeHWSurface;
 	device->SetCaption = NULL;
 	device->SetIcon = NULL;
@@ -126,6 +131,7 @@ static SDL_VideoDevice *DUMMY_CreateDevice(int devindex)
 	device->GetWMInfo = NULL;
 	device->InitOSKeymap = DUMMY_InitOSKeymap;
 	device->PumpEvents = DUMMY_PumpEvents;
+	device->GetEventFDs = DUMMY_GetEventFDs;
 
 	device->free = DUMMY_DeleteDevice;
 
@@ -158,14 +164,60 @@ SDL_Rect **DUMMY_ListModes(_THIS, SDL_PixelFormat *format, Uint32 flags)
    	 return (SDL_Rect **) -1;
 }
 
+/* Allocate the frame ring, if SDL_VIDEO_DUMMY_FRAMES asks for one */
+static int DUMMY_AllocFrames(_THIS, size_t len)
+{
+	const char *envr = SDL_getenv("SDL_VIDEO_DUMMY_FRAMES");
+	int i, num;
+
+	num = envr ? SDL_atoi(envr) : 0;
+	if ( num <= 0 ) {
+		return(0);
+	}
+	this->hidden->frames = (DUMMY_Frame *)SDL_malloc(num * sizeof(DUMMY_Frame));
+	this->hidden->frame_mem = (Uint8 *)SDL_malloc(num * len);
+	if ( !this->hidden->frames || !this->hidden->frame_mem ) {
+		SDL_free(this->hidden->frames);
+		SDL_free(this->hidden->frame_mem);
+		this->hidden->frames = NULL;
+		this->hidden->frame_mem = NULL;
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	SDL_memset(this->hidden->frames, 0, num * sizeof(DUMMY_Frame));
+	for ( i = 0; i < num; ++i ) {
+		this->hidden->frames[i].pixels = this->hidden->frame_mem + i*len;
+	}
+	this->hidden->num_frames = num;
+	return(0);
+}
+
+static void DUMMY_FreeFrames(_THIS)
+{
+	SDL_free(this->hidden->frames);
+	SDL_free(this->hidden->frame_mem);
+	this->hidden->frames = NULL;
+	this->hidden->frame_mem = NULL;
+	this->hidden->num_frames = 0;
+	this->hidden->frames_kept = 0;
+	this->hidden->next_frame = 0;
+	this->hidden->frame_count = 0;
+}
+
 SDL_Surface *DUMMY_SetVideoMode(_THIS, SDL_Surface *current,
 				int width, int height, int bpp, Uint32 flags)
 {
+	int pitch = width * ((bpp + 7) / 8);
+	size_t len = (size_t)pitch * height;
+	int pages = (flags & SDL_DOUBLEBUF) ? 2 : 1;
+
+	DUMMY_FreeFrames(this);
 	if ( this->hidden->buffer ) {
 		SDL_free( this->hidden->buffer );
+		this->hidden->buffer = NULL;
 	}
 
-	this->hidden->buffer = SDL_malloc(width * height * (bpp / 8));
+	this->hidden->buffer = SDL_malloc(len * pages);
 	if ( ! this->hidden->buffer ) {
 		SDL_SetError("Couldn't allocate buffer for requested mode");
 		return(NULL);
@@ -173,7 +225,7 @@ SDL_Surface *DUMMY_SetVideoMode(_THIS, SDL_Surface *current,
 
 /* 	printf("Setting mode %dx%d\n", width, height); */
 
-	SDL_memset(this->hidden->buffer, 0, width * height * (bpp / 8));
+	SDL_memset(this->hidden->buffer, 0, len * pages);
 
 	/* Allocate the new pixel format for the screen */
 	if ( ! SDL_ReallocFormat(current, bpp, 0, 0, 0, 0) ) {
@@ -183,11 +235,23 @@ SDL_Surface *DUMMY_SetVideoMode(_THIS, SDL_Surface *current,
 		return(NULL);
 	}
 
+	if ( DUMMY_AllocFrames(this, len) < 0 ) {
+		SDL_free(this->hidden->buffer);
+		this->hidden->buffer = NULL;
+		return(NULL);
+	}
+
 	/* Set up the new mode framebuffer */
 	current->flags = flags & SDL_FULLSCREEN;
+	if ( flags & SDL_DOUBLEBUF ) {
+		current->flags |= SDL_HWSURFACE | SDL_DOUBLEBUF;
+		this->hidden->flip_page = 0;
+		this->hidden->flip_address[0] = (Uint8 *)this->hidden->buffer;
+		this->hidden->flip_address[1] = (Uint8 *)this->hidden->buffer + len;
+	}
 	this->hidden->w = current->w = width;
 	this->hidden->h = current->h = height;
-	current->pitch = current->w * (bpp / 8);
+	current->pitch = pitch;
 	current->pixels = this->hidden->buffer;
 
 	/* We're done */
@@ -215,9 +279,151 @@ static void DUMMY_UnlockHWSurface(_THIS, SDL_Surface *surface)
 	return;
 }
 
+/* Copy a presented frame into the frame ring */
+static void DUMMY_KeepFrame(_THIS, const Uint8 *pixels)
+{
+	struct SDL_PrivateVideoData *hidden = this->hidden;
+	SDL_Surface *screen = this->screen;
+	SDL_Palette *pal = screen->format->palette;
+	DUMMY_Frame *frame;
+	Uint32 start;
+
+	if ( !hidden->num_frames ) {
+		return;
+	}
+	start = SDL_GetTicksUS();
+
+	frame = &hidden->frames[hidden->next_frame];
+	SDL_memcpy(frame->pixels, pixels, (size_t)screen->pitch * screen->h);
+	if ( pal ) {
+		frame->ncolors = pal->ncolors;
+		SDL_memcpy(frame->colors, pal->colors,
+		           pal->ncolors * sizeof(SDL_Color));
+	} else {
+		frame->ncolors = 0;
+	}
+	frame->checksummed = 0;
+	frame->info.checksum = 0;
+	frame->info.frame = ++hidden->frame_count;
+	frame->info.ticks = SDL_GetTicks();
+	if ( hidden->frame_count > 1 ) {
+		frame->info.interval = start - hidden->last_present;
+	} else {
+		frame->info.interval = 0;
+	}
+	hidden->last_present = start;
+
+	hidden->next_frame = (hidden->next_frame + 1) % hidden->num_frames;
+	if ( hidden->frames_kept < hidden->num_frames ) {
+		++hidden->frames_kept;
+	}
+	frame->info.present_time = SDL_GetTicksUS() - start;
+}
+
+static int DUMMY_FlipHWSurface(_THIS, SDL_Surface *surface)
+{
+	DUMMY_KeepFrame(this, (Uint8 *)surface->pixels);
+
+	this->hidden->flip_page = !this->hidden->flip_page;
+	surface->pixels = this->hidden->flip_address[this->hidden->flip_page];
+	return(0);
+}
+
 static void DUMMY_UpdateRects(_THIS, int numrects, SDL_Rect *rects)
 {
-	/* do nothing. */
+	if ( numrects > 0 ) {
+		DUMMY_KeepFrame(this, (Uint8 *)this->screen->pixels);
+	}
+}
+
+/* The usual CRC-32, as used by zlib and PNG */
+static Uint32 DUMMY_CRC32(Uint32 crc, const Uint8 *data, size_t len)
+{
+	static Uint32 table[256];
+	Uint32 c;
+	int n, k;
+
+	if ( !table[1] ) {
+		for ( n = 0; n < 256; ++n ) {
+			c = (Uint32)n;
+			for ( k = 0; k < 8; ++k ) {
+				c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+			}
+			table[n] = c;
+		}
+	}
+	crc = ~crc;
+	while ( len-- ) {
+		crc = table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+	}
+	return(~crc);
+}
+
+static int DUMMY_GetFrame(_THIS, int index, SDL_FrameInfo *info,
+                          SDL_Surface **capture)
+{
+	struct SDL_PrivateVideoData *hidden = this->hidden;
+	SDL_Surface *screen = this->screen;
+	DUMMY_Frame *frame;
+	int i;
+
+	if ( !hidden->num_frames ) {
+		SDL_SetError("Set SDL_VIDEO_DUMMY_FRAMES to keep presented frames");
+		return(-1);
+	}
+	if ( (index < 0) || (index >= hidden->frames_kept) ) {
+		SDL_SetError("Frame %d is not available", index);
+		return(-1);
+	}
+	frame = &hidden->frames[(hidden->next_frame - 1 - index +
+	                         hidden->num_frames) % hidden->num_frames];
+
+	if ( !frame->checksummed ) {
+		Uint32 crc;
+
+		crc = DUMMY_CRC32(0, frame->pixels,
+		                  (size_t)screen->pitch * screen->h);
+		for ( i = 0; i < frame->ncolors; ++i ) {
+			Uint8 rgb[3];
+
+			rgb[0] = frame->colors[i].r;
+			rgb[1] = frame->colors[i].g;
+			rgb[2] = frame->colors[i].b;
+			crc = DUMMY_CRC32(crc, rgb, 3);
+		}
+		frame->info.checksum = crc;
+		frame->checksummed = 1;
+	}
+
+	if ( capture ) {
+		SDL_PixelFormat *format = screen->format;
+		SDL_Surface *surface;
+		Uint8 *src, *dst;
+
+		surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
+		                               screen->w, screen->h,
+		                               format->BitsPerPixel,
+		                               format->Rmask, format->Gmask,
+		                               format->Bmask, format->Amask);
+		if ( surface == NULL ) {
+			return(-1);
+		}
+		src = frame->pixels;
+		dst = (Uint8 *)surface->pixels;
+		for ( i = 0; i < screen->h; ++i ) {
+			SDL_memcpy(dst, src, screen->pitch);
+			src += screen->pitch;
+			dst += surface->pitch;
+		}
+		if ( frame->ncolors ) {
+			SDL_SetColors(surface, frame->colors, 0, frame->ncolors);
+		}
+		*capture = surface;
+	}
+	if ( info ) {
+		*info = frame->info;
+	}
+	return(0);
 }
 
 int DUMMY_SetColors(_THIS, int firstcolor, int ncolors, SDL_Color *colors)
@@ -231,9 +437,11 @@ int DUMMY_SetColors(_THIS, int firstcolor, int ncolors, SDL_Color *colors)
 */
 void DUMMY_VideoQuit(_THIS)
 {
-	if (this->screen->pixels != NULL)
+	DUMMY_FreeFrames(this);
+	if (this->hidden->buffer != NULL)
 	{
-		SDL_free(this->screen->pixels);
+		SDL_free(this->hidden->buffer);
+		this->hidden->buffer = NULL;
 		this->screen->pixels = NULL;
 	}
 }
@@ -30,11 +30,33 @@
 #define _THIS	SDL_VideoDevice *this
 
 
+/* A presented frame kept in the frame ring */
+typedef struct DUMMY_Frame {
+    SDL_FrameInfo info;
+    int checksummed;		/* info.checksum is up to date */
+    int ncolors;
+    SDL_Color colors[256];
+    Uint8 *pixels;
+} DUMMY_Frame;
+
 /* Private display data */
 
 struct SDL_PrivateVideoData {
     int w, h;
     void *buffer;
+
+    /* SDL_DOUBLEBUF pages within buffer */
+    int flip_page;
+    Uint8 *flip_address[2];
+
+    /* The last SDL_VIDEO_DUMMY_FRAMES presented frames */
+    int num_frames;
+    int frames_kept;
+    int next_frame;
+    Uint32 frame_count;
+    Uint32 last_present;
+    DUMMY_Frame *frames;
+    Uint8 *frame_mem;
 };
 
 #endif /* _SDL_nullvideo_h */
@@ -1087,6 +1087,23 @@ void FB_PumpEvents(_THIS)
 	} while ( posted );
 }
 
+int FB_GetEventFDs(_THIS, int *fds, int maxfds, Uint32 *timeout)
+{
+	int nfds = 0;
+
+	/* Watch for switching back to our console */
+	if ( switched_away && *timeout > 10 ) {
+		*timeout = 10;
+	}
+	if ( keyboard_fd >= 0 && nfds < maxfds ) {
+		fds[nfds++] = keyboard_fd;
+	}
+	if ( mouse_fd >= 0 && nfds < maxfds ) {
+		fds[nfds++] = mouse_fd;
+	}
+	return(nfds);
+}
+
 void FB_InitOSKeymap(_THIS)
 {
 	int i;
@@ -40,6 +40,7 @@
 #include "SDL_mouse.h"
 #include "../SDL_sysvideo.h"
 #include "../SDL_pixels_c.h"
+#include "../SDL_tile_c.h"
 #include "../../events/SDL_events_c.h"
 #include "SDL_fbvideo.h"
 #include "SDL_fbmouse_c.h"
@@ -133,8 +134,6 @@ enum {
 	FBCON_ROTATE_CW = 270
 };
 
-#define min(a,b) ((a)<(b)?(a):(b))
-
 /* Initialization/Query functions */
 static int FB_VideoInit(_THIS, SDL_PixelFormat *vformat);
 static SDL_Rect **FB_ListModes(_THIS, SDL_PixelFormat *format, Uint32 flags);
@@ -161,10 +160,6 @@ static void FB_SavePalette(_THIS, struct fb_fix_screeninfo *finfo,
                                   struct fb_var_screeninfo *vinfo);
 static void FB_RestorePalette(_THIS);
 
-/* Shadow buffer functions */
-static FB_bitBlit FB_blit16;
-static FB_bitBlit FB_blit16blocked;
-
 static int SDL_getpagesize(void)
 {
 #ifdef HAVE_GETPAGESIZE
@@ -269,6 +264,7 @@ static SDL_VideoDevice *FB_CreateDevice(int devindex)
 	this->GetWMInfo = NULL;
 	this->InitOSKeymap = FB_InitOSKeymap;
 	this->PumpEvents = FB_PumpEvents;
+	this->GetEventFDs = FB_GetEventFDs;
 
 	this->free = FB_DeleteDevice;
 
@@ -1113,11 +1109,7 @@ static SDL_Surface *FB_SetVideoMode(_THIS, SDL_Surface *current,
 	FB_SavePalette(this, &finfo, &vinfo);
 
 	if (shadow_fb) {
-		if (vinfo.bits_per_pixel == 16) {
-			blitFunc = (rotate == FBCON_ROTATE_NONE ||
-					rotate == FBCON_ROTATE_UD) ?
-				FB_blit16 : FB_blit16blocked;
-		} else {
+		if ( (vinfo.bits_per_pixel % 8) != 0 ) {
 #ifdef FBCON_DEBUG
 			fprintf(stderr, "Init vinfo:\n");
 			print_vinfo(&vinfo);
@@ -1442,57 +1434,6 @@ static int FB_FlipHWSurface(_THIS, SDL_Surface *surface)
 	return(0);
 }
 
-static void FB_blit16(Uint8 *byte_src_pos, int src_right_delta, int src_down_delta,
-		Uint8 *byte_dst_pos, int dst_linebytes, int width, int height)
-{
-	int w;
-	Uint16 *src_pos = (Uint16 *)byte_src_pos;
-	Uint16 *dst_pos = (Uint16 *)byte_dst_pos;
-
-	while (height) {
-		Uint16 *src = src_pos;
-		Uint16 *dst = dst_pos;
-		for (w = width; w != 0; w--) {
-			*dst = *src;
-			src += src_right_delta;
-			dst++;
-		}
-		dst_pos = (Uint16 *)((Uint8 *)dst_pos + dst_linebytes);
-		src_pos += src_down_delta;
-		height--;
-	}
-}
-
-#define BLOCKSIZE_W 32
-#define BLOCKSIZE_H 32
-
-static void FB_blit16blocked(Uint8 *byte_src_pos, int src_right_delta, int src_down_delta, 
-		Uint8 *byte_dst_pos, int dst_linebytes, int width, int height)
-{
-	int w;
-	Uint16 *src_pos = (Uint16 *)byte_src_pos;
-	Uint16 *dst_pos = (Uint16 *)byte_dst_pos;
-
-	while (height > 0) {
-		Uint16 *src = src_pos;
-		Uint16 *dst = dst_pos;
-		for (w = width; w > 0; w -= BLOCKSIZE_W) {
-			FB_blit16((Uint8 *)src,
-					src_right_delta,
-					src_down_delta,
-					(Uint8 *)dst,
-					dst_linebytes,
-					min(w, BLOCKSIZE_W),
-					min(height, BLOCKSIZE_H));
-			src += src_right_delta * BLOCKSIZE_W;
-			dst += BLOCKSIZE_W;
-		}
-		dst_pos = (Uint16 *)((Uint8 *)dst_pos + dst_linebytes * BLOCKSIZE_H);
-		src_pos += src_down_delta * BLOCKSIZE_H;
-		height -= BLOCKSIZE_H;
-	}
-}
-
 static void FB_DirectUpdate(_THIS, int numrects, SDL_Rect *rects)
 {
 	int width = cache_vinfo.xres;
@@ -1505,11 +1446,6 @@ static void FB_DirectUpdate(_THIS, int numrects, SDL_Rect *rects)
 		return;
 	}
 
-	if (cache_vinfo.bits_per_pixel != 16) {
-		SDL_SetError("Shadow copy only implemented for 16 bpp");
-		return;
-	}
-
 	for (i = 0; i < numrects; i++) {
 		int x1, y1, x2, y2;
 		int scr_x1, scr_y1, scr_x2, scr_y2;
@@ -1597,11 +1533,12 @@ static void FB_DirectUpdate(_THIS, int numrects, SDL_Rect *rects)
 		dst_start = mapped_mem + mapped_offset + scr_y1 * physlinebytes + 
 			scr_x1 * bytes_per_pixel;
 
-		blitFunc((Uint8 *) src_start,
-				shadow_right_delta, 
-				shadow_down_delta, 
+		SDL_TileCopy((Uint8 *) src_start,
+				shadow_right_delta * bytes_per_pixel,
+				shadow_down_delta * bytes_per_pixel,
 				(Uint8 *) dst_start,
 				physlinebytes,
+				bytes_per_pixel,
 				scr_x2 - scr_x1,
 				scr_y2 - scr_y1);
 	}
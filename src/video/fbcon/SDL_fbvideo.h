@@ -38,15 +38,6 @@
 /* Hidden "this" pointer for the video functions */
 #define _THIS	SDL_VideoDevice *this
 
-typedef void FB_bitBlit(
-		Uint8 *src_pos,
-		int src_right_delta,	/* pixels, not bytes */
-		int src_down_delta,		/* pixels, not bytes */
-		Uint8 *dst_pos,
-		int dst_linebytes,
-		int width,
-		int height);
-
 /* This is the structure we use to keep track of video memory */
 typedef struct vidmem_bucket {
 	struct vidmem_bucket *prev;
@@ -86,7 +77,6 @@ struct SDL_PrivateVideoData {
 	char *flip_address[2];
 	int rotate;
 	int shadow_fb;				/* Tells whether a shadow is being used. */
-	FB_bitBlit *blitFunc;
 	int physlinebytes;			/* Length of a line in bytes in physical fb */
 
 #define NUM_MODELISTS	4		/* 8, 16, 24, and 32 bits-per-pixel */
@@ -132,7 +122,6 @@ struct SDL_PrivateVideoData {
 #define flip_address		(this->hidden->flip_address)
 #define rotate			(this->hidden->rotate)
 #define shadow_fb		(this->hidden->shadow_fb)
-#define blitFunc		(this->hidden->blitFunc)
 #define physlinebytes		(this->hidden->physlinebytes)
 #define SDL_nummodes		(this->hidden->SDL_nummodes)
 #define SDL_modelist		(this->hidden->SDL_modelist)
@@ -391,6 +391,42 @@ static __inline__ int X11_WarpedMotion(_THIS, XEvent *xevent)
 	return(posted);
 }
 
+/* Stamp the events queued for an input event with the time it happened.
+   X server timestamps are milliseconds on the server's clock, so they are
+   moved to SDL_GetTicks() time by the smallest difference seen, from the
+   event that took the least time to arrive.
+ */
+static void X11_SetEventTime(XEvent *xevent)
+{
+	static Sint32 offset;
+	static int have_offset = 0;
+	Uint32 time, now;
+	Sint32 difference;
+
+	switch (xevent->type) {
+	    case KeyPress:
+	    case KeyRelease:
+		time = xevent->xkey.time;
+		break;
+	    case ButtonPress:
+	    case ButtonRelease:
+		time = xevent->xbutton.time;
+		break;
+	    case MotionNotify:
+		time = xevent->xmotion.time;
+		break;
+	    default:
+		return;
+	}
+	now = SDL_GetTicks();
+	difference = (Sint32)(now - time);
+	if ( !have_offset || difference < offset ) {
+		offset = difference;
+		have_offset = 1;
+	}
+	SDL_SetEventTimestamp((time + offset) * 1000);
+}
+
 static int X11_DispatchEvent(_THIS)
 {
 	int posted;
@@ -417,6 +453,8 @@ static int X11_DispatchEvent(_THIS)
 	}
 #endif
 
+	X11_SetEventTime(&xevent);
+
 	posted = 0;
 	switch (xevent.type) {
 
@@ -899,16 +937,28 @@ printf("Unhandled event %d\n", xevent.type);
 	    }
 	    break;
 	}
+	SDL_ClearEventTimestamp();
 	return(posted);
 }
 
-/* Ack!  XPending() actually performs a blocking read if no events available */
+/* Flush the display connection once and read everything X has sent so
+   far, returning the number of events queued.  Callers dispatch that whole
+   batch, checking XEventsQueued(display, QueuedAlready) between events,
+   which doesn't touch the connection, rather than coming back here (and
+   to the socket) for every event.
+
+   Ack!  XPending() actually performs a blocking read if no events are
+   available, so only read after select() says X is ready to talk.
+ */
 int X11_Pending(Display *display)
 {
+	int pending;
+
 	/* Flush the display connection and look to see if events are queued */
 	XFlush(display);
-	if ( XEventsQueued(display, QueuedAlready) ) {
-		return(1);
+	pending = XEventsQueued(display, QueuedAlready);
+	if ( pending ) {
+		return(pending);
 	}
 
 	/* More drastic measures are required -- see if X is ready to talk */
@@ -921,7 +971,7 @@ int X11_Pending(Display *display)
 		FD_ZERO(&fdset);
 		FD_SET(x11_fd, &fdset);
 		if ( select(x11_fd+1, &fdset, NULL, NULL, &zero_time) == 1 ) {
-			return(XPending(display));
+			return(XEventsQueued(display, QueuedAfterReading));
 		}
 	}
 
@@ -943,11 +993,16 @@ void X11_PumpEvents(_THIS)
 		}
 	}
 
-	/* Keep processing pending events */
+	/* Process the batch of pending events.  Events that arrive meanwhile
+	   are left for the next pump, so this costs a fixed number of calls
+	   into the X connection however many events come in.
+	 */
 	pending = 0;
-	while ( X11_Pending(SDL_Display) ) {
-		X11_DispatchEvent(this);
-		++pending;
+	if ( X11_Pending(SDL_Display) ) {
+		do {
+			X11_DispatchEvent(this);
+			++pending;
+		} while ( XEventsQueued(SDL_Display, QueuedAlready) );
 	}
 	if ( switch_waiting ) {
 		Uint32 now;
@@ -983,6 +1038,32 @@ void X11_PumpEvents(_THIS)
 	}
 }
 
+int X11_GetEventFDs(_THIS, int *fds, int maxfds, Uint32 *timeout)
+{
+	/* Events Xlib already read won't make the connection readable */
+	XFlush(SDL_Display);
+	if ( XEventsQueued(SDL_Display, QueuedAlready) ) {
+		return(-1);
+	}
+
+	/* X11_PumpEvents() has timed work to do */
+	if ( switch_waiting ) {
+		Sint32 left = (Sint32)(switch_time - SDL_GetTicks());
+		if ( left <= 0 ) {
+			return(-1);
+		}
+		if ( (Uint32)left < *timeout ) {
+			*timeout = left;
+		}
+	}
+	if ( !allow_screensaver && *timeout > 5000 ) {
+		*timeout = 5000;
+	}
+
+	fds[0] = ConnectionNumber(SDL_Display);
+	return(1);
+}
+
 void X11_InitKeymap(void)
 {
 	int i;
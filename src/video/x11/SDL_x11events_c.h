@@ -26,6 +26,7 @@
 /* Functions to be exported */
 extern void X11_InitOSKeymap(_THIS);
 extern void X11_PumpEvents(_THIS);
+extern int X11_GetEventFDs(_THIS, int *fds, int maxfds, Uint32 *timeout);
 extern void X11_SetKeyboardState(Display *display, const char *key_vec);
 
 /* Variables to be exported */
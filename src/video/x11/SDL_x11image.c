@@ -22,10 +22,13 @@
 #include "SDL_config.h"
 
 #include <stdio.h>
+#include <sys/types.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #include "SDL_endian.h"
 #include "../../events/SDL_events_c.h"
+#include "../../timer/SDL_timer_c.h"
 #include "SDL_x11image_c.h"
 
 #ifndef NO_SHARED_MEMORY
@@ -42,39 +45,170 @@ static int shm_errhandler(Display *d, XErrorEvent *e)
 		return(X_handler(d,e));
 }
 
-static void try_mitshm(_THIS, SDL_Surface *screen)
+/* Create a shared memory segment and attach it to the X server */
+static int attach_shm(_THIS, XShmSegmentInfo *info, int size)
 {
-	/* Dynamic X11 may not have SHM entry points on this box. */
-	if ((use_mitshm) && (!SDL_X11_HAVE_SHM))
-		use_mitshm = 0;
-
-	if(!use_mitshm)
-		return;
-	shminfo.shmid = shmget(IPC_PRIVATE, screen->h*screen->pitch,
-			       IPC_CREAT | 0777);
-	if ( shminfo.shmid >= 0 ) {
-		shminfo.shmaddr = (char *)shmat(shminfo.shmid, 0, 0);
-		shminfo.readOnly = False;
-		if ( shminfo.shmaddr != (char *)-1 ) {
+	info->shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0777);
+	if ( info->shmid >= 0 ) {
+		info->shmaddr = (char *)shmat(info->shmid, 0, 0);
+		info->readOnly = False;
+		if ( info->shmaddr != (char *)-1 ) {
 			shm_error = False;
 			X_handler = XSetErrorHandler(shm_errhandler);
-			XShmAttach(SDL_Display, &shminfo);
+			XShmAttach(SDL_Display, info);
 			XSync(SDL_Display, True);
 			XSetErrorHandler(X_handler);
 			if ( shm_error )
-				shmdt(shminfo.shmaddr);
+				shmdt(info->shmaddr);
 		} else {
 			shm_error = True;
 		}
-		shmctl(shminfo.shmid, IPC_RMID, NULL);
+		shmctl(info->shmid, IPC_RMID, NULL);
 	} else {
 		shm_error = True;
 	}
-	if ( shm_error )
+	return(shm_error ? -1 : 0);
+}
+
+static void try_mitshm(_THIS, SDL_Surface *screen)
+{
+	/* Dynamic X11 may not have SHM entry points on this box. */
+	if ((use_mitshm) && (!SDL_X11_HAVE_SHM))
+		use_mitshm = 0;
+
+	if(!use_mitshm)
+		return;
+	if ( attach_shm(this, &shminfo, screen->h*screen->pitch) < 0 )
 		use_mitshm = 0;
 	if ( use_mitshm )
 		screen->pixels = shminfo.shmaddr;
 }
+
+static void X11_FreeSHMBuffers(_THIS)
+{
+	int i;
+
+	if ( !shm_nbuffers ) {
+		return;
+	}
+	/* Let the server finish with the buffers, and drop the completion
+	   events that are still queued for them.
+	 */
+	XSync(GFX_Display, True);
+	for ( i = 0; i < shm_nbuffers; ++i ) {
+		XDestroyImage(shm_buffers[i].image);
+		XShmDetach(SDL_Display, &shm_buffers[i].info);
+	}
+	XSync(SDL_Display, False);
+	for ( i = 0; i < shm_nbuffers; ++i ) {
+		shmdt(shm_buffers[i].info.shmaddr);
+	}
+	shm_nbuffers = 0;
+}
+
+/* Set up the segments for pipelined updates, SDL_VIDEO_X11_SHM_BUFFERS
+   deep, or leave shm_nbuffers at 0 to wait for every update with XSync()
+ */
+static void X11_SetupSHMBuffers(_THIS, SDL_Surface *screen)
+{
+	const char *env = SDL_getenv("SDL_VIDEO_X11_SHM_BUFFERS");
+	int i, n = 2;
+
+	if ( env ) {
+		n = SDL_atoi(env);
+		if ( n > SDL_X11_MAX_SHM_BUFFERS ) {
+			n = SDL_X11_MAX_SHM_BUFFERS;
+		}
+	}
+	shm_nbuffers = 0;
+	shm_next = 0;
+	shm_completion = XShmGetEventBase(GFX_Display) + ShmCompletion;
+	for ( i = 0; i < n; ++i ) {
+		XShmSegmentInfo *info = &shm_buffers[i].info;
+
+		if ( attach_shm(this, info, SDL_Ximage->height *
+		                            SDL_Ximage->bytes_per_line) < 0 ) {
+			break;
+		}
+		shm_buffers[i].image = XShmCreateImage(SDL_Display, SDL_Visual,
+					this->hidden->depth, ZPixmap,
+					info->shmaddr, info,
+					screen->w, screen->h);
+		if ( !shm_buffers[i].image ||
+		     shm_buffers[i].image->bytes_per_line != SDL_Ximage->bytes_per_line ) {
+			if ( shm_buffers[i].image ) {
+				XDestroyImage(shm_buffers[i].image);
+			}
+			XShmDetach(SDL_Display, info);
+			XSync(SDL_Display, False);
+			shmdt(info->shmaddr);
+			break;
+		}
+		shm_buffers[i].busy = 0;
+		++shm_nbuffers;
+	}
+	/* A single buffer can't overlap anything, fall back to XSync() */
+	if ( shm_nbuffers < 2 ) {
+		X11_FreeSHMBuffers(this);
+	}
+	present_stats.buffers = shm_nbuffers;
+}
+
+/* Mark the buffer a ShmCompletion event is for as free */
+static void X11_SHMCompleted(_THIS, XEvent *event)
+{
+	XShmCompletionEvent *completion = (XShmCompletionEvent *)event;
+	int i;
+
+	for ( i = 0; i < shm_nbuffers; ++i ) {
+		if ( shm_buffers[i].info.shmseg == completion->shmseg ) {
+			shm_buffers[i].busy = 0;
+		}
+	}
+}
+
+/* Wait for the next buffer's ShmCompletion event.  A put that failed
+   never sends one, so give up after a while and fall back on XSync(),
+   after which the server is done with every buffer.
+ */
+#define SHM_COMPLETION_TIMEOUT	100	/* milliseconds */
+
+static void X11_WaitForSHMBuffer(_THIS)
+{
+	int x11_fd = ConnectionNumber(GFX_Display);
+	Uint32 start = SDL_GetTicksUS();
+	Uint32 waited;
+	XEvent event;
+	int i;
+
+	XFlush(GFX_Display);
+	while ( shm_buffers[shm_next].busy ) {
+		struct timeval tv;
+		fd_set fdset;
+
+		waited = SDL_GetTicksUS() - start;
+		if ( waited >= SHM_COMPLETION_TIMEOUT*1000 ) {
+			XSync(GFX_Display, False);
+			while ( XCheckTypedEvent(GFX_Display, shm_completion, &event) ) {
+				/* The XSync() covers it */
+			}
+			for ( i = 0; i < shm_nbuffers; ++i ) {
+				shm_buffers[i].busy = 0;
+			}
+			break;
+		}
+		tv.tv_sec = 0;
+		tv.tv_usec = SHM_COMPLETION_TIMEOUT*1000 - waited;
+		FD_ZERO(&fdset);
+		FD_SET(x11_fd, &fdset);
+		select(x11_fd+1, &fdset, NULL, NULL, &tv);
+		while ( XCheckTypedEvent(GFX_Display, shm_completion, &event) ) {
+			X11_SHMCompleted(this, &event);
+		}
+	}
+	++present_stats.waits;
+	present_stats.wait_time += SDL_GetTicksUS() - start;
+}
 #endif /* ! NO_SHARED_MEMORY */
 
 /* Various screen update functions available */
@@ -97,6 +231,7 @@ int X11_SetupImage(_THIS, SDL_Surface *screen)
 			screen->pixels = NULL;
 			goto error;
 		}
+		X11_SetupSHMBuffers(this, screen);
 		this->UpdateRects = X11_MITSHMUpdate;
 	}
 	if(!use_mitshm)
@@ -120,6 +255,10 @@ int X11_SetupImage(_THIS, SDL_Surface *screen)
 		this->UpdateRects = X11_NormalUpdate;
 	}
 	screen->pitch = SDL_Ximage->bytes_per_line;
+	SDL_memset(&present_stats, 0, sizeof(present_stats));
+#ifndef NO_SHARED_MEMORY
+	present_stats.buffers = shm_nbuffers;
+#endif
 	return(0);
 
 error:
@@ -132,6 +271,7 @@ void X11_DestroyImage(_THIS, SDL_Surface *screen)
 	if ( SDL_Ximage ) {
 		XDestroyImage(SDL_Ximage);
 #ifndef NO_SHARED_MEMORY
+		X11_FreeSHMBuffers(this);
 		if ( use_mitshm ) {
 			XShmDetach(SDL_Display, &shminfo);
 			XSync(SDL_Display, False);
@@ -230,6 +370,12 @@ int X11_FlipHWSurface(_THIS, SDL_Surface *surface)
 	return(0);
 }
 
+int X11_GetPresentStats(_THIS, SDL_PresentStats *stats)
+{
+	*stats = present_stats;
+	return(0);
+}
+
 static void X11_NormalUpdate(_THIS, int numrects, SDL_Rect *rects)
 {
 	int i;
@@ -248,13 +394,78 @@ static void X11_NormalUpdate(_THIS, int numrects, SDL_Rect *rects)
 	} else {
 		XSync(GFX_Display, False);
 	}
+	++present_stats.presents;
 }
 
+#ifndef NO_SHARED_MEMORY
+/* Copy the rectangles to the next free segment and put them from there,
+   asking for a ShmCompletion event after the last one instead of waiting
+   for the server to read them.
+ */
+static void X11_MITSHMPipelinedUpdate(_THIS, int numrects, SDL_Rect *rects)
+{
+	XImage *image = shm_buffers[shm_next].image;
+	int bpp = SDL_Ximage->bits_per_pixel / 8;
+	int pitch = SDL_Ximage->bytes_per_line;
+	XEvent event;
+	int i, y, last;
+
+	/* Find the last rectangle, the one the completion is asked for */
+	last = -1;
+	for ( i=0; i<numrects; ++i ) {
+		if ( rects[i].w && rects[i].h ) {
+			last = i;
+		}
+	}
+	if ( last < 0 ) {
+		return;
+	}
+
+	/* Collect the completions that already arrived */
+	while ( XCheckTypedEvent(GFX_Display, shm_completion, &event) ) {
+		X11_SHMCompleted(this, &event);
+	}
+	if ( shm_buffers[shm_next].busy ) {
+		X11_WaitForSHMBuffer(this);
+	}
+
+	for ( i=0; i<=last; ++i ) {
+		const Uint8 *src;
+		Uint8 *dst;
+		int len;
+
+		if ( rects[i].w == 0 || rects[i].h == 0 ) { /* Clipped? */
+			continue;
+		}
+		src = (Uint8 *)SDL_Ximage->data + rects[i].y*pitch + rects[i].x*bpp;
+		dst = (Uint8 *)image->data + rects[i].y*pitch + rects[i].x*bpp;
+		len = rects[i].w*bpp;
+		for ( y = rects[i].h; y--; ) {
+			SDL_memcpy(dst, src, len);
+			src += pitch;
+			dst += pitch;
+		}
+		XShmPutImage(GFX_Display, SDL_Window, SDL_GC, image,
+				rects[i].x, rects[i].y,
+				rects[i].x, rects[i].y, rects[i].w, rects[i].h,
+				(i == last));
+	}
+	shm_buffers[shm_next].busy = 1;
+	shm_next = (shm_next + 1) % shm_nbuffers;
+	XFlush(GFX_Display);
+	++present_stats.presents;
+}
+#endif /* ! NO_SHARED_MEMORY */
+
 static void X11_MITSHMUpdate(_THIS, int numrects, SDL_Rect *rects)
 {
 #ifndef NO_SHARED_MEMORY
 	int i;
 
+	if ( shm_nbuffers ) {
+		X11_MITSHMPipelinedUpdate(this, numrects, rects);
+		return;
+	}
 	for ( i=0; i<numrects; ++i ) {
 		if ( rects[i].w == 0 || rects[i].h == 0 ) { /* Clipped? */
 			continue;
@@ -270,6 +481,7 @@ static void X11_MITSHMUpdate(_THIS, int numrects, SDL_Rect *rects)
 	} else {
 		XSync(GFX_Display, False);
 	}
+	++present_stats.presents;
 #endif /* ! NO_SHARED_MEMORY */
 }
 
@@ -32,6 +32,7 @@ extern void X11_FreeHWSurface(_THIS, SDL_Surface *surface);
 extern int X11_LockHWSurface(_THIS, SDL_Surface *surface);
 extern void X11_UnlockHWSurface(_THIS, SDL_Surface *surface);
 extern int X11_FlipHWSurface(_THIS, SDL_Surface *surface);
+extern int X11_GetPresentStats(_THIS, SDL_PresentStats *stats);
 
 extern void X11_DisableAutoRefresh(_THIS);
 extern void X11_EnableAutoRefresh(_THIS);
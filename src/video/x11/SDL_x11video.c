@@ -165,6 +165,7 @@ static SDL_VideoDevice *X11_CreateDevice(int devindex)
 		device->IconifyWindow = X11_IconifyWindow;
 		device->GrabInput = X11_GrabInput;
 		device->GetWMInfo = X11_GetWMInfo;
+		device->GetPresentStats = X11_GetPresentStats;
 		device->FreeWMCursor = X11_FreeWMCursor;
 		device->CreateWMCursor = X11_CreateWMCursor;
 		device->ShowWMCursor = X11_ShowWMCursor;
@@ -172,6 +173,7 @@ static SDL_VideoDevice *X11_CreateDevice(int devindex)
 		device->CheckMouseMode = X11_CheckMouseMode;
 		device->InitOSKeymap = X11_InitOSKeymap;
 		device->PumpEvents = X11_PumpEvents;
+		device->GetEventFDs = X11_GetEventFDs;
 
 		device->free = X11_DeleteDevice;
 	}
@@ -75,7 +75,21 @@ struct SDL_PrivateVideoData {
     /* MIT shared memory extension information */
     int use_mitshm;
     XShmSegmentInfo shminfo;
+
+    /* Segments the updated rectangles are copied to and put from, so the
+       next frame can be drawn while the X server reads the last one.
+     */
+#define SDL_X11_MAX_SHM_BUFFERS	4
+    struct {
+        XShmSegmentInfo info;
+        XImage *image;
+        int busy;		/* Waiting for its ShmCompletion event */
+    } shm_buffers[SDL_X11_MAX_SHM_BUFFERS];
+    int shm_nbuffers;
+    int shm_next;
+    int shm_completion;		/* ShmCompletion event type */
 #endif
+    SDL_PresentStats present_stats;
 
     /* The variables used for displaying graphics */
     XImage *Ximage;		/* The X image for our window */
@@ -174,6 +188,11 @@ struct SDL_PrivateVideoData {
 #define using_dga		(this->hidden->using_dga)
 #define use_mitshm		(this->hidden->use_mitshm)
 #define shminfo			(this->hidden->shminfo)
+#define shm_buffers		(this->hidden->shm_buffers)
+#define shm_nbuffers		(this->hidden->shm_nbuffers)
+#define shm_next		(this->hidden->shm_next)
+#define shm_completion		(this->hidden->shm_completion)
+#define present_stats		(this->hidden->present_stats)
 #define SDL_Ximage		(this->hidden->Ximage)
 #define SDL_GC			(this->hidden->gc)
 #define window_w		(this->hidden->window_w)
@@ -0,0 +1,246 @@
+/*
+ * Converts a display recording made with SDL_StartRecording() into a
+ * YUV4MPEG2 (4:4:4) video that most video tools can play or encode.
+ *
+ * The recording holds one entry per SDL_UpdateRects() or SDL_Flip() call,
+ * timestamped with SDL_GetTicks().  By default the output runs at a fixed
+ * 30 frames per second, repeating frames to follow the recorded timing;
+ * with -r 0 every recorded frame is written exactly once instead.
+ *
+ * The recording must use a single video mode size, since YUV4MPEG2
+ * streams can't change size; conversion stops at the first size change.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+/* These match src/video/SDL_record_c.h */
+#define RECORD_MAGIC	0x524C4453	/* "SDLR" */
+#define RECORD_MODE	0x45444F4D	/* "MODE" */
+#define RECORD_PALETTE	0x544C4150	/* "PALT" */
+#define RECORD_FRAME	0x4D415246	/* "FRAM" */
+
+static int width, height, bpp, bigendian;
+static Uint32 masks[3];
+static int shifts[3], maxvals[3];
+static SDL_Color palette[256];
+static Uint8 *canvas;
+static Uint8 *planes;
+
+static Uint32 get_pixel(const Uint8 *p)
+{
+    switch (bpp) {
+    case 1:
+        return p[0];
+    case 2:
+        return bigendian ? (p[0] << 8) | p[1] : p[0] | (p[1] << 8);
+    case 3:
+        return bigendian ? (p[0] << 16) | (p[1] << 8) | p[2]
+                         : p[0] | (p[1] << 8) | (p[2] << 16);
+    default:
+        return bigendian ? ((Uint32)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]
+                         : p[0] | (p[1] << 8) | (p[2] << 16) | ((Uint32)p[3] << 24);
+    }
+}
+
+static void write_frame(FILE *out)
+{
+    int i, c, n = width * height;
+    Uint8 *y = planes, *u = planes + n, *v = planes + 2 * n;
+    const Uint8 *p = canvas;
+
+    for (i = 0; i < n; ++i, p += bpp) {
+        Uint32 pixel = get_pixel(p);
+        int rgb[3];
+
+        if (bpp == 1) {
+            rgb[0] = palette[pixel].r;
+            rgb[1] = palette[pixel].g;
+            rgb[2] = palette[pixel].b;
+        } else {
+            for (c = 0; c < 3; ++c) {
+                rgb[c] = maxvals[c] ?
+                    (int)(((pixel & masks[c]) >> shifts[c]) * 255 / maxvals[c]) : 0;
+            }
+        }
+        /* BT.601, studio range */
+        y[i] = (Uint8)(((66 * rgb[0] + 129 * rgb[1] + 25 * rgb[2] + 128) >> 8) + 16);
+        u[i] = (Uint8)(((-38 * rgb[0] - 74 * rgb[1] + 112 * rgb[2] + 128) >> 8) + 128);
+        v[i] = (Uint8)(((112 * rgb[0] - 94 * rgb[1] - 18 * rgb[2] + 128) >> 8) + 128);
+    }
+    fputs("FRAME\n", out);
+    fwrite(planes, 3, n, out);
+}
+
+static int read_mode(SDL_RWops *in, FILE *out, int fps)
+{
+    Uint32 mode[9];
+    int i, c;
+
+    for (i = 0; i < 9; ++i) {
+        mode[i] = SDL_ReadLE32(in);
+    }
+    if (canvas) {
+        if ((int)mode[0] != width || (int)mode[1] != height) {
+            fprintf(stderr, "Video mode changed to %dx%d, stopping\n",
+                    (int)mode[0], (int)mode[1]);
+            return -1;
+        }
+    } else {
+        width = mode[0];
+        height = mode[1];
+        canvas = (Uint8 *)calloc((size_t)width * height, 4);
+        planes = (Uint8 *)malloc((size_t)width * height * 3);
+        if (!canvas || !planes) {
+            fprintf(stderr, "Out of memory\n");
+            return -1;
+        }
+        fprintf(out, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n",
+                width, height, fps > 0 ? fps : 30);
+    }
+    bpp = mode[2];
+    if (bpp < 1 || bpp > 4) {
+        fprintf(stderr, "Unsupported pixel size %d\n", bpp);
+        return -1;
+    }
+    for (c = 0; c < 3; ++c) {
+        masks[c] = mode[4 + c];
+        shifts[c] = 0;
+        while (masks[c] && !(masks[c] & (1u << shifts[c]))) {
+            ++shifts[c];
+        }
+        maxvals[c] = masks[c] >> shifts[c];
+    }
+    bigendian = mode[8];
+    return 0;
+}
+
+static int read_frame(SDL_RWops *in, Uint32 *ticks)
+{
+    Uint32 i, n;
+    int x, y, w, h, row;
+
+    SDL_ReadLE32(in);           /* frame number */
+    *ticks = SDL_ReadLE32(in);
+    n = SDL_ReadLE32(in);
+    for (i = 0; i < n; ++i) {
+        x = SDL_ReadLE32(in);
+        y = SDL_ReadLE32(in);
+        w = SDL_ReadLE32(in);
+        h = SDL_ReadLE32(in);
+        if (x < 0 || y < 0 || w <= 0 || h <= 0 ||
+            x + w > width || y + h > height) {
+            fprintf(stderr, "Bad rectangle in frame\n");
+            return -1;
+        }
+        for (row = 0; row < h; ++row) {
+            Uint8 *dst = canvas + ((y + row) * width + x) * bpp;
+            if (SDL_RWread(in, dst, w * bpp, 1) != 1) {
+                fprintf(stderr, "Truncated frame\n");
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    SDL_RWops *in;
+    FILE *out;
+    Uint32 id, len, ticks;
+    double next = 0.0;
+    int fps = 30, started = 0, frames = 0, written = 0;
+    int i;
+
+    i = 1;
+    if (argc > 2 && strcmp(argv[1], "-r") == 0) {
+        fps = atoi(argv[2]);
+        i = 3;
+    }
+    if (argc - i != 2) {
+        fprintf(stderr, "Usage: %s [-r fps] recording output.y4m\n", argv[0]);
+        return 1;
+    }
+    in = SDL_RWFromFile(argv[i], "rb");
+    if (!in) {
+        fprintf(stderr, "Couldn't open %s: %s\n", argv[i], SDL_GetError());
+        return 1;
+    }
+    if (SDL_ReadLE32(in) != RECORD_MAGIC || SDL_ReadLE32(in) != 1) {
+        fprintf(stderr, "%s is not an SDL recording\n", argv[i]);
+        return 1;
+    }
+    out = fopen(argv[i + 1], "wb");
+    if (!out) {
+        fprintf(stderr, "Couldn't create %s\n", argv[i + 1]);
+        return 1;
+    }
+
+    while (SDL_RWread(in, &id, 4, 1) == 1) {
+        id = SDL_SwapLE32(id);
+        len = SDL_ReadLE32(in);
+        if (id == RECORD_MODE) {
+            if (read_mode(in, out, fps) < 0) {
+                break;
+            }
+        } else if (id == RECORD_PALETTE) {
+            Uint32 n = SDL_ReadLE32(in);
+            for (i = 0; i < (int)n; ++i) {
+                Uint8 color[4];
+                SDL_RWread(in, color, 4, 1);
+                if (i < 256) {
+                    palette[i].r = color[0];
+                    palette[i].g = color[1];
+                    palette[i].b = color[2];
+                }
+            }
+        } else if (id == RECORD_FRAME) {
+            if (!canvas) {
+                fprintf(stderr, "Frame before the video mode\n");
+                break;
+            }
+            if (fps <= 0) {
+                if (started) {
+                    write_frame(out);
+                    ++written;
+                }
+            } else {
+                /* Show the previous frame until this one's time */
+                SDL_RWseek(in, 4, RW_SEEK_CUR);
+                ticks = SDL_ReadLE32(in);
+                SDL_RWseek(in, -8, RW_SEEK_CUR);
+                if (!started) {
+                    next = ticks;
+                }
+                while (started && next <= ticks) {
+                    write_frame(out);
+                    ++written;
+                    next += 1000.0 / fps;
+                }
+            }
+            started = 1;
+            if (read_frame(in, &ticks) < 0) {
+                break;
+            }
+            ++frames;
+        } else {
+            SDL_RWseek(in, len, RW_SEEK_CUR);
+        }
+    }
+    if (started) {
+        write_frame(out);
+        ++written;
+    }
+    printf("%d recorded frames, %d video frames at %dx%d\n",
+           frames, written, width, height);
+
+    fclose(out);
+    SDL_RWclose(in);
+    free(canvas);
+    free(planes);
+    return 0;
+}
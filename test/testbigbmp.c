@@ -0,0 +1,271 @@
+/*
+ * Saves and loads BMP files of surfaces with rows over 65535 bytes.
+ *
+ * The pitch of these surfaces doesn't fit in surface->pitch, so this
+ * checks that every row makes it through SDL_SaveBMP(), SDL_SaveBMP_Async()
+ * and SDL_LoadBMP(), both through a file and in memory.
+ *
+ * It also loads 1 bpp files from memory, at widths with and without row
+ * padding, since the last row of those ends right at the end of the data.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#define TEST_FILE "testbigbmp.bmp"
+
+/* Fill each row with a different pattern, so swapped rows are caught */
+static void fill_surface(SDL_Surface *surface)
+{
+    Uint32 pitch = SDL_GetSurfacePitch(surface);
+    Uint8 *row;
+    Uint32 x;
+    int y;
+
+    if (surface->format->palette) {
+        for (x = 0; x < 256; x++) {
+            surface->format->palette->colors[x].r = x;
+            surface->format->palette->colors[x].g = 255 - x;
+            surface->format->palette->colors[x].b = x * 7;
+        }
+    }
+    for (y = 0; y < surface->h; y++) {
+        row = (Uint8 *) surface->pixels + (size_t) y * pitch;
+        for (x = 0; x < pitch; x++) {
+            row[x] = (Uint8) ((x * 13) ^ (x >> 8) ^ (y * 101));
+        }
+    }
+}
+
+static int compare_surfaces(const char *name, SDL_Surface *expected,
+                            SDL_Surface *surface)
+{
+    Uint32 bpp = expected->format->BytesPerPixel;
+    Uint32 pixel, wanted, mask;
+    Uint8 r, g, b;
+    Uint8 *row, *erow;
+    int x, y;
+
+    if (surface == NULL) {
+        fprintf(stderr, "%s: couldn't load: %s\n", name, SDL_GetError());
+        return 1;
+    }
+    if (surface->w != expected->w || surface->h != expected->h) {
+        fprintf(stderr, "%s: loaded as %dx%d, expected %dx%d\n", name,
+                surface->w, surface->h, expected->w, expected->h);
+        SDL_FreeSurface(surface);
+        return 1;
+    }
+    /* Pixels may be loaded in another format, so compare them in ours */
+    if (expected->format->palette) {
+        mask = 0xFF;
+    } else {
+        mask = expected->format->Rmask | expected->format->Gmask |
+            expected->format->Bmask;
+    }
+    for (y = 0; y < surface->h; y++) {
+        row = (Uint8 *) surface->pixels +
+            (size_t) y * SDL_GetSurfacePitch(surface);
+        erow = (Uint8 *) expected->pixels +
+            (size_t) y * SDL_GetSurfacePitch(expected);
+        for (x = 0; x < surface->w; x++) {
+            wanted = 0;
+            memcpy(&wanted, erow + x * bpp, bpp);
+            pixel = 0;
+            memcpy(&pixel, row + x * surface->format->BytesPerPixel,
+                   surface->format->BytesPerPixel);
+            SDL_GetRGB(pixel, surface->format, &r, &g, &b);
+            pixel = SDL_MapRGB(expected->format, r, g, b);
+            if ((pixel & mask) != (wanted & mask)) {
+                fprintf(stderr, "%s: pixel %d,%d doesn't match\n",
+                        name, x, y);
+                SDL_FreeSurface(surface);
+                return 1;
+            }
+        }
+    }
+    SDL_FreeSurface(surface);
+    printf("%s: OK\n", name);
+    return 0;
+}
+
+static void put16(Uint8 *p, Uint16 value)
+{
+    p[0] = (value & 0xFF);
+    p[1] = (value >> 8);
+}
+
+static void put32(Uint8 *p, Uint32 value)
+{
+    put16(p, value & 0xFFFF);
+    put16(p + 2, value >> 16);
+}
+
+/* Load a 1 bpp image from a buffer exactly the size of the file */
+static int test_1bpp(int w, int h)
+{
+    int offset = 14 + 40 + 2 * 4;
+    int rowsize = ((w + 31) / 32) * 4;
+    int size = offset + rowsize * h;
+    SDL_Surface *surface;
+    Uint8 *file, *row;
+    int x, y, bit;
+    int failed = 0;
+
+    file = (Uint8 *) malloc(size);
+    if (file == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    memset(file, 0, size);
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(file + 2, size);
+    put32(file + 10, offset);
+    put32(file + 14, 40);
+    put32(file + 18, w);
+    put32(file + 22, h);
+    put16(file + 26, 1);
+    put16(file + 28, 1);
+    put32(file + 34, rowsize * h);
+    put32(file + 46, 2);
+    memset(file + 58, 0xFF, 3);
+    for (y = 0; y < h; y++) {
+        row = file + offset + (h - y - 1) * rowsize;
+        for (x = 0; x < w; x++) {
+            if ((x + y) % 3 == 0) {
+                row[x / 8] |= (0x80 >> (x % 8));
+            }
+        }
+    }
+
+    surface = SDL_LoadBMP_RW(SDL_RWFromConstMem(file, size), 1);
+    if (surface == NULL) {
+        fprintf(stderr, "1 bpp %d wide: couldn't load: %s\n", w,
+                SDL_GetError());
+        free(file);
+        return 1;
+    }
+    for (y = 0; y < h && !failed; y++) {
+        row = (Uint8 *) surface->pixels + y * surface->pitch;
+        for (x = 0; x < w; x++) {
+            bit = ((x + y) % 3 == 0);
+            if (row[x] != bit) {
+                fprintf(stderr, "1 bpp %d wide: pixel %d,%d doesn't match\n",
+                        w, x, y);
+                failed = 1;
+                break;
+            }
+        }
+    }
+    if (!failed) {
+        printf("1 bpp %d wide: OK\n", w);
+    }
+    SDL_FreeSurface(surface);
+    free(file);
+    return failed;
+}
+
+static int test_depth(int w, int h, int bpp)
+{
+    SDL_Surface *surface;
+    SDL_Thread *thread;
+    SDL_RWops *rw;
+    Uint8 *mem;
+    int memsize;
+    int status;
+    int failed = 0;
+    char name[64];
+
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, bpp, 0, 0, 0, 0);
+    if (surface == NULL) {
+        fprintf(stderr, "Couldn't create %dx%d %d bpp surface: %s\n",
+                w, h, bpp, SDL_GetError());
+        return 1;
+    }
+    fill_surface(surface);
+    printf("%dx%d %d bpp, pitch %u\n", w, h, bpp,
+           (unsigned) SDL_GetSurfacePitch(surface));
+
+    sprintf(name, "%d bpp file", bpp);
+    if (SDL_SaveBMP(surface, TEST_FILE) < 0) {
+        fprintf(stderr, "%s: couldn't save: %s\n", name, SDL_GetError());
+        failed = 1;
+    } else {
+        failed |= compare_surfaces(name, surface, SDL_LoadBMP(TEST_FILE));
+    }
+
+    sprintf(name, "%d bpp memory", bpp);
+    memsize = 14 + 40 + 12 + 256 * 4 + (w * 4 + 4) * h;
+    mem = (Uint8 *) malloc(memsize);
+    if (mem == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        failed = 1;
+    } else {
+        rw = SDL_RWFromMem(mem, memsize);
+        if (SDL_SaveBMP_RW(surface, rw, 0) < 0) {
+            fprintf(stderr, "%s: couldn't save: %s\n", name, SDL_GetError());
+            failed = 1;
+        } else {
+            memsize = SDL_RWtell(rw);
+            failed |= compare_surfaces(name, surface,
+                                       SDL_LoadBMP_RW(SDL_RWFromConstMem
+                                                      (mem, memsize), 1));
+        }
+        SDL_RWclose(rw);
+        free(mem);
+    }
+
+    sprintf(name, "%d bpp async", bpp);
+    thread = SDL_SaveBMP_Async(surface, TEST_FILE);
+    if (thread == NULL) {
+        fprintf(stderr, "%s: couldn't save: %s\n", name, SDL_GetError());
+        failed = 1;
+    } else {
+        SDL_WaitThread(thread, &status);
+        if (status < 0) {
+            fprintf(stderr, "%s: save failed\n", name);
+            failed = 1;
+        } else {
+            failed |= compare_surfaces(name, surface, SDL_LoadBMP(TEST_FILE));
+        }
+    }
+
+    SDL_FreeSurface(surface);
+    remove(TEST_FILE);
+    return failed;
+}
+
+int main(int argc, char *argv[])
+{
+    int w = 30000;
+    int h = 5;
+    int failed = 0;
+
+    if (argc > 1) {
+        w = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        h = atoi(argv[2]);
+    }
+
+    if (SDL_Init(0) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return (1);
+    }
+    failed |= test_depth(w, h, 32);
+    failed |= test_depth(w, h, 24);
+    /* Saved by converting to 24 bpp */
+    failed |= test_depth(w, h, 16);
+    failed |= test_depth(w * 4, h, 8);
+    failed |= test_1bpp(32, 2);
+    failed |= test_1bpp(64, 3);
+    failed |= test_1bpp(37, 3);
+    SDL_Quit();
+
+    printf("%s\n", failed ? "FAILED" : "All tests passed");
+    return (failed);
+}
@@ -0,0 +1,277 @@
+/*
+ * Benchmarks loading RLE8 compressed BMP files against uncompressed ones.
+ *
+ * The image (sample.bmp by default, it must be 8 bits per pixel) is saved
+ * both uncompressed and RLE8 compressed to memory and to files, and each
+ * version is then loaded over and over from memory and from its file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+static int testSeconds = 3;
+
+#define RAW_FILE "testbmpspeed-raw.bmp"
+#define RLE_FILE "testbmpspeed-rle8.bmp"
+
+static void put16(Uint8 *p, Uint16 value)
+{
+    p[0] = (value & 0xFF);
+    p[1] = (value >> 8);
+}
+
+static void put32(Uint8 *p, Uint32 value)
+{
+    put16(p, value & 0xFFFF);
+    put16(p + 2, value >> 16);
+}
+
+/* Compress the rows bottom up, the way BMP files store them */
+static int encode_rle8(SDL_Surface *surface, Uint8 *out)
+{
+    Uint8 *start = out;
+    Uint8 *row;
+    int x, y, n;
+
+    for (y = surface->h - 1; y >= 0; y--) {
+        row = (Uint8 *) surface->pixels + y * surface->pitch;
+        x = 0;
+        while (x < surface->w) {
+            n = 1;
+            while ((x + n < surface->w) && (n < 255) && (row[x + n] == row[x]))
+                n++;
+            if ((n >= 3) || (surface->w - x < 3)) {
+                *out++ = n;
+                *out++ = row[x];
+                x += n;
+                continue;
+            }
+
+            /* Copy literal pixels up to the next run of three */
+            n = 0;
+            while ((x + n < surface->w) && (n < 255)) {
+                if ((x + n + 2 < surface->w) &&
+                    (row[x + n] == row[x + n + 1]) &&
+                    (row[x + n] == row[x + n + 2]))
+                    break;
+                n++;
+            }
+            if (n < 3) {
+                *out++ = 1;
+                *out++ = row[x];
+                x++;
+                continue;
+            }
+            *out++ = 0;
+            *out++ = n;
+            memcpy(out, row + x, n);
+            out += n;
+            if (n & 1)
+                *out++ = 0;
+            x += n;
+        }
+        *out++ = 0;
+        *out++ = 0;
+    }
+    *out++ = 0;
+    *out++ = 1;
+    return (int) (out - start);
+}
+
+static Uint8 *save_rle8(SDL_Surface *surface, int *size)
+{
+    SDL_Palette *palette = surface->format->palette;
+    int offset = 14 + 40 + 256 * 4;
+    int datasize;
+    Uint8 *file;
+    int i;
+
+    /* Worst case is two bytes per pixel plus two per row */
+    file = (Uint8 *) malloc(offset + (surface->w + 1) * surface->h * 2 + 2);
+    if (file == NULL)
+        return NULL;
+    memset(file, 0, offset);
+    datasize = encode_rle8(surface, file + offset);
+
+    file[0] = 'B';
+    file[1] = 'M';
+    put32(file + 2, offset + datasize);
+    put32(file + 10, offset);
+    put32(file + 14, 40);
+    put32(file + 18, surface->w);
+    put32(file + 22, surface->h);
+    put16(file + 26, 1);
+    put16(file + 28, 8);
+    put32(file + 30, 1);        /* BI_RLE8 */
+    put32(file + 34, datasize);
+    put32(file + 46, 256);
+    for (i = 0; i < palette->ncolors; i++) {
+        file[54 + i * 4 + 0] = palette->colors[i].b;
+        file[54 + i * 4 + 1] = palette->colors[i].g;
+        file[54 + i * 4 + 2] = palette->colors[i].r;
+    }
+    *size = offset + datasize;
+    return file;
+}
+
+static Uint8 *save_raw(SDL_Surface *surface, int *size)
+{
+    int maxsize = 14 + 40 + 256 * 4 + surface->pitch * surface->h;
+    Uint8 *file;
+    SDL_RWops *rw;
+
+    file = (Uint8 *) malloc(maxsize);
+    if (file == NULL)
+        return NULL;
+    rw = SDL_RWFromMem(file, maxsize);
+    if (SDL_SaveBMP_RW(surface, rw, 0) < 0) {
+        SDL_RWclose(rw);
+        free(file);
+        return NULL;
+    }
+    *size = SDL_RWtell(rw);
+    SDL_RWclose(rw);
+    return file;
+}
+
+static int write_file(const char *path, Uint8 *file, int size)
+{
+    FILE *fp;
+    int ok;
+
+    fp = fopen(path, "wb");
+    if (fp == NULL)
+        return 0;
+    ok = (fwrite(file, size, 1, fp) == 1);
+    if (fclose(fp) != 0)
+        ok = 0;
+    return ok;
+}
+
+/* Read the image from memory, or from path if it's not NULL */
+static SDL_Surface *load(Uint8 *file, int size, const char *path)
+{
+    if (path)
+        return SDL_LoadBMP(path);
+    return SDL_LoadBMP_RW(SDL_RWFromConstMem(file, size), 1);
+}
+
+/* Returns the average time in microseconds to load the file */
+static double time_loads(const char *name, Uint8 *file, int size,
+                         const char *path, SDL_Surface *expected)
+{
+    SDL_Surface *surface;
+    Uint32 start, now;
+    int loads = 0;
+    int y;
+
+    surface = load(file, size, path);
+    if (surface == NULL) {
+        fprintf(stderr, "Couldn't load %s image: %s\n", name, SDL_GetError());
+        return 0.0;
+    }
+    for (y = 0; y < surface->h; y++) {
+        if (memcmp((Uint8 *) surface->pixels + y * surface->pitch,
+                   (Uint8 *) expected->pixels + y * expected->pitch,
+                   surface->w) != 0) {
+            fprintf(stderr, "The %s image doesn't match!\n", name);
+            break;
+        }
+    }
+    SDL_FreeSurface(surface);
+
+    start = now = SDL_GetTicks();
+    while ((now - start) < (Uint32) (testSeconds * 1000)) {
+        surface = load(file, size, path);
+        SDL_FreeSurface(surface);
+        loads++;
+        now = SDL_GetTicks();
+    }
+    printf("%-12s %-6s %8d bytes %10.1f usec per load (%d loads)\n",
+           name, path ? "file" : "memory", size,
+           ((now - start) * 1000.0) / loads, loads);
+    return ((now - start) * 1000.0) / loads;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *file = "sample.bmp";
+    SDL_Surface *image;
+    Uint8 *raw, *rle;
+    int rawsize, rlesize;
+    double rawtime, rletime;
+    double rawfiletime, rlefiletime;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0 && argv[i + 1]) {
+            testSeconds = atoi(argv[++i]);
+        } else {
+            file = argv[i];
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return (1);
+    }
+    image = SDL_LoadBMP(file);
+    if (image == NULL) {
+        fprintf(stderr, "Couldn't load %s: %s\n", file, SDL_GetError());
+        SDL_Quit();
+        return (1);
+    }
+    if (image->format->BitsPerPixel != 8) {
+        fprintf(stderr, "%s isn't an 8 bits per pixel image\n", file);
+        SDL_FreeSurface(image);
+        SDL_Quit();
+        return (1);
+    }
+
+    raw = save_raw(image, &rawsize);
+    rle = save_rle8(image, &rlesize);
+    if (raw == NULL || rle == NULL) {
+        fprintf(stderr, "Couldn't save %s to memory\n", file);
+        SDL_FreeSurface(image);
+        SDL_Quit();
+        return (1);
+    }
+
+    if (!write_file(RAW_FILE, raw, rawsize) ||
+        !write_file(RLE_FILE, rle, rlesize)) {
+        fprintf(stderr, "Couldn't write the test files\n");
+        remove(RAW_FILE);
+        remove(RLE_FILE);
+        free(raw);
+        free(rle);
+        SDL_FreeSurface(image);
+        SDL_Quit();
+        return (1);
+    }
+
+    printf("%s: %dx%d\n", file, image->w, image->h);
+    rawtime = time_loads("uncompressed", raw, rawsize, NULL, image);
+    rawfiletime = time_loads("uncompressed", raw, rawsize, RAW_FILE, image);
+    rletime = time_loads("RLE8", rle, rlesize, NULL, image);
+    rlefiletime = time_loads("RLE8", rle, rlesize, RLE_FILE, image);
+    if (rawtime > 0.0 && rletime > 0.0) {
+        printf("RLE8 is %.0f%% of the size, and loads in %.0f%% of the time "
+               "from memory\n",
+               (rlesize * 100.0) / rawsize, (rletime * 100.0) / rawtime);
+    }
+    if (rawfiletime > 0.0 && rlefiletime > 0.0) {
+        printf("RLE8 loads in %.0f%% of the time from a file\n",
+               (rlefiletime * 100.0) / rawfiletime);
+    }
+
+    remove(RAW_FILE);
+    remove(RLE_FILE);
+    free(raw);
+    free(rle);
+    SDL_FreeSurface(image);
+    SDL_Quit();
+    return (0);
+}
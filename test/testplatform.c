@@ -137,6 +137,7 @@ int TestCPUInfo(SDL_bool verbose)
 		printf("3DNow Ext %s\n", SDL_Has3DNowExt() ? "detected" : "not detected");
 		printf("SSE %s\n", SDL_HasSSE() ? "detected" : "not detected");
 		printf("SSE2 %s\n", SDL_HasSSE2() ? "detected" : "not detected");
+		printf("AVX2 %s\n", SDL_HasAVX2() ? "detected" : "not detected");
 		printf("AltiVec %s\n", SDL_HasAltiVec() ? "detected" : "not detected");
 	}
 	return(0);